@@ -18,6 +18,7 @@ message(STATUS "Third-party (external): creating target 'zstd::zstd'")
 option(ZSTD_LEGACY_SUPPORT "LEGACY SUPPORT" OFF)
 option(ZSTD_BUILD_PROGRAMS "BUILD PROGRAMS" OFF)
 option(ZSTD_BUILD_TESTS "BUILD TESTS" OFF)
+option(ZSTD_MULTITHREAD_SUPPORT "MULTITHREADING SUPPORT" ON)
 
 include(CPM)
 CPMAddPackage(
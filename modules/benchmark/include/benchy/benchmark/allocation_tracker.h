@@ -0,0 +1,77 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+// System include
+#include <algorithm>
+#include <cstdint>
+
+namespace benchy {
+namespace benchmark {
+
+///
+/// Heap allocations counted between start_allocation_tracking() and stop_allocation_tracking()
+///
+struct AllocationStats
+{
+    /// Number of allocations, including reallocations
+    uint64_t count = 0;
+
+    /// Total number of bytes requested by the allocations
+    uint64_t bytes = 0;
+
+    /// Peak of the bytes allocated and not yet freed, counted from the start of tracking
+    uint64_t peak_live_bytes = 0;
+
+    ///
+    /// Adds the allocations of another tracked section. The peak live bytes of the sections are
+    /// not added, the largest one is kept
+    ///
+    void merge(const AllocationStats& other)
+    {
+        count += other.count;
+        bytes += other.bytes;
+        peak_live_bytes = std::max(peak_live_bytes, other.peak_live_bytes);
+    }
+};
+
+///
+/// Whether heap allocations are tracked, which requires building with BENCHY_TRACK_ALLOCATIONS
+///
+/// Tracking builds replace the allocation functions of the whole process: `malloc`, `calloc`,
+/// `realloc`, `free` and the aligned variants with glibc, which also covers `operator new` and
+/// the allocations of C libraries such as Cholmod, and `operator new` and `operator delete`
+/// elsewhere. Each thread counts its allocations in its own counters, so that allocating threads
+/// do not contend, except for the number of live bytes which is shared by all threads. Counting
+/// is switched off outside of tracked sections, where an allocation only costs a relaxed load.
+///
+bool allocation_tracking_enabled();
+
+///
+/// Resets the counters and starts counting the allocations of all threads. Does nothing if
+/// allocation tracking is not enabled
+///
+/// Allocations are not attributed to the code being measured, so background work such as the
+/// decoding of the next system by benchy::io::SystemCache must be waited for before tracking
+/// starts, and only resumed once it stops
+///
+void start_allocation_tracking();
+
+///
+/// Stops counting allocations
+/// @returns Allocations counted since start_allocation_tracking(), zero if allocation tracking is
+/// not enabled
+///
+AllocationStats stop_allocation_tracking();
+
+} // namespace benchmark
+} // namespace benchy
@@ -11,13 +11,27 @@
  */
 
 // Third-party include
+#include <benchy/benchmark/allocation_tracker.h>
+#include <benchy/benchmark/latency_histogram.h>
+#include <benchy/benchmark/peak_memory.h>
+#include <benchy/benchmark/perf_counters.h>
 #include <benchy/benchmark/setup.h>
+#include <benchy/benchmark/solver_structs.h>
+#include <benchy/benchmark/thread_control.h>
+#include <benchy/io/hdf5_store.h>
+#include <benchy/io/pack_io.h>
+#include <benchy/io/sequence_io.h>
+#include <benchy/io/symmetric_storage.h>
+#include <benchy/io/system_cache.h>
 #include <celero/Celero.h>
 #include <polysolve/LinearSolver.hpp>
 #include <unsupported/Eigen/SparseExtra>
 
 // System include
+#include <array>
 #include <filesystem>
+#include <memory>
+#include <optional>
 #include <vector>
 
 using Scalar = double;
@@ -26,6 +40,19 @@ namespace fs = std::filesystem;
 namespace benchy {
 namespace benchmark {
 
+///
+/// Phases timed in a single pass by PipelineFixture, in the order they run
+///
+enum class Phase { Analyze, Factorize, Solve };
+
+/// Number of values of Phase
+constexpr size_t NumPhases = 3;
+
+///
+/// Name of a phase, which is also the name of the group benchmarking it on its own
+///
+const char* phase_name(Phase phase);
+
 ///
 /// Collection of benchmarks for linear solvers using Celero
 ///
@@ -51,6 +78,85 @@ public:
     ///
     class MemoryUDM;
 
+    ///
+    /// User-defined measurement of the peak physical memory of the benchmarked iterations, over
+    /// the physical memory before they start
+    ///
+    class PeakMemoryUDM;
+
+    ///
+    /// User-defined measurement of the number of heap allocations of the benchmarked iterations
+    ///
+    class AllocationCountUDM;
+
+    ///
+    /// User-defined measurement of the bytes allocated on the heap by the benchmarked iterations
+    ///
+    class AllocatedBytesUDM;
+
+    ///
+    /// User-defined measurement of the peak heap bytes allocated and not freed by the benchmarked
+    /// iterations
+    ///
+    class PeakLiveBytesUDM;
+
+    ///
+    /// User-defined measurement of the count of a hardware event during the benchmarked
+    /// iterations, e.g. the CPU cycles
+    ///
+    class PerfEventUDM;
+
+    ///
+    /// User-defined measurement of numerical factorizations per second, for sequences of systems
+    ///
+    class ThroughputUDM;
+
+    ///
+    /// User-defined measurement of solves per second over the steps of a sequence
+    ///
+    class StepSolveRateUDM;
+
+    ///
+    /// User-defined measurement of the analyze time divided by the length of a sequence, in us
+    ///
+    class AmortizedAnalyzeUDM;
+
+    ///
+    /// User-defined measurement of the number of right-hand sides solved at once
+    ///
+    class RhsCountUDM;
+
+    ///
+    /// User-defined measurement of right-hand sides solved per second, for blocks of rhs
+    ///
+    class SolveRateUDM;
+
+    ///
+    /// User-defined measurement of the number of threads solving concurrently
+    ///
+    class ThreadsUDM;
+
+    ///
+    /// User-defined measurement of the number of threads of the solver backends (OpenMP, MKL,
+    /// BLAS), when swept over BenchmarkData::m_backend_threads
+    ///
+    class BackendThreadsUDM;
+
+    ///
+    /// User-defined measurement of a percentile of the duration of solve calls, in us
+    ///
+    class LatencyUDM;
+
+    ///
+    /// User-defined measurement of the number of iterative refinement steps of a solve
+    ///
+    class RefinementStepsUDM;
+
+    ///
+    /// User-defined measurement of a phase of a pipeline pass, e.g. its average duration
+    ///
+    class PhaseUDM;
+
     ///
     /// Default constructor
     ///
@@ -63,20 +169,36 @@ public:
     /// ExperimentValues. The BenchmarkData class stores a list of system paths, and during
     /// benchmarking the ExperimentValue indexes into that list to loads the matrix.
     ///
+    /// If BenchmarkData::m_backend_threads is set, each system is benchmarked once per number of
+    /// threads, and the ExperimentValue encodes both
+    ///
     std::vector<celero::TestFixture::ExperimentValue> getExperimentValues() const override;
 
     ///
-    /// Loads .zst file and populates m_A, m_b fields
+    /// Loads .zst or .bcsc file and populates m_system, m_b fields. Systems are borrowed from
+    /// BenchmarkData::m_cache. Sets the number of threads of the solver backends first if they
+    /// are swept
     ///
     virtual void setUp(const celero::TestFixture::ExperimentValue& experimentValue) override;
 
     ///
-    /// Calculates residual if solve phase is being benchmarked
+    /// Starts monitoring the peak memory, the hardware events and the allocations of the
+    /// benchmarked iterations, once the systems decoded in the background are ready so that they
+    /// are not measured with the solver
+    ///
+    virtual void onExperimentStart(const celero::TestFixture::ExperimentValue&) override;
+
+    ///
+    /// Records the allocations, the hardware events and the peak memory of the benchmarked
+    /// iterations, and calculates residual if solve phase is being benchmarked. Fixtures deriving
+    /// from this class call this method before calculating their own residual
     ///
     virtual void onExperimentEnd() override;
 
     ///
-    /// Compiles user-defined measurements after benchmark completes
+    /// Compiles user-defined measurements after benchmark completes, and starts decoding the
+    /// next system in the background. Fixtures deriving from this class fill the measurements
+    /// specific to their group and then call this method
     ///
     virtual void tearDown() override;
 
@@ -91,8 +213,29 @@ public:
     ///
     void addFailure();
 
-    /// Matrix of system being benchmarked
-    Eigen::SparseMatrix<Scalar, Eigen::ColMajor> m_A;
+    ///
+    /// Sets the number of threads of the solver backends encoded in an experiment value, if they
+    /// are swept, and creates a new solver so that libraries reading it on creation (e.g. Cholmod)
+    /// use it. Leaves the backends to their defaults otherwise
+    ///
+    void apply_backend_threads(int64_t experiment_value);
+
+    ///
+    /// Matrix of system being benchmarked. Only stores one triangle if m_stored_triangle says so
+    ///
+    const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A() const
+    {
+        return m_converted_A.size() > 0 ? m_converted_A : m_system->A;
+    }
+
+    /// System being benchmarked, shared with the system cache. Solvers only read its matrix
+    std::shared_ptr<const benchy::io::LinearSystem<Scalar>> m_system;
+
+    /// Copy of the matrix of m_system, if its storage is converted for the solver
+    Eigen::SparseMatrix<Scalar, Eigen::ColMajor> m_converted_A;
+
+    /// Part of A() that is stored, for SPD systems read by solvers accepting a single triangle
+    benchy::io::StoredTriangle m_stored_triangle = benchy::io::StoredTriangle::Full;
 
     /// Right-hand side vector of system being benchmarked
     Eigen::VectorX<Scalar> m_b;
@@ -100,15 +243,78 @@ public:
     /// Solution vector of system being benchmarked
     Eigen::VectorX<Scalar> m_x;
 
-    /// Path to .zst file of system being benchmarked
+    /// Path to .zst or .bcsc file of system being benchmarked
     fs::path m_matrix_path;
 
+    /// Path to the system benchmarked next, prefetched by tearDown(). Empty if there is none
+    fs::path m_next_path;
+
     /// Solver used in current benchmark
     std::unique_ptr<polysolve::LinearSolver> m_solver;
 
-    /// Vector containing residuals of all iterations. Only nonempty during "solve" benchmarks
+    /// Vector containing residuals of all iterations. Empty if the benchmark does not solve
     std::vector<Scalar> m_residuals;
 
+    /// Factorizations per second of a sequence. -1 outside of sequence benchmarks
+    double m_factorizations_per_second = -1;
+
+    /// Solves per second over the steps of a sequence. -1 outside of sequence benchmarks
+    double m_step_solves_per_second = -1;
+
+    /// Analyze time divided by the length of a sequence in us. -1 outside of sequence benchmarks
+    double m_amortized_analyze_us = -1;
+
+    /// Number of rhs solved at once. -1 outside of multi-rhs benchmarks
+    int m_rhs_count = -1;
+
+    /// Number of rhs solved per second. -1 outside of multi-rhs and concurrent benchmarks
+    double m_solves_per_second = -1;
+
+    /// Number of threads solving concurrently. -1 outside of concurrent benchmarks
+    int m_num_threads = -1;
+
+    /// Number of threads of the solver backends. -1 if left to their defaults
+    int m_backend_threads = -1;
+
+    /// Durations of individual solve calls. Empty outside of concurrent benchmarks
+    LatencyHistogram m_latencies;
+
+    /// Number of iterative refinement steps of the last solve. -1 outside of mixed-precision
+    /// benchmarks
+    int m_refinement_steps = -1;
+
+    /// Average duration of each phase in us, indexed by Phase. -1 outside of pipeline benchmarks
+    std::array<double, NumPhases> m_phase_us = {-1, -1, -1};
+
+    /// Monitor of the peak memory of the benchmarked iterations
+    PeakMemoryMonitor m_memory_monitor;
+
+    /// Peak physical memory of the benchmarked iterations over the memory before they start, in
+    /// bytes. -1 if not measured
+    double m_peak_memory = -1;
+
+    /// Largest peak physical memory of each phase over the memory before the phase, in bytes,
+    /// indexed by Phase. -1 outside of pipeline benchmarks
+    std::array<double, NumPhases> m_phase_peak_memory = {-1, -1, -1};
+
+    /// Heap allocations of the benchmarked iterations. Empty if allocations are not tracked (see
+    /// allocation_tracking_enabled())
+    std::optional<AllocationStats> m_allocations;
+
+    /// Heap allocations of each phase over the passes of a sample, indexed by Phase. Empty outside
+    /// of pipeline benchmarks or if allocations are not tracked
+    std::array<std::optional<AllocationStats>, NumPhases> m_phase_allocations;
+
+    /// Counters of the hardware events of the benchmarked iterations
+    PerfCounters m_perf_counters;
+
+    /// Hardware events of the benchmarked iterations. Empty if not counted
+    std::optional<PerfCounts> m_perf_counts;
+
+    /// Hardware events of each phase over the passes of a sample, indexed by Phase. Empty outside
+    /// of pipeline benchmarks
+    std::array<std::optional<PerfCounts>, NumPhases> m_phase_perf_counts;
+
     /// Number of failures across all benchmark iterations
     int m_failure_count;
 
@@ -123,6 +329,373 @@ public:
 
     /// User-defined measurement of physical memory usage
     std::shared_ptr<MemoryUDM> m_memory_udm;
+
+    /// User-defined measurement of peak physical memory
+    std::shared_ptr<PeakMemoryUDM> m_peak_memory_udm;
+
+    /// User-defined measurement of the number of allocations
+    std::shared_ptr<AllocationCountUDM> m_allocation_count_udm;
+
+    /// User-defined measurement of the allocated bytes
+    std::shared_ptr<AllocatedBytesUDM> m_allocated_bytes_udm;
+
+    /// User-defined measurement of the peak live bytes
+    std::shared_ptr<PeakLiveBytesUDM> m_peak_live_bytes_udm;
+
+    /// User-defined measurements of hardware events, indexed by PerfEvent
+    std::vector<std::shared_ptr<PerfEventUDM>> m_perf_event_udms;
+
+    /// User-defined measurement of factorization throughput
+    std::shared_ptr<ThroughputUDM> m_throughput_udm;
+
+    /// User-defined measurement of the solve throughput of a sequence
+    std::shared_ptr<StepSolveRateUDM> m_step_solve_rate_udm;
+
+    /// User-defined measurement of amortized analyze cost
+    std::shared_ptr<AmortizedAnalyzeUDM> m_amortized_analyze_udm;
+
+    /// User-defined measurement of the number of rhs
+    std::shared_ptr<RhsCountUDM> m_rhs_count_udm;
+
+    /// User-defined measurement of solve throughput
+    std::shared_ptr<SolveRateUDM> m_solve_rate_udm;
+
+    /// User-defined measurement of the number of concurrent threads
+    std::shared_ptr<ThreadsUDM> m_threads_udm;
+
+    /// User-defined measurement of the number of backend threads
+    std::shared_ptr<BackendThreadsUDM> m_backend_threads_udm;
+
+    /// User-defined measurements of solve latency percentiles
+    std::vector<std::shared_ptr<LatencyUDM>> m_latency_udms;
+
+    /// User-defined measurement of the number of refinement steps
+    std::shared_ptr<RefinementStepsUDM> m_refinement_steps_udm;
+
+    /// User-defined measurements of the duration of each phase, indexed by Phase
+    std::vector<std::shared_ptr<PhaseUDM>> m_phase_time_udms;
+
+    /// User-defined measurements of the peak physical memory of each phase, indexed by Phase
+    std::vector<std::shared_ptr<PhaseUDM>> m_phase_peak_memory_udms;
+
+    /// User-defined measurements of the allocations of each phase: the number of allocations,
+    /// the allocated bytes and the peak live bytes of each Phase in order
+    std::vector<std::shared_ptr<PhaseUDM>> m_phase_allocation_udms;
+
+    /// User-defined measurements of the hardware events of each phase: every PerfEvent of each
+    /// Phase in order
+    std::vector<std::shared_ptr<PhaseUDM>> m_phase_perf_event_udms;
+};
+
+///
+/// Benchmarks the analyze, factorize and solve phases of a solver in a single pass
+///
+/// Each benchmark iteration runs the symbolic analysis, the numerical factorization and the solve
+/// of the first rhs in order, and times each phase and monitors its peak memory separately. The
+/// separate Analyze, Factorize and Solve groups repeat the earlier phases in setUp() before timing
+/// their own, so that a sweep over the three groups runs each phase up to three times per sample.
+/// The pipeline runs each phase once, and make_final_csv() writes the average duration and the
+/// peak memory of each phase as a row of the group of the same name, next to the row of the whole
+/// pass
+///
+/// The fixture only runs if BenchmarkData::m_pipeline is set, in which case the separate groups
+/// are skipped
+///
+/// @tparam CreateSolver type of solver to use in benchmark
+///
+template <typename CreateSolver>
+class PipelineFixture : public SolverFixture<CreateSolver, AnalyzeOnly>
+{
+public:
+    ///
+    /// Returns every system if BenchmarkData::m_pipeline is set, none otherwise
+    ///
+    std::vector<celero::TestFixture::ExperimentValue> getExperimentValues() const override;
+
+    ///
+    /// Loads the system
+    ///
+    virtual void setUp(const celero::TestFixture::ExperimentValue& experimentValue) override;
+
+    ///
+    /// Waits for the systems decoded in the background, each phase being monitored by
+    /// run_pipeline()
+    ///
+    virtual void onExperimentStart(const celero::TestFixture::ExperimentValue&) override;
+
+    ///
+    /// Calculates residual of the solution
+    ///
+    virtual void onExperimentEnd() override;
+
+    ///
+    /// Compiles user-defined measurements after benchmark completes
+    ///
+    virtual void tearDown() override;
+
+    ///
+    /// Analyzes, factorizes and solves the system. The duration of each phase is added to
+    /// m_phase_time if the whole pass succeeds, and the peak memory, the hardware events and the
+    /// allocations of each phase are recorded in m_phase_peak_memory, m_phase_perf_counts and
+    /// m_phase_allocations
+    ///
+    void run_pipeline();
+
+    /// Total duration of each phase in seconds, indexed by Phase
+    std::array<double, NumPhases> m_phase_time = {};
+
+    /// Number of passes timed in m_phase_time
+    size_t m_num_passes = 0;
+};
+
+///
+/// Benchmarks the numerical refactorization of sequences of systems sharing the same sparsity
+/// pattern (.bseq files), as done by the Newton iterations or time steps of a simulation
+///
+/// The symbolic analysis runs once per sample in setUp(), and each benchmark iteration then
+/// factorizes and solves every step of the sequence in order. Besides the time of a full pass
+/// over the sequence, the fixture reports the numerical factorizations and the solves per second,
+/// and the analyze time amortized over the steps of the sequence
+///
+/// @tparam CreateSolver type of solver to use in benchmark
+///
+template <typename CreateSolver>
+class SequenceFixture : public SolverFixture<CreateSolver, AnalyzeOnly>
+{
+public:
+    ///
+    /// Selects the sequences among the systems of BenchmarkData
+    ///
+    std::vector<celero::TestFixture::ExperimentValue> getExperimentValues() const override;
+
+    ///
+    /// Maps the .bseq file, loads its first step and runs the symbolic analysis. Setup fails if
+    /// the file cannot be mapped
+    ///
+    virtual void setUp(const celero::TestFixture::ExperimentValue& experimentValue) override;
+
+    ///
+    /// Calculates residual of the last step of the sequence
+    ///
+    virtual void onExperimentEnd() override;
+
+    ///
+    /// Compiles user-defined measurements after benchmark completes
+    ///
+    virtual void tearDown() override;
+
+    ///
+    /// Factorizes and solves every step of the sequence, in order
+    ///
+    void refactorize();
+
+    ///
+    /// Copies the values of A and b of a step into m_step_A and m_b
+    ///
+    void load_step(size_t step);
+
+    /// Sequence being benchmarked. Null if setup failed
+    std::unique_ptr<benchy::io::MappedSequence> m_sequence;
+
+    /// Matrix of the current step, in the storage read by the solver
+    Eigen::SparseMatrix<Scalar, Eigen::ColMajor> m_step_A;
+
+    /// Index in the stored values of each value of m_step_A. Empty if the storage is not converted
+    std::vector<int> m_value_map;
+
+    /// Duration of the symbolic analysis in seconds
+    double m_analyze_time = 0;
+
+    /// Total duration of the numerical factorizations in seconds
+    double m_factorize_time = 0;
+
+    /// Number of numerical factorizations timed in m_factorize_time
+    size_t m_num_factorizations = 0;
+
+    /// Total duration of the solves of the steps in seconds
+    double m_solve_time = 0;
+
+    /// Number of solves timed in m_solve_time
+    size_t m_num_solves = 0;
+};
+
+///
+/// How MultiSolveFixture solves a block of right-hand sides: one call to
+/// polysolve::LinearSolver::solve per column, or a single call to the BlockSolver returned by
+/// CreateSolver::create_block()
+///
+enum class RhsMode { PerColumn, Block };
+
+///
+/// Benchmarks solves against a block of right-hand sides with a single factorization, as done for
+/// multiple load cases or modal analysis
+///
+/// Each system is benchmarked once per rhs count of BenchmarkData::m_rhs_counts. The columns of
+/// b are repeated if the system has fewer rhs. The experiment value encodes both the system and
+/// the rhs count, see getExperimentValues(). Besides the time of solving the whole block, the
+/// fixture reports the number of rhs and the number of rhs solved per second
+///
+/// The fixture only runs if BenchmarkData::m_multi_rhs is set
+///
+/// @tparam CreateSolver type of solver to use in benchmark
+/// @tparam Mode whether columns are solved one at a time or as a block
+///
+template <typename CreateSolver, RhsMode Mode>
+class MultiSolveFixture : public SolverFixture<CreateSolver, AnalyzeOnly>
+{
+public:
+    ///
+    /// Returns `index + k * num_systems` for each system index and each rhs count k if
+    /// BenchmarkData::m_multi_rhs is set, none otherwise
+    ///
+    std::vector<celero::TestFixture::ExperimentValue> getExperimentValues() const override;
+
+    ///
+    /// Loads the system, fills the block of rhs and factorizes the matrix
+    ///
+    virtual void setUp(const celero::TestFixture::ExperimentValue& experimentValue) override;
+
+    ///
+    /// Calculates the largest residual over the columns of the block
+    ///
+    virtual void onExperimentEnd() override;
+
+    ///
+    /// Compiles user-defined measurements after benchmark completes
+    ///
+    virtual void tearDown() override;
+
+    ///
+    /// Solves every column of m_B into m_X
+    ///
+    void solve();
+
+    /// Solver used for block solves. Null for RhsMode::PerColumn
+    std::unique_ptr<BlockSolver> m_block_solver;
+
+    /// Right-hand sides, one per column
+    Eigen::MatrixX<Scalar> m_B;
+
+    /// Solutions, one per column
+    Eigen::MatrixX<Scalar> m_X;
+
+    /// Total duration of the solves in seconds
+    double m_solve_time = 0;
+
+    /// Number of rhs solved in m_solve_time
+    size_t m_num_solves = 0;
+};
+
+///
+/// Benchmarks several threads solving concurrently against one factorization, as done by the
+/// request threads of a server
+///
+/// Each system is benchmarked once per thread count of BenchmarkData::m_solve_threads, with the
+/// same encoding of the experiment value as MultiSolveFixture. Every iteration runs all threads
+/// for BenchmarkData::m_solve_duration seconds, each thread calling solve() in a loop. Solvers
+/// which are not thread-safe (see CreateSolver::thread_safe_solve) are factorized once per
+/// thread. The fixture reports the number of threads, the aggregate solves per second and
+/// percentiles of the duration of individual solve calls
+///
+/// The fixture only runs if BenchmarkData::m_concurrent is set
+///
+/// @tparam CreateSolver type of solver to use in benchmark
+///
+template <typename CreateSolver>
+class ConcurrentSolveFixture : public SolverFixture<CreateSolver, SolveOnly>
+{
+public:
+    ///
+    /// Returns `index + k * num_systems` for each system index and each thread count k if
+    /// BenchmarkData::m_concurrent is set, none otherwise
+    ///
+    std::vector<celero::TestFixture::ExperimentValue> getExperimentValues() const override;
+
+    ///
+    /// Loads and factorizes the system, and factorizes the solvers of the other threads if needed
+    ///
+    virtual void setUp(const celero::TestFixture::ExperimentValue& experimentValue) override;
+
+    ///
+    /// Compiles user-defined measurements after benchmark completes
+    ///
+    virtual void tearDown() override;
+
+    ///
+    /// Runs the threads for the configured duration. The first thread runs on the calling thread
+    /// and writes its solution to m_x
+    ///
+    void solve_concurrently();
+
+    /// Solvers of the threads other than the first one, if the solver is not thread-safe
+    std::vector<std::unique_ptr<polysolve::LinearSolver>> m_thread_solvers;
+
+    /// Total duration of the runs in seconds
+    double m_solve_time = 0;
+
+    /// Number of solve calls completed in m_solve_time, over all threads
+    size_t m_num_solves = 0;
+};
+
+///
+/// Precision of the factorization of MixedPrecisionFixture: double precision, or single precision
+/// followed by iterative refinement in double precision (see MixedPrecisionSolver)
+///
+enum class Precision { Double, Mixed };
+
+///
+/// Benchmarks a single-precision factorization followed by iterative refinement in double
+/// precision, against a double-precision factorization of the same solver
+///
+/// The symbolic analysis runs in setUp(), and each benchmark iteration factorizes the matrix and
+/// solves the first rhs, so that the cheaper factorization and the extra refinement solves are
+/// timed together. Only solvers with `CreateSolver::single_precision` are benchmarked in mixed
+/// precision. Besides the residual and memory reported by every fixture, the fixture reports the
+/// number of refinement steps, which is 0 in double precision
+///
+/// The fixture only runs if BenchmarkData::m_mixed_precision is set
+///
+/// @tparam CreateSolver type of solver to use in benchmark
+/// @tparam P precision of the factorization
+///
+template <typename CreateSolver, Precision P>
+class MixedPrecisionFixture : public SolverFixture<CreateSolver, AnalyzeOnly>
+{
+public:
+    ///
+    /// Returns every system if BenchmarkData::m_mixed_precision is set, including in pipeline
+    /// mode, none otherwise
+    ///
+    std::vector<celero::TestFixture::ExperimentValue> getExperimentValues() const override;
+
+    ///
+    /// Loads the system and runs the symbolic analysis
+    ///
+    virtual void setUp(const celero::TestFixture::ExperimentValue& experimentValue) override;
+
+    ///
+    /// Calculates residual of the solution
+    ///
+    virtual void onExperimentEnd() override;
+
+    ///
+    /// Compiles user-defined measurements after benchmark completes
+    ///
+    virtual void tearDown() override;
+
+    ///
+    /// Factorizes the matrix and solves the first rhs into m_x
+    ///
+    void factorize_and_solve();
+
+    /// Double-precision solver, or MixedPrecisionSolver wrapping a single-precision solver
+    std::unique_ptr<BlockSolver> m_block_solver;
+
+    /// Right-hand side, as a block of one column
+    Eigen::MatrixX<Scalar> m_B;
+
+    /// Solution, as a block of one column
+    Eigen::MatrixX<Scalar> m_X;
 };
 
 ///
@@ -143,6 +716,65 @@ public:
     /// Holds vector of paths to all systems that will be benchmarked
     std::vector<std::filesystem::path> m_experiment_paths;
 
+    /// Pack holding the systems when the dataset is a single .bpack file, in which case the paths
+    /// refer to its members (see benchy::io::split_pack_path). Keeps the pack open and its table
+    /// in memory for the whole run
+    std::shared_ptr<const benchy::io::MappedPack> m_pack;
+
+#ifdef BENCHY_WITH_HDF5
+    /// Store holding the systems when the dataset is a single .h5 file, in which case the paths
+    /// refer to its problems (see benchy::io::split_store_path). Keeps the store open for the
+    /// whole run
+    std::shared_ptr<const benchy::io::Hdf5Store> m_store;
+#endif
+
+    /// Path to the catalog summarizing the systems (see benchy::io::Catalog). If empty, systems
+    /// are summarized without persisting the results
+    std::filesystem::path m_catalog_path;
+
+    /// Memory budget of m_cache in bytes, 0 for no limit
+    size_t m_cache_bytes = size_t(4) << 30;
+
+    /// Maximum number of systems in m_cache, 0 for no limit. Values other than 1 decode the next
+    /// system in the background between the samples of the current one
+    size_t m_cache_entries = 0;
+
+    /// Decoded systems shared by all fixtures, so that each file is only decoded once if the
+    /// budget allows it. Created on first use
+    std::unique_ptr<benchy::io::SystemCache<Scalar>> m_cache;
+
+    /// Whether the MultiSolve benchmarks run
+    bool m_multi_rhs = false;
+
+    /// Numbers of right-hand sides solved by the MultiSolve benchmarks
+    std::vector<int> m_rhs_counts = {1, 10, 100};
+
+    /// Whether the ConcurrentSolve benchmarks run
+    bool m_concurrent = false;
+
+    /// Numbers of threads of the ConcurrentSolve benchmarks
+    std::vector<int> m_solve_threads = default_thread_counts();
+
+    /// Duration in seconds of each iteration of the ConcurrentSolve benchmarks
+    double m_solve_duration = 1;
+
+    /// Whether the phases are timed in a single pass by the Pipeline benchmarks, instead of the
+    /// separate Analyze, Factorize and Solve benchmarks
+    bool m_pipeline = false;
+
+    /// Whether the MixedPrecision benchmarks run
+    bool m_mixed_precision = false;
+
+    /// Numbers of threads of the solver backends (see thread_backends()), each benchmark running
+    /// once per number. Empty to leave the backends to their defaults
+    std::vector<int> m_backend_threads;
+
+    ///
+    /// Powers of two up to the number of hardware threads, followed by the number of hardware
+    /// threads if it is not a power of two
+    ///
+    static std::vector<int> default_thread_counts();
+
 private:
     BenchmarkData() = default;
     ~BenchmarkData() = default;
@@ -175,6 +807,9 @@ std::string get_current_time();
 /// benchmark with the name of the system it ran on in the output CSV, this
 /// function creates a map from those ExperimentValues to the systems themselves.
 ///
+/// System information is read from the dataset catalog (see BenchmarkData::m_catalog_path), so
+/// matrices are only opened if they are missing from the catalog or have changed.
+///
 /// Kind of a hack. May be unnecessary depending on how this issue gets resolved:
 /// https://github.com/DigitalInBlue/Celero/issues/169
 /// https://github.com/DigitalInBlue/Celero/issues/21 also describes core issue
@@ -182,6 +817,11 @@ std::string get_current_time();
 std::map<int, std::tuple<std::string, std::string, int>> generate_index_map();
 
 /// Combines index map and celero csv into final output csv
+///
+/// Rows of the Pipeline group are followed by one row per phase, in the group of the phase, with
+/// the timing, peak memory and allocation columns holding those of the phase. The other columns
+/// are those of the pass
+///
 /// @param[in] celero_csv CSV containing information from benchmark provided by Celero
 /// @param[in] output_dir Directory to output final CSV to
 void make_final_csv(fs::path celero_csv, fs::path output_dir);
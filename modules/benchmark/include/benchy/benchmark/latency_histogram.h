@@ -0,0 +1,97 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+// System include
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace benchy {
+namespace benchmark {
+
+///
+/// Histogram of durations with logarithmic buckets, to compute latency percentiles over millions
+/// of calls without storing every duration
+///
+/// Consecutive buckets are 2^(1/32) apart, so percentiles are within 2.2% of the exact value.
+/// Durations from 1 ns to about 18 minutes are distinguished.
+///
+class LatencyHistogram
+{
+public:
+    ///
+    /// Adds a duration
+    /// @param[in] seconds Duration in seconds
+    ///
+    void add(double seconds)
+    {
+        const double ns = std::max(seconds * 1e9, 1.0);
+        const auto bucket = static_cast<size_t>(std::log2(ns) * kBucketsPerOctave);
+        ++m_counts[std::min(bucket, kNumBuckets - 1)];
+        ++m_count;
+    }
+
+    ///
+    /// Adds all durations of another histogram
+    ///
+    void merge(const LatencyHistogram& other)
+    {
+        for (size_t i = 0; i < kNumBuckets; ++i) {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_count += other.m_count;
+    }
+
+    ///
+    /// Returns the duration below which a fraction of the durations fall, in seconds
+    /// @param[in] p Fraction between 0 and 1, e.g. 0.99 for the 99th percentile
+    /// @returns Upper bound of the bucket holding the percentile, 0 if the histogram is empty
+    ///
+    double percentile(double p) const
+    {
+        if (m_count == 0) {
+            return 0;
+        }
+        const auto rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(p * m_count)), 1);
+        uint64_t seen = 0;
+        size_t i = 0;
+        for (; i + 1 < kNumBuckets; ++i) {
+            seen += m_counts[i];
+            if (seen >= rank) {
+                break;
+            }
+        }
+        return std::exp2(static_cast<double>(i + 1) / kBucketsPerOctave) * 1e-9;
+    }
+
+    /// Number of durations added
+    uint64_t count() const { return m_count; }
+
+    /// Removes all durations
+    void clear()
+    {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_count = 0;
+    }
+
+private:
+    static constexpr size_t kBucketsPerOctave = 32;
+    static constexpr size_t kNumBuckets = 40 * kBucketsPerOctave;
+
+    std::vector<uint64_t> m_counts = std::vector<uint64_t>(kNumBuckets, 0);
+    uint64_t m_count = 0;
+};
+
+} // namespace benchmark
+} // namespace benchy
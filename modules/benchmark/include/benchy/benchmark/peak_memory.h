@@ -0,0 +1,77 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+// System include
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+namespace benchy {
+namespace benchmark {
+
+///
+/// Measures the peak physical memory of a section of code, over the physical memory of the
+/// process when the section starts
+///
+/// On Linux, the peak resident set size of the process (VmHWM) is reset through
+/// /proc/self/clear_refs when the section starts, and read from /proc/self/status when it ends.
+/// On other systems, or if the kernel does not allow resetting the peak, a background thread
+/// samples getCurrentRSS() every millisecond while the section runs, which may miss short peaks.
+///
+class PeakMemoryMonitor
+{
+public:
+    ///
+    /// Stops the sampling thread, if any
+    ///
+    ~PeakMemoryMonitor();
+
+    ///
+    /// Starts a section: records the current physical memory and resets the peak
+    ///
+    void start();
+
+    ///
+    /// Ends the section started by start()
+    /// @returns Peak physical memory over the memory at the start of the section in bytes, 0 if
+    /// the memory never grew
+    ///
+    size_t stop();
+
+    /// Whether a section is started
+    bool running() const { return m_running; }
+
+    ///
+    /// Whether the peak of the process can be reset, in which case no sampling thread is needed
+    ///
+    static bool can_reset_peak();
+
+private:
+    /// Physical memory at the start of the section in bytes
+    size_t m_baseline = 0;
+
+    /// Whether a section is started
+    bool m_running = false;
+
+    /// Whether m_sampler runs
+    std::atomic<bool> m_sampling = false;
+
+    /// Largest physical memory seen by m_sampler in bytes
+    std::atomic<size_t> m_sampled_peak = 0;
+
+    /// Thread sampling the physical memory, if the peak cannot be reset
+    std::thread m_sampler;
+};
+
+} // namespace benchmark
+} // namespace benchy
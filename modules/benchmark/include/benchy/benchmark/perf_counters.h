@@ -0,0 +1,136 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+// System include
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace benchy {
+namespace benchmark {
+
+///
+/// Hardware events counted by PerfCounters
+///
+enum class PerfEvent { Cycles, Instructions, LLCMisses, BranchMisses, FPOps };
+
+/// Number of values of PerfEvent
+constexpr size_t NumPerfEvents = 5;
+
+///
+/// Name of an event, which is also the name of its user-defined measurement, e.g. "LLC Misses"
+///
+const char* perf_event_name(PerfEvent event);
+
+///
+/// Counts of hardware events of a section of code
+///
+struct PerfCounts
+{
+    /// Count of each event, indexed by PerfEvent. -1 for events which are not counted
+    std::array<double, NumPerfEvents> values = {-1, -1, -1, -1, -1};
+
+    /// Count of an event, -1 if it is not counted
+    double operator[](PerfEvent event) const { return values[size_t(event)]; }
+
+    ///
+    /// Adds the counts of another section
+    ///
+    void merge(const PerfCounts& other)
+    {
+        for (size_t e = 0; e < NumPerfEvents; ++e) {
+            if (other.values[e] >= 0) {
+                values[e] = std::max(values[e], 0.0) + other.values[e];
+            }
+        }
+    }
+};
+
+///
+/// Counts hardware events of all threads of the process with Linux perf events
+/// (`perf_event_open`), between start() and stop()
+///
+/// The events are the CPU cycles, the instructions, the last level cache misses and the branch
+/// misses, as exposed by the generic events of the kernel, and the double-precision floating-point
+/// operations on Intel CPUs (Broadwell and later), computed from the FP_ARITH_INST_RETIRED events
+/// weighted by the number of operations per instruction. Only user-space events are counted.
+///
+/// A counter of each event is opened for each thread of the process when the section starts, and
+/// is inherited by the threads it creates, whose counts are added when they exit. Threads created
+/// during the section and still running at its end, e.g. a thread pool started by the first call
+/// to a solver, are not counted. Counters are scaled if the events are multiplexed.
+///
+/// Threads unrelated to the section are counted as well, so background work must be finished
+/// before start(). The benchmark waits for the systems being decoded by benchy::io::SystemCache,
+/// whose loading and decompression threads would otherwise be added to the solver.
+///
+/// Events which cannot be opened, e.g. on other systems, in virtual machines without a virtual
+/// PMU, or if `/proc/sys/kernel/perf_event_paranoid` forbids it, are reported as -1.
+///
+class PerfCounters
+{
+public:
+    PerfCounters() = default;
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ///
+    /// Closes the counters, if any
+    ///
+    ~PerfCounters();
+
+    ///
+    /// Opens and starts the counters of every thread of the process
+    ///
+    void start();
+
+    ///
+    /// Ends the section started by start() and closes the counters
+    /// @returns Counts of the events of the section
+    ///
+    PerfCounts stop();
+
+    /// Whether a section is started
+    bool running() const { return m_running; }
+
+    ///
+    /// Whether any event can be counted on this system. The events are probed on first call
+    ///
+    static bool available();
+
+    ///
+    /// Whether an event can be counted on this system
+    ///
+    static bool supported(PerfEvent event);
+
+private:
+    /// Counter of an event of a thread
+    struct Counter
+    {
+        /// File descriptor returned by perf_event_open
+        int fd;
+
+        /// Index of the counted event in the list of supported events
+        size_t spec;
+    };
+
+    /// Open counters
+    std::vector<Counter> m_counters;
+
+    /// Whether a section is started
+    bool m_running = false;
+};
+
+} // namespace benchmark
+} // namespace benchy
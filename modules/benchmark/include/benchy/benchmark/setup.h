@@ -29,7 +29,7 @@ struct AnalyzeOnly
 {
     static SetupStatus prepare(
         std::unique_ptr<polysolve::LinearSolver>& solver,
-        Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A)
+        const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A)
     {
         return SetupStatus::SUCCESS;
     }
@@ -42,7 +42,7 @@ struct FactorizeOnly
 {
     static SetupStatus prepare(
         std::unique_ptr<polysolve::LinearSolver>& solver,
-        Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A)
+        const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A)
     {
         solver->analyzePattern(A, A.rows());
         return SetupStatus::SUCCESS;
@@ -56,7 +56,7 @@ struct SolveOnly
 {
     static SetupStatus prepare(
         std::unique_ptr<polysolve::LinearSolver>& solver,
-        Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A)
+        const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A)
     {
         SetupStatus status = SetupStatus::SUCCESS;
         solver->analyzePattern(A, A.rows());
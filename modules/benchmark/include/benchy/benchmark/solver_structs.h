@@ -10,20 +10,218 @@
  * governing permissions and limitations under the License.
  */
 
+#pragma once
+
+// Local include
+#include <benchy/io/symmetric_storage.h>
+
 // Third-party include
+#include <Eigen/SparseCholesky>
 #include <polysolve/LinearSolver.hpp>
+#ifdef BENCHY_BENCHMARK_CHOLMOD
+    #include <Eigen/CholmodSupport>
+#endif
+#ifdef BENCHY_WITH_ACCELERATE
+    #include <Eigen/AccelerateSupport>
+#endif
+#ifdef BENCHY_WITH_MKL
+    #include <Eigen/PardisoSupport>
+#endif
+
+// System include
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
 
 using Scalar = double;
 
+///
+/// Direct solver taking a dense block of right-hand sides in a single call, which polysolve does
+/// not expose (polysolve::LinearSolver::solve only takes one vector)
+///
+/// @tparam BlockScalar scalar type of the factorization. polysolve only factorizes in double
+/// precision, so single-precision factorizations are only available through this interface
+///
+template <typename BlockScalar>
+class BasicBlockSolver
+{
+public:
+    virtual ~BasicBlockSolver() = default;
+    virtual void analyzePattern(const Eigen::SparseMatrix<BlockScalar>& A) = 0;
+    virtual void factorize(const Eigen::SparseMatrix<BlockScalar>& A) = 0;
+    virtual void solve(const Eigen::MatrixX<BlockScalar>& B, Eigen::MatrixX<BlockScalar>& X) = 0;
+};
+
+using BlockSolver = BasicBlockSolver<Scalar>;
+
+///
+/// BlockSolver calling an Eigen sparse solver, or an Eigen wrapper of an external library. The
+/// solver is the one wrapped by polysolve, so that both give the same factorization
+///
+/// @tparam EigenSolver Eigen solver class, e.g. Eigen::SimplicialLDLT
+///
+template <typename EigenSolver>
+class EigenBlockSolver : public BasicBlockSolver<typename EigenSolver::Scalar>
+{
+public:
+    using BlockScalar = typename EigenSolver::Scalar;
+
+    void analyzePattern(const Eigen::SparseMatrix<BlockScalar>& A) override
+    {
+        m_solver.analyzePattern(A);
+    }
+
+    void factorize(const Eigen::SparseMatrix<BlockScalar>& A) override
+    {
+        m_solver.factorize(A);
+        if (m_solver.info() != Eigen::Success) {
+            throw std::runtime_error("[EigenBlockSolver] Factorization failed");
+        }
+    }
+
+    void solve(const Eigen::MatrixX<BlockScalar>& B, Eigen::MatrixX<BlockScalar>& X) override
+    {
+        X = m_solver.solve(B);
+        if (m_solver.info() != Eigen::Success) {
+            throw std::runtime_error("[EigenBlockSolver] Solve failed");
+        }
+    }
+
+private:
+    EigenSolver m_solver;
+};
+
+///
+/// BlockSolver factorizing a single-precision copy of the matrix, then refining the solution in
+/// double precision
+///
+/// Each refinement step computes the residual `r = b - A x` in double precision and adds the
+/// correction `A^-1 r` obtained with the single-precision factors. The factors take half the
+/// memory of a double-precision factorization, and the refined solution reaches double-precision
+/// accuracy when the condition number of A is well below 1 / eps(float), about 1e7
+///
+class MixedPrecisionSolver : public BlockSolver
+{
+public:
+    ///
+    /// @param[in] solver Single-precision solver
+    /// @param[in] stored Part of the matrices passed to factorize() which is stored
+    /// @param[in] max_steps Maximum number of refinement steps per solve
+    /// @param[in] tolerance Relative residual `|b - A x| / |b|` at which refinement stops
+    ///
+    MixedPrecisionSolver(
+        std::unique_ptr<BasicBlockSolver<float>> solver,
+        benchy::io::StoredTriangle stored,
+        int max_steps = 10,
+        double tolerance = 1e-12)
+        : m_solver(std::move(solver))
+        , m_stored(stored)
+        , m_max_steps(max_steps)
+        , m_tolerance(tolerance)
+    {}
+
+    void analyzePattern(const Eigen::SparseMatrix<Scalar>& A) override
+    {
+        m_A_float = A.cast<float>();
+        m_solver->analyzePattern(m_A_float);
+    }
+
+    ///
+    /// Factorizes A in single precision. A is used to compute residuals, and must stay alive
+    /// until the last call to solve()
+    ///
+    void factorize(const Eigen::SparseMatrix<Scalar>& A) override
+    {
+        m_A = &A;
+        m_A_float = A.cast<float>();
+        m_solver->factorize(m_A_float);
+    }
+
+    void solve(const Eigen::MatrixX<Scalar>& B, Eigen::MatrixX<Scalar>& X) override
+    {
+        if (m_A == nullptr) {
+            throw std::runtime_error("[MixedPrecisionSolver] Matrix is not factorized");
+        }
+        m_solver->solve(B.cast<float>(), m_X_float);
+        X = m_X_float.cast<Scalar>();
+
+        Scalar previous = std::numeric_limits<Scalar>::infinity();
+        m_num_steps = 0;
+        for (;; ++m_num_steps) {
+            // Largest relative residual over the columns
+            Scalar residual = 0;
+            m_R.resize(B.rows(), B.cols());
+            for (Eigen::Index j = 0; j < B.cols(); ++j) {
+                const Eigen::VectorX<Scalar> x = X.col(j);
+                m_R.col(j) = B.col(j) - benchy::io::multiply(*m_A, m_stored, x);
+                const Scalar b_norm = B.col(j).norm();
+                residual = std::max(residual, m_R.col(j).norm() / (b_norm > 0 ? b_norm : 1));
+            }
+            // Stops when the single-precision factors are too inaccurate to reduce the residual,
+            // keeping the previous iterate, which has the lowest residual so far
+            if (residual >= previous) {
+                X.swap(m_X_previous);
+                --m_num_steps;
+                break;
+            }
+            if (residual <= m_tolerance || m_num_steps == m_max_steps) {
+                break;
+            }
+            previous = residual;
+            m_X_previous = X;
+            m_solver->solve(m_R.cast<float>(), m_X_float);
+            X += m_X_float.cast<Scalar>();
+        }
+    }
+
+    /// Number of refinement steps of the last solve, not counting a final step which did not
+    /// reduce the residual and was discarded
+    int num_refinement_steps() const { return m_num_steps; }
+
+private:
+    std::unique_ptr<BasicBlockSolver<float>> m_solver;
+    benchy::io::StoredTriangle m_stored;
+    int m_max_steps;
+    double m_tolerance;
+    const Eigen::SparseMatrix<Scalar>* m_A = nullptr;
+    Eigen::SparseMatrix<float> m_A_float;
+    Eigen::MatrixX<Scalar> m_R;
+    Eigen::MatrixX<Scalar> m_X_previous;
+    Eigen::MatrixXf m_X_float;
+    int m_num_steps = 0;
+};
+
+// Each wrapper declares which part of a symmetric matrix its solver reads (`accepted_triangle`).
+// SPD systems stored as a single triangle are passed as-is to solvers reading that triangle, and
+// converted otherwise (see SolverFixture::setUp). Wrappers of Eigen solvers also provide
+// `create_block()`, which returns the same solver with support for blocks of right-hand sides.
+// Wrappers also declare whether several threads may call `solve()` on the same factorization
+// (`thread_safe_solve`). Otherwise, ConcurrentSolveFixture factorizes one solver per thread.
+// Wrappers whose Eigen solver also factorizes in single precision (`single_precision`) provide
+// `create_block<float>()`, which MixedPrecisionFixture uses for mixed-precision solves.
+
 ///
 /// Thin wrapper over Eigen::SimplicialLDLT
 ///
 struct CreateEigenSolver
 {
+    static constexpr benchy::io::StoredTriangle accepted_triangle =
+        benchy::io::StoredTriangle::Lower;
+    static constexpr bool thread_safe_solve = true;
+    static constexpr bool single_precision = true;
+
     static std::unique_ptr<polysolve::LinearSolver> create()
     {
         return polysolve::LinearSolver::create("Eigen::SimplicialLDLT", "");
     }
+
+    template <typename BlockScalar = Scalar>
+    static std::unique_ptr<BasicBlockSolver<BlockScalar>> create_block()
+    {
+        using Solver = Eigen::SimplicialLDLT<Eigen::SparseMatrix<BlockScalar>>;
+        return std::make_unique<EigenBlockSolver<Solver>>();
+    }
 };
 
 ///
@@ -31,10 +229,23 @@ struct CreateEigenSolver
 ///
 struct CreateCholmodSolver
 {
+    static constexpr benchy::io::StoredTriangle accepted_triangle =
+        benchy::io::StoredTriangle::Lower;
+    static constexpr bool thread_safe_solve = false;
+    static constexpr bool single_precision = false;
+
     static std::unique_ptr<polysolve::LinearSolver> create()
     {
         return polysolve::LinearSolver::create("Eigen::CholmodSupernodalLLT", "");
     }
+
+#ifdef BENCHY_BENCHMARK_CHOLMOD
+    static std::unique_ptr<BlockSolver> create_block()
+    {
+        using Solver = Eigen::CholmodSupernodalLLT<Eigen::SparseMatrix<Scalar>>;
+        return std::make_unique<EigenBlockSolver<Solver>>();
+    }
+#endif
 };
 
 ///
@@ -42,10 +253,23 @@ struct CreateCholmodSolver
 ///
 struct CreateCholmodSimplicialSolver
 {
+    static constexpr benchy::io::StoredTriangle accepted_triangle =
+        benchy::io::StoredTriangle::Lower;
+    static constexpr bool thread_safe_solve = false;
+    static constexpr bool single_precision = false;
+
     static std::unique_ptr<polysolve::LinearSolver> create()
     {
         return polysolve::LinearSolver::create("Eigen::CholmodSimplicialLLT", "");
     }
+
+#ifdef BENCHY_BENCHMARK_CHOLMOD
+    static std::unique_ptr<BlockSolver> create_block()
+    {
+        using Solver = Eigen::CholmodSimplicialLLT<Eigen::SparseMatrix<Scalar>>;
+        return std::make_unique<EigenBlockSolver<Solver>>();
+    }
+#endif
 };
 
 #ifdef BENCHY_WITH_ACCELERATE
@@ -54,10 +278,22 @@ struct CreateCholmodSimplicialSolver
 ///
 struct CreateAccelerateLLTSolver
 {
+    static constexpr benchy::io::StoredTriangle accepted_triangle =
+        benchy::io::StoredTriangle::Lower;
+    static constexpr bool thread_safe_solve = false;
+    static constexpr bool single_precision = true;
+
     static std::unique_ptr<polysolve::LinearSolver> create()
     {
         return polysolve::LinearSolver::create("Eigen::AccelerateLLT", "");
     }
+
+    template <typename BlockScalar = Scalar>
+    static std::unique_ptr<BasicBlockSolver<BlockScalar>> create_block()
+    {
+        using Solver = Eigen::AccelerateLLT<Eigen::SparseMatrix<BlockScalar>>;
+        return std::make_unique<EigenBlockSolver<Solver>>();
+    }
 };
 
 ///
@@ -65,10 +301,22 @@ struct CreateAccelerateLLTSolver
 ///
 struct CreateAccelerateLDLTSolver
 {
+    static constexpr benchy::io::StoredTriangle accepted_triangle =
+        benchy::io::StoredTriangle::Lower;
+    static constexpr bool thread_safe_solve = false;
+    static constexpr bool single_precision = true;
+
     static std::unique_ptr<polysolve::LinearSolver> create()
     {
         return polysolve::LinearSolver::create("Eigen::AccelerateLDLT", "");
     }
+
+    template <typename BlockScalar = Scalar>
+    static std::unique_ptr<BasicBlockSolver<BlockScalar>> create_block()
+    {
+        using Solver = Eigen::AccelerateLDLT<Eigen::SparseMatrix<BlockScalar>>;
+        return std::make_unique<EigenBlockSolver<Solver>>();
+    }
 };
 #endif
 
@@ -78,6 +326,11 @@ struct CreateAccelerateLDLTSolver
 ///
 struct CreateSympilerSolver
 {
+    static constexpr benchy::io::StoredTriangle accepted_triangle =
+        benchy::io::StoredTriangle::Full;
+    static constexpr bool thread_safe_solve = false;
+    static constexpr bool single_precision = false;
+
     static std::unique_ptr<polysolve::LinearSolver> create()
     {
         return polysolve::LinearSolver::create("Sympiler", "");
@@ -91,9 +344,20 @@ struct CreateSympilerSolver
 ///
 struct CreatePardisoSolver
 {
+    static constexpr benchy::io::StoredTriangle accepted_triangle =
+        benchy::io::StoredTriangle::Upper;
+    static constexpr bool thread_safe_solve = false;
+    static constexpr bool single_precision = false;
+
     static std::unique_ptr<polysolve::LinearSolver> create()
     {
         return polysolve::LinearSolver::create("Eigen::PardisoLLT", "");
     }
+
+    static std::unique_ptr<BlockSolver> create_block()
+    {
+        using Solver = Eigen::PardisoLLT<Eigen::SparseMatrix<Scalar>>;
+        return std::make_unique<EigenBlockSolver<Solver>>();
+    }
 };
 #endif
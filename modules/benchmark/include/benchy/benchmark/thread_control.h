@@ -0,0 +1,45 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+// System include
+#include <string>
+#include <vector>
+
+namespace benchy {
+namespace benchmark {
+
+///
+/// Names of the threading backends of the solvers whose number of threads can be set, e.g.
+/// {"OpenMP", "MKL"}
+///
+/// Backends are found among the libraries loaded by the process, so that only the libraries the
+/// solvers are linked against are listed: OpenMP (`omp_set_num_threads`), MKL
+/// (`MKL_Set_Num_Threads`), OpenBLAS (`openblas_set_num_threads`) and BLIS
+/// (`bli_thread_set_num_threads`). Eigen uses the OpenMP setting. Accelerate and TBB have no such
+/// function, and libraries linked statically without exporting their symbols are not found. No
+/// backend is found on Windows
+///
+const std::vector<std::string>& thread_backends();
+
+///
+/// Sets the number of threads of every backend listed by thread_backends()
+///
+/// The OpenMP setting only applies to the calling thread and to the parallel regions it starts,
+/// so every thread calling a solver should call this function
+///
+/// @param[in] num_threads Number of threads, at least 1
+///
+void set_backend_threads(int num_threads);
+
+} // namespace benchmark
+} // namespace benchy
@@ -0,0 +1,323 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+// Local include
+#include <benchy/benchmark/allocation_tracker.h>
+
+#ifdef BENCHY_TRACK_ALLOCATIONS
+
+// System include
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#include <cstdlib>
+#else
+#include <malloc.h>
+#include <cstdlib>
+#endif
+
+namespace benchy {
+namespace benchmark {
+
+namespace {
+
+/// Number of per-thread counters. Threads share counters beyond this number of threads
+constexpr unsigned NumThreadCounters = 64;
+
+///
+/// Counters of the allocations of a thread, on their own cache line. Only updated by the thread
+/// owning them, they are atomic so that they can be read and reset by the tracking thread
+///
+struct alignas(64) ThreadCounters
+{
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+std::atomic<bool> g_tracking{false};
+ThreadCounters g_thread_counters[NumThreadCounters];
+std::atomic<unsigned> g_num_threads{0};
+std::atomic<int64_t> g_live_bytes{0};
+std::atomic<int64_t> g_peak_live_bytes{0};
+
+/// Index of the counters of the current thread. Constant-initialized, so that reading it never
+/// allocates
+thread_local unsigned t_counters = NumThreadCounters;
+
+size_t usable_size(void* ptr)
+{
+#if defined(__APPLE__)
+    return malloc_size(ptr);
+#elif defined(_WIN32)
+    return _msize(ptr);
+#else
+    return malloc_usable_size(ptr);
+#endif
+}
+
+bool tracking()
+{
+    return g_tracking.load(std::memory_order_relaxed);
+}
+
+void count_allocation(void* ptr, size_t size)
+{
+    if (ptr == nullptr || !tracking()) {
+        return;
+    }
+    if (t_counters == NumThreadCounters) {
+        t_counters = g_num_threads.fetch_add(1, std::memory_order_relaxed) % NumThreadCounters;
+    }
+    auto& counters = g_thread_counters[t_counters];
+    counters.count.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(size, std::memory_order_relaxed);
+    const auto usable = static_cast<int64_t>(usable_size(ptr));
+    const int64_t live = g_live_bytes.fetch_add(usable, std::memory_order_relaxed) + usable;
+    int64_t peak = g_peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_peak_live_bytes.compare_exchange_weak(
+                              peak,
+                              live,
+                              std::memory_order_relaxed)) {
+    }
+}
+
+void count_freed_bytes(size_t usable)
+{
+    g_live_bytes.fetch_sub(static_cast<int64_t>(usable), std::memory_order_relaxed);
+}
+
+void count_free(void* ptr)
+{
+    if (ptr == nullptr || !tracking()) {
+        return;
+    }
+    count_freed_bytes(usable_size(ptr));
+}
+
+} // namespace
+
+bool allocation_tracking_enabled()
+{
+    return true;
+}
+
+void start_allocation_tracking()
+{
+    g_tracking = false;
+    for (auto& counters : g_thread_counters) {
+        counters.count = 0;
+        counters.bytes = 0;
+    }
+    g_live_bytes = 0;
+    g_peak_live_bytes = 0;
+    g_tracking = true;
+}
+
+AllocationStats stop_allocation_tracking()
+{
+    g_tracking = false;
+    AllocationStats stats;
+    for (const auto& counters : g_thread_counters) {
+        stats.count += counters.count;
+        stats.bytes += counters.bytes;
+    }
+    stats.peak_live_bytes = static_cast<uint64_t>(g_peak_live_bytes.load());
+    return stats;
+}
+
+} // namespace benchmark
+} // namespace benchy
+
+using benchy::benchmark::count_allocation;
+using benchy::benchmark::count_free;
+using benchy::benchmark::count_freed_bytes;
+using benchy::benchmark::tracking;
+
+#if defined(__GLIBC__)
+
+// With glibc, the allocation functions of the C library are replaced by wrappers around the
+// original implementations, which glibc exports under another name. operator new calls malloc
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t num, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void* __libc_valloc(size_t size);
+void* __libc_pvalloc(size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) noexcept
+{
+    void* ptr = __libc_malloc(size);
+    count_allocation(ptr, size);
+    return ptr;
+}
+
+void* calloc(size_t num, size_t size) noexcept
+{
+    void* ptr = __libc_calloc(num, size);
+    count_allocation(ptr, num * size);
+    return ptr;
+}
+
+void* realloc(void* ptr, size_t size) noexcept
+{
+    // The old block is only freed if the reallocation succeeds
+    const size_t old_size = (ptr != nullptr && tracking() ? malloc_usable_size(ptr) : 0);
+    void* new_ptr = __libc_realloc(ptr, size);
+    if (new_ptr != nullptr || size == 0) {
+        count_freed_bytes(old_size);
+        count_allocation(new_ptr, size);
+    }
+    return new_ptr;
+}
+
+void* memalign(size_t alignment, size_t size) noexcept
+{
+    void* ptr = __libc_memalign(alignment, size);
+    count_allocation(ptr, size);
+    return ptr;
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) noexcept
+{
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* ptr = __libc_memalign(alignment, size);
+    if (ptr == nullptr) {
+        return ENOMEM;
+    }
+    count_allocation(ptr, size);
+    *out = ptr;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    return memalign(alignment, size);
+}
+
+void* valloc(size_t size) noexcept
+{
+    void* ptr = __libc_valloc(size);
+    count_allocation(ptr, size);
+    return ptr;
+}
+
+void* pvalloc(size_t size) noexcept
+{
+    void* ptr = __libc_pvalloc(size);
+    count_allocation(ptr, size);
+    return ptr;
+}
+
+void free(void* ptr) noexcept
+{
+    count_free(ptr);
+    __libc_free(ptr);
+}
+
+} // extern "C"
+
+#else
+
+// Elsewhere, only the global operator new and operator delete are replaced. Aligned variants
+// are left to the standard library and not counted
+
+void* operator new(size_t size)
+{
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    count_allocation(ptr, size);
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    count_allocation(ptr, size);
+    return ptr;
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    count_free(ptr);
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    operator delete(ptr);
+}
+
+#endif
+
+#else
+
+namespace benchy {
+namespace benchmark {
+
+bool allocation_tracking_enabled()
+{
+    return false;
+}
+
+void start_allocation_tracking() {}
+
+AllocationStats stop_allocation_tracking()
+{
+    return {};
+}
+
+} // namespace benchmark
+} // namespace benchy
+
+#endif
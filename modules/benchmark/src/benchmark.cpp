@@ -14,8 +14,8 @@
 #include <benchy/benchmark/getRSS.h>
 #include <benchy/benchmark/setup.h>
 #include <benchy/benchmark/solver_structs.h>
-#include <benchy/io/json_eigen.h>
-#include <benchy/io/json_io.h>
+#include <benchy/io/catalog.h>
+#include <benchy/io/symmetric_storage.h>
 
 // Third-party include
 #include <celero/Celero.h>
@@ -23,8 +23,13 @@
 #include <unsupported/Eigen/SparseExtra>
 
 // System include
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <ctime>
 #include <filesystem>
+#include <numeric>
+#include <thread>
 
 using Scalar = double;
 namespace fs = std::filesystem;
@@ -32,221 +37,1605 @@ namespace fs = std::filesystem;
 namespace benchy {
 namespace benchmark {
 
+namespace {
+
+///
+/// Number of runs of each benchmark over the numbers of backend threads, 1 if they are not swept
+///
+int64_t num_thread_runs()
+{
+    return std::max<int64_t>(1, BenchmarkData::instance().m_backend_threads.size());
+}
+
+///
+/// Experiment value of a system, a run over the numbers of backend threads and a variant specific
+/// to the group, e.g. a number of rhs of MultiSolve. The system varies fastest, so that the system
+/// of any experiment value is `value % num_systems`
+///
+int64_t experiment_value(int64_t system, int64_t thread_run, int64_t variant)
+{
+    const int64_t num_systems = BenchmarkData::instance().m_experiment_paths.size();
+    return system + num_systems * (thread_run + num_thread_runs() * variant);
+}
+
+///
+/// Index in BenchmarkData::m_backend_threads of an experiment value
+///
+int64_t experiment_thread_run(int64_t value)
+{
+    const int64_t num_systems = BenchmarkData::instance().m_experiment_paths.size();
+    return (value / num_systems) % num_thread_runs();
+}
+
+///
+/// Variant specific to the group of an experiment value
+///
+int64_t experiment_variant(int64_t value)
+{
+    const int64_t num_systems = BenchmarkData::instance().m_experiment_paths.size();
+    return value / (num_systems * num_thread_runs());
+}
+
+///
+/// Returns the index of every system of BenchmarkData, for each number of backend threads
+///
+std::vector<celero::TestFixture::ExperimentValue> system_experiment_values()
+{
+    std::vector<celero::TestFixture::ExperimentValue> problemSpace;
+    for (int64_t t = 0; t < num_thread_runs(); t++) {
+        for (int i = 0; i < BenchmarkData::instance().m_experiment_paths.size(); i++) {
+            problemSpace.push_back(experiment_value(i, t, 0));
+        }
+    }
+    return problemSpace;
+}
+
+///
+/// Waits for the systems decoded in the background, whose memory, allocations and hardware
+/// events would otherwise be measured with the solver
+///
+void wait_for_prefetch()
+{
+    if (const auto& cache = BenchmarkData::instance().m_cache) {
+        cache->wait_pending();
+    }
+}
+
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Output CSV and benchmark runner
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void run_benchmarks(char* exe_name, fs::path output_dir)
+void run_benchmarks(char* exe_name, fs::path output_dir)
+{
+    std::string filename = get_current_time() + "_results.csv";
+    fs::path output_file = output_dir / filename;
+
+    int argc = 3;
+    // Command-line arguments
+    std::vector<std::string> argv_s;
+    std::vector<char*> argv_v;
+    argv_s.push_back(exe_name);
+    argv_s.push_back("-t"); // Command-line arg to write to CSV
+    argv_s.push_back(output_file.string());
+    for (auto& x : argv_s) {
+        x.push_back('\0');
+        argv_v.push_back(x.data());
+    }
+    spdlog::info("Running benchmarks");
+    celero::Run(argc, &argv_v[0]);
+    if (const auto& cache = BenchmarkData::instance().m_cache) {
+        spdlog::info(
+            "System cache: {} hits, {} misses, {} evictions, {} MB in use",
+            cache->num_hits(),
+            cache->num_misses(),
+            cache->num_evictions(),
+            cache->num_bytes() >> 20);
+    }
+    BenchmarkData::instance().m_cache.reset();
+    make_final_csv(output_file, output_dir);
+}
+
+std::vector<int> BenchmarkData::default_thread_counts()
+{
+    const int num_cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<int> counts;
+    for (int count = 1; count < num_cores; count *= 2) {
+        counts.push_back(count);
+    }
+    counts.push_back(num_cores);
+    return counts;
+}
+
+std::string get_current_time()
+{
+    std::time_t t = std::time(nullptr);
+    std::string datetime(100, 0);
+    datetime.resize(
+        std::strftime(&datetime[0], datetime.size(), "%Y_%m_%d_%H_%M", std::localtime(&t)));
+    return datetime;
+}
+
+std::map<int, std::tuple<std::string, std::string, int>> generate_index_map()
+{
+    std::map<int, std::tuple<std::string, std::string, int>> index_map;
+    spdlog::info("Generating index map");
+    std::vector<fs::path> matrix_paths = BenchmarkData::instance().m_experiment_paths;
+    benchy::io::Catalog catalog(BenchmarkData::instance().m_catalog_path);
+    for (int i = 0; i < matrix_paths.size(); ++i) {
+        const auto& info = catalog.get(matrix_paths[i]);
+        auto parent_path = matrix_paths[i].parent_path().filename();
+        auto filename = matrix_paths[i].filename();
+        auto print_path = parent_path / filename;
+        index_map[i] = {print_path.string(), info.dataset_name, info.nnz};
+    }
+    catalog.save();
+    return index_map;
+}
+
+void make_final_csv(fs::path celero_csv, fs::path output_dir)
+{
+    spdlog::info("Generating final output CSV");
+    std::map<int, std::tuple<std::string, std::string, int>> index_map = generate_index_map();
+    std::ifstream celero_stream(celero_csv);
+
+    std::string filename = get_current_time() + "_benchmark_data.csv";
+    fs::path output_file = output_dir / filename;
+    std::ofstream output_stream(output_file);
+
+    auto split = [](const std::string& line) {
+        std::vector<std::string> cells;
+        std::stringstream lineStream(line);
+        std::string cell;
+        while (std::getline(lineStream, cell, ',')) {
+            cells.push_back(cell);
+        }
+        return cells;
+    };
+
+    std::string line;
+    std::getline(celero_stream, line);
+    const std::vector<std::string> header = split(line);
+    auto column = [&](const std::string& name) {
+        const auto it = std::find(header.begin(), header.end(), name);
+        return it == header.end() ? -1 : static_cast<int>(it - header.begin());
+    };
+
+    // Instructions per cycle and GFLOP/s are derived from the hardware events, when counted
+    const int cycles_column = column(std::string(perf_event_name(PerfEvent::Cycles)) + " Mean");
+    const int instructions_column =
+        column(std::string(perf_event_name(PerfEvent::Instructions)) + " Mean");
+    const int flops_column = column(std::string(perf_event_name(PerfEvent::FPOps)) + " Mean");
+    const int iterations_column = column("Iterations");
+    const int time_column = column("us/Iteration");
+    auto cell_value = [](const std::vector<std::string>& cells, int c) {
+        return c >= 0 && c < static_cast<int>(cells.size()) ? std::stod(cells[c]) : -1.0;
+    };
+    auto derived_cells = [&](const std::vector<std::string>& cells) {
+        const double cycles = cell_value(cells, cycles_column);
+        const double instructions = cell_value(cells, instructions_column);
+        const double flops = cell_value(cells, flops_column);
+        const double iterations = cell_value(cells, iterations_column);
+        const double us = cell_value(cells, time_column);
+        const double ipc = cycles > 0 && instructions >= 0 ? instructions / cycles : -1;
+        const double gflops =
+            flops >= 0 && iterations > 0 && us > 0 ? flops / iterations / (us * 1e3) : -1;
+        return "," + std::to_string(ipc) + "," + std::to_string(gflops);
+    };
+
+    // Rows of a sweep over the numbers of backend threads are compared to the row of the same
+    // group, solver, system and variant with the fewest threads. Speedups are ratios of the solve
+    // rate where it is reported, as ConcurrentSolve iterations have a fixed duration, and of the
+    // time per iteration otherwise
+    const int threads_column = column("Backend Threads Mean");
+    const int rate_udm_column = column("Solves Per Second Mean");
+
+    // Write header
+    output_stream << line << "System Name,"
+                  << "Dataset,"
+                  << "Size";
+    if (cycles_column >= 0) {
+        output_stream << ",IPC,GFLOP/s";
+    }
+    if (threads_column >= 0) {
+        output_stream << ",Speedup,Parallel Efficiency";
+    }
+    output_stream << "\n";
+
+    // Columns of the rows of each phase of a pipeline taken from a measurement of the phase,
+    // e.g. us/Iteration from "Analyze Time (us) Mean". Iterations/sec is derived from the time
+    std::vector<std::pair<std::string, std::string>> phase_measurements = {
+        {"us/Iteration", "Time (us) Mean"},
+        {"Mean (us)", "Time (us) Mean"},
+        {"Peak Memory (b) Mean", "Peak Memory (b) Mean"},
+        {"Allocations Mean", "Allocations Mean"},
+        {"Allocated Bytes Mean", "Allocated Bytes Mean"},
+        {"Peak Live Bytes Mean", "Peak Live Bytes Mean"}};
+    for (size_t e = 0; e < NumPerfEvents; ++e) {
+        const std::string measurement = std::string(perf_event_name(PerfEvent(e))) + " Mean";
+        phase_measurements.emplace_back(measurement, measurement);
+    }
+    const int rate_column = column("Iterations/sec");
+    std::array<int, NumPhases> time_columns;
+    std::array<std::vector<std::pair<int, int>>, NumPhases> phase_columns;
+    for (size_t p = 0; p < NumPhases; ++p) {
+        const std::string name = phase_name(Phase(p));
+        time_columns[p] = column(name + " Time (us) Mean");
+        for (const auto& [target, measurement] : phase_measurements) {
+            const int source = column(name + " " + measurement);
+            if (column(target) >= 0 && source >= 0) {
+                phase_columns[p].emplace_back(column(target), source);
+            }
+        }
+    }
+
+    // Rows are written once all are read, for the baselines of the thread sweeps
+    struct Row
+    {
+        std::vector<std::string> cells;
+        std::string system_cells;
+        std::string scaling_key;
+    };
+    std::vector<Row> rows;
+
+    while (std::getline(celero_stream, line)) {
+        // get the experiment value, 3rd cell in each line
+        long long experiment_value = -1;
+        std::stringstream lineStream(line);
+        std::string cell;
+        int cellnum = 0;
+        while (std::getline(lineStream, cell, ',')) {
+            if (cellnum == 2) {
+                experiment_value = std::stoll(cell);
+                break;
+            }
+            cellnum++;
+        }
+
+        // Groups without any system (e.g. Refactorize without sequences) run once with a
+        // placeholder experiment value, which is not reported
+        if (experiment_value < 0 || index_map.empty()) {
+            continue;
+        }
+        // Thread sweeps and the variants of MultiSolve and ConcurrentSolve are encoded after the
+        // system index
+        auto it = index_map.find(static_cast<int>(experiment_value % index_map.size()));
+        if (it == index_map.end()) {
+            continue;
+        }
+
+        const std::tuple<std::string, std::string, int>& matrix_info = it->second;
+        const std::string system_cells = std::get<0>(matrix_info) + "," +
+                                         std::get<1>(matrix_info) + "," +
+                                         std::to_string(std::get<2>(matrix_info));
+        // Experiment value without the number of backend threads
+        const long long scaling_value = experiment_value % index_map.size() +
+                                        index_map.size() * experiment_variant(experiment_value);
+        auto add_row = [&](std::vector<std::string> row) {
+            const std::string key = row[0] + "," + row[1] + "," + std::to_string(scaling_value);
+            rows.push_back({std::move(row), system_cells, key});
+        };
+        const std::vector<std::string> cells = split(line);
+        add_row(cells);
+
+        // Pipeline rows are followed by a row per phase, in the group of the phase
+        if (cells.empty() || cells[0] != "Pipeline") {
+            continue;
+        }
+        for (size_t p = 0; p < NumPhases; ++p) {
+            if (time_columns[p] < 0 || time_columns[p] >= cells.size()) {
+                continue;
+            }
+            std::vector<std::string> phase_cells = cells;
+            phase_cells[0] = phase_name(Phase(p));
+            for (const auto& [target, source] : phase_columns[p]) {
+                if (target < cells.size() && source < cells.size()) {
+                    phase_cells[target] = cells[source];
+                }
+            }
+            if (rate_column >= 0 && rate_column < phase_cells.size()) {
+                const double us = std::stod(cells[time_columns[p]]);
+                phase_cells[rate_column] = us > 0 ? std::to_string(1e6 / us) : "-1";
+            }
+            add_row(std::move(phase_cells));
+        }
+    }
+
+    std::map<std::string, const Row*> baselines;
+    if (threads_column >= 0) {
+        for (const auto& row : rows) {
+            const double threads = cell_value(row.cells, threads_column);
+            if (threads <= 0) {
+                continue;
+            }
+            auto [it, inserted] = baselines.emplace(row.scaling_key, &row);
+            if (!inserted && threads < cell_value(it->second->cells, threads_column)) {
+                it->second = &row;
+            }
+        }
+    }
+    auto scaling_cells = [&](const Row& row) {
+        const auto it = baselines.find(row.scaling_key);
+        if (it == baselines.end()) {
+            return std::string(",-1,-1");
+        }
+        const Row& baseline = *it->second;
+        const double threads = cell_value(row.cells, threads_column);
+        const double baseline_threads = cell_value(baseline.cells, threads_column);
+        double speedup = -1;
+        const double rate = cell_value(row.cells, rate_udm_column);
+        const double baseline_rate = cell_value(baseline.cells, rate_udm_column);
+        const double us = cell_value(row.cells, time_column);
+        const double baseline_us = cell_value(baseline.cells, time_column);
+        if (rate > 0 && baseline_rate > 0) {
+            speedup = rate / baseline_rate;
+        } else if (us > 0 && baseline_us > 0) {
+            speedup = baseline_us / us;
+        }
+        double efficiency = -1;
+        if (speedup > 0 && threads > 0 && baseline_threads > 0) {
+            efficiency = speedup * baseline_threads / threads;
+        }
+        return "," + std::to_string(speedup) + "," + std::to_string(efficiency);
+    };
+
+    // Write to new csv file
+    for (const auto& row : rows) {
+        for (const auto& row_cell : row.cells) {
+            output_stream << row_cell << ",";
+        }
+        output_stream << row.system_cells;
+        if (cycles_column >= 0) {
+            output_stream << derived_cells(row.cells);
+        }
+        if (threads_column >= 0) {
+            output_stream << scaling_cells(row);
+        }
+        output_stream << "\n";
+    }
+
+    // Remove old csv
+    std::remove(celero_csv.string().c_str());
+}
+
+const char* phase_name(Phase phase)
+{
+    switch (phase) {
+    case Phase::Analyze: return "Analyze";
+    case Phase::Factorize: return "Factorize";
+    case Phase::Solve: return "Solve";
+    }
+    return "";
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SolverFixture and UDM
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename CreateSolver, typename SetupBenchmark>
+SolverFixture<CreateSolver, SetupBenchmark>::SolverFixture()
+{
+    m_solver = CreateSolver::create();
+    m_residual_udm.reset(new ResidualUDM());
+    m_failure_udm.reset(new FailureUDM());
+    m_memory_udm.reset(new MemoryUDM());
+    m_peak_memory_udm.reset(new PeakMemoryUDM());
+    m_allocation_count_udm.reset(new AllocationCountUDM());
+    m_allocated_bytes_udm.reset(new AllocatedBytesUDM());
+    m_peak_live_bytes_udm.reset(new PeakLiveBytesUDM());
+    for (size_t e = 0; e < NumPerfEvents; ++e) {
+        m_perf_event_udms.emplace_back(new PerfEventUDM(PerfEvent(e)));
+    }
+    m_throughput_udm.reset(new ThroughputUDM());
+    m_step_solve_rate_udm.reset(new StepSolveRateUDM());
+    m_amortized_analyze_udm.reset(new AmortizedAnalyzeUDM());
+    m_rhs_count_udm.reset(new RhsCountUDM());
+    m_solve_rate_udm.reset(new SolveRateUDM());
+    m_threads_udm.reset(new ThreadsUDM());
+    m_backend_threads_udm.reset(new BackendThreadsUDM());
+    for (const int percentile : {50, 90, 99}) {
+        m_latency_udms.emplace_back(new LatencyUDM(percentile));
+    }
+    m_refinement_steps_udm.reset(new RefinementStepsUDM());
+    for (size_t p = 0; p < NumPhases; ++p) {
+        m_phase_time_udms.emplace_back(new PhaseUDM(Phase(p), "Time (us)"));
+        m_phase_peak_memory_udms.emplace_back(new PhaseUDM(Phase(p), "Peak Memory (b)"));
+        m_phase_allocation_udms.emplace_back(new PhaseUDM(Phase(p), "Allocations"));
+        m_phase_allocation_udms.emplace_back(new PhaseUDM(Phase(p), "Allocated Bytes"));
+        m_phase_allocation_udms.emplace_back(new PhaseUDM(Phase(p), "Peak Live Bytes"));
+        for (size_t e = 0; e < NumPerfEvents; ++e) {
+            m_phase_perf_event_udms.emplace_back(
+                new PhaseUDM(Phase(p), perf_event_name(PerfEvent(e))));
+        }
+    }
+}
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::ResidualUDM
+    : public celero::UserDefinedMeasurementTemplate<Scalar>
+{
+    virtual std::string getName() const override { return "Residual"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::FailureUDM
+    : public celero::UserDefinedMeasurementTemplate<int>
+{
+    virtual std::string getName() const override { return "Numerical Failure"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::MemoryUDM
+    : public celero::UserDefinedMeasurementTemplate<size_t>
+{
+    virtual std::string getName() const override { return "Physical Memory (b)"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::PeakMemoryUDM
+    : public celero::UserDefinedMeasurementTemplate<double>
+{
+    virtual std::string getName() const override { return "Peak Memory (b)"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::AllocationCountUDM
+    : public celero::UserDefinedMeasurementTemplate<double>
+{
+    virtual std::string getName() const override { return "Allocations"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::AllocatedBytesUDM
+    : public celero::UserDefinedMeasurementTemplate<double>
+{
+    virtual std::string getName() const override { return "Allocated Bytes"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::PeakLiveBytesUDM
+    : public celero::UserDefinedMeasurementTemplate<double>
+{
+    virtual std::string getName() const override { return "Peak Live Bytes"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::ThroughputUDM
+    : public celero::UserDefinedMeasurementTemplate<double>
+{
+    virtual std::string getName() const override { return "Factorizations Per Second"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::StepSolveRateUDM
+    : public celero::UserDefinedMeasurementTemplate<double>
+{
+    virtual std::string getName() const override { return "Step Solves Per Second"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::AmortizedAnalyzeUDM
+    : public celero::UserDefinedMeasurementTemplate<double>
+{
+    virtual std::string getName() const override { return "Amortized Analyze (us)"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::RhsCountUDM
+    : public celero::UserDefinedMeasurementTemplate<int>
+{
+    virtual std::string getName() const override { return "RHS Count"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::SolveRateUDM
+    : public celero::UserDefinedMeasurementTemplate<double>
+{
+    virtual std::string getName() const override { return "Solves Per Second"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::ThreadsUDM
+    : public celero::UserDefinedMeasurementTemplate<int>
+{
+    virtual std::string getName() const override { return "Threads"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::BackendThreadsUDM
+    : public celero::UserDefinedMeasurementTemplate<int>
+{
+    virtual std::string getName() const override { return "Backend Threads"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::LatencyUDM
+    : public celero::UserDefinedMeasurementTemplate<double>
+{
+public:
+    explicit LatencyUDM(int percentile)
+        : m_percentile(percentile)
+    {}
+
+    int percentile() const { return m_percentile; }
+
+private:
+    virtual std::string getName() const override
+    {
+        return "Latency P" + std::to_string(m_percentile) + " (us)";
+    }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+
+    int m_percentile;
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::RefinementStepsUDM
+    : public celero::UserDefinedMeasurementTemplate<int>
+{
+    virtual std::string getName() const override { return "Refinement Steps"; }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::PerfEventUDM
+    : public celero::UserDefinedMeasurementTemplate<double>
+{
+public:
+    explicit PerfEventUDM(PerfEvent event)
+        : m_event(event)
+    {}
+
+private:
+    virtual std::string getName() const override { return perf_event_name(m_event); }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+
+    PerfEvent m_event;
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+class SolverFixture<CreateSolver, SetupBenchmark>::PhaseUDM
+    : public celero::UserDefinedMeasurementTemplate<double>
+{
+public:
+    PhaseUDM(Phase phase, std::string quantity)
+        : m_phase(phase)
+        , m_quantity(std::move(quantity))
+    {}
+
+private:
+    virtual std::string getName() const override
+    {
+        return std::string(phase_name(m_phase)) + " " + m_quantity;
+    }
+    virtual bool reportSize() const override { return false; };
+    virtual bool reportVariance() const override { return false; };
+    virtual bool reportStandardDeviation() const override { return false; };
+    virtual bool reportSkewness() const override { return false; };
+    virtual bool reportKurtosis() const override { return false; };
+    virtual bool reportZScore() const override { return false; };
+    virtual bool reportMin() const override { return false; };
+    virtual bool reportMax() const override { return false; };
+
+    Phase m_phase;
+    std::string m_quantity;
+};
+
+template <typename CreateSolver, typename SetupBenchmark>
+std::vector<celero::TestFixture::ExperimentValue>
+SolverFixture<CreateSolver, SetupBenchmark>::getExperimentValues() const
+{
+    // The Pipeline benchmarks time the phases of the separate groups in a single pass
+    if (BenchmarkData::instance().m_pipeline) {
+        return {};
+    }
+    return system_experiment_values();
+}
+
+template <typename CreateSolver, typename SetupBenchmark>
+void SolverFixture<CreateSolver, SetupBenchmark>::setUp(
+    const celero::TestFixture::ExperimentValue& experimentValue)
+{
+    m_failure_count = 0;
+    m_next_path.clear();
+    auto& data = BenchmarkData::instance();
+    // Celero runs groups without any experiment value once, with a negative placeholder
+    if (experimentValue.Value < 0 || data.m_experiment_paths.empty()) {
+        m_setup_status = SetupStatus::FAILURE;
+        return;
+    }
+    apply_backend_threads(experimentValue.Value);
+    const size_t system = experimentValue.Value % data.m_experiment_paths.size();
+    m_matrix_path = data.m_experiment_paths[system];
+    if (!data.m_cache) {
+        data.m_cache = std::make_unique<benchy::io::SystemCache<Scalar>>(
+            data.m_cache_bytes,
+            data.m_cache_entries);
+    }
+    m_system = data.m_cache->get(m_matrix_path);
+    const size_t next = (system + 1) % data.m_experiment_paths.size();
+    m_next_path = data.m_experiment_paths[next];
+    // SPD systems storing a single triangle are converted to what the solver reads, if needed
+    const auto stored = benchy::io::stored_triangle(m_system->metadata);
+    m_stored_triangle =
+        (stored == benchy::io::StoredTriangle::Full ? stored : CreateSolver::accepted_triangle);
+    if (m_stored_triangle == stored) {
+        m_converted_A.resize(0, 0);
+    } else {
+        m_converted_A = benchy::io::convert_storage(m_system->A, stored, m_stored_triangle);
+    }
+    m_b = m_system->b.col(0); // ensures only one column selected
+    m_x = Eigen::VectorX<Scalar>::Zero(m_b.size());
+    m_setup_status = SetupBenchmark::prepare(m_solver, A());
+}
+
+template <typename CreateSolver, typename SetupBenchmark>
+void SolverFixture<CreateSolver, SetupBenchmark>::onExperimentStart(
+    const celero::TestFixture::ExperimentValue&)
+{
+    wait_for_prefetch();
+    m_memory_monitor.start();
+    if (PerfCounters::available()) {
+        m_perf_counters.start();
+    }
+    if (allocation_tracking_enabled()) {
+        start_allocation_tracking();
+    }
+}
+
+template <typename CreateSolver, typename SetupBenchmark>
+void SolverFixture<CreateSolver, SetupBenchmark>::onExperimentEnd()
+{
+    if (m_memory_monitor.running()) {
+        if (allocation_tracking_enabled()) {
+            m_allocations = stop_allocation_tracking();
+        }
+        if (m_perf_counters.running()) {
+            m_perf_counts = m_perf_counters.stop();
+        }
+        m_peak_memory = static_cast<double>(m_memory_monitor.stop());
+    }
+    // only calculate residual on solve phase
+    if constexpr (std::is_same_v<SetupBenchmark, SolveOnly>) {
+        if (m_system) {
+            Scalar r = (benchy::io::multiply(A(), m_stored_triangle, m_x) - m_b).norm();
+            m_residuals.push_back(r);
+        }
+    }
+}
+
+template <typename CreateSolver, typename SetupBenchmark>
+void SolverFixture<CreateSolver, SetupBenchmark>::tearDown()
+{
+    // Residuals averaged over iterations
+    if (!m_residuals.empty()) {
+        auto const count = static_cast<Scalar>(m_residuals.size());
+        auto const avg = std::reduce(m_residuals.begin(), m_residuals.end()) / count;
+        m_residual_udm->addValue(avg);
+        if (avg > 1e-2) { // somewhat arbitrary definition of failure here
+            this->addFailure();
+        }
+    } else {
+        m_residual_udm->addValue(-1);
+    }
+    m_failure_udm->addValue(m_failure_count);
+    m_memory_udm->addValue(getCurrentRSS());
+    m_peak_memory_udm->addValue(m_peak_memory);
+    if (allocation_tracking_enabled()) {
+        auto add_allocations = [](const std::optional<AllocationStats>& stats,
+                                  const auto& count_udm,
+                                  const auto& bytes_udm,
+                                  const auto& peak_udm) {
+            count_udm->addValue(stats ? static_cast<double>(stats->count) : -1);
+            bytes_udm->addValue(stats ? static_cast<double>(stats->bytes) : -1);
+            peak_udm->addValue(stats ? static_cast<double>(stats->peak_live_bytes) : -1);
+        };
+        add_allocations(
+            m_allocations,
+            m_allocation_count_udm,
+            m_allocated_bytes_udm,
+            m_peak_live_bytes_udm);
+        for (size_t p = 0; p < NumPhases; ++p) {
+            add_allocations(
+                m_phase_allocations[p],
+                m_phase_allocation_udms[3 * p],
+                m_phase_allocation_udms[3 * p + 1],
+                m_phase_allocation_udms[3 * p + 2]);
+        }
+    }
+    if (PerfCounters::available()) {
+        for (size_t e = 0; e < NumPerfEvents; ++e) {
+            m_perf_event_udms[e]->addValue(m_perf_counts ? m_perf_counts->values[e] : -1);
+            for (size_t p = 0; p < NumPhases; ++p) {
+                const auto& counts = m_phase_perf_counts[p];
+                m_phase_perf_event_udms[p * NumPerfEvents + e]->addValue(
+                    counts ? counts->values[e] : -1);
+            }
+        }
+    }
+    m_throughput_udm->addValue(m_factorizations_per_second);
+    m_step_solve_rate_udm->addValue(m_step_solves_per_second);
+    m_amortized_analyze_udm->addValue(m_amortized_analyze_us);
+    m_rhs_count_udm->addValue(m_rhs_count);
+    m_solve_rate_udm->addValue(m_solves_per_second);
+    m_threads_udm->addValue(m_num_threads);
+    m_backend_threads_udm->addValue(m_backend_threads);
+    for (const auto& udm : m_latency_udms) {
+        const double latency = m_latencies.percentile(udm->percentile() / 100.0);
+        udm->addValue(m_latencies.count() > 0 ? latency * 1e6 : -1);
+    }
+    m_refinement_steps_udm->addValue(m_refinement_steps);
+    for (size_t p = 0; p < NumPhases; ++p) {
+        m_phase_time_udms[p]->addValue(m_phase_us[p]);
+        m_phase_peak_memory_udms[p]->addValue(m_phase_peak_memory[p]);
+    }
+    m_residuals.clear();
+    m_factorizations_per_second = -1;
+    m_step_solves_per_second = -1;
+    m_amortized_analyze_us = -1;
+    m_rhs_count = -1;
+    m_solves_per_second = -1;
+    m_num_threads = -1;
+    m_backend_threads = -1;
+    m_latencies.clear();
+    m_refinement_steps = -1;
+    m_phase_us.fill(-1);
+    m_peak_memory = -1;
+    m_phase_peak_memory.fill(-1);
+    m_allocations.reset();
+    m_phase_allocations.fill(std::nullopt);
+    m_perf_counts.reset();
+    m_phase_perf_counts.fill(std::nullopt);
+    // Leaves the lifetime of the system to the cache
+    m_system.reset();
+    m_converted_A.resize(0, 0);
+    // The next system is decoded while no measurement runs, up to the start of the next
+    // experiment
+    if (!m_next_path.empty() && BenchmarkData::instance().m_cache) {
+        BenchmarkData::instance().m_cache->prefetch(m_next_path);
+    }
+}
+
+template <typename CreateSolver, typename SetupBenchmark>
+std::vector<std::shared_ptr<celero::UserDefinedMeasurement>>
+SolverFixture<CreateSolver, SetupBenchmark>::getUserDefinedMeasurements() const
+{
+    std::vector<std::shared_ptr<celero::UserDefinedMeasurement>> udms = {
+        this->m_residual_udm,
+        this->m_failure_udm,
+        this->m_memory_udm,
+        this->m_peak_memory_udm,
+        this->m_throughput_udm,
+        this->m_step_solve_rate_udm,
+        this->m_amortized_analyze_udm,
+        this->m_rhs_count_udm,
+        this->m_solve_rate_udm,
+        this->m_threads_udm};
+    // Backend threads are only reported if they are swept
+    if (!BenchmarkData::instance().m_backend_threads.empty()) {
+        udms.push_back(m_backend_threads_udm);
+    }
+    udms.insert(udms.end(), m_latency_udms.begin(), m_latency_udms.end());
+    udms.push_back(m_refinement_steps_udm);
+    udms.insert(udms.end(), m_phase_time_udms.begin(), m_phase_time_udms.end());
+    udms.insert(udms.end(), m_phase_peak_memory_udms.begin(), m_phase_peak_memory_udms.end());
+    // Allocations are only reported by builds tracking them
+    if (allocation_tracking_enabled()) {
+        udms.insert(
+            udms.end(),
+            {this->m_allocation_count_udm, this->m_allocated_bytes_udm, m_peak_live_bytes_udm});
+        udms.insert(udms.end(), m_phase_allocation_udms.begin(), m_phase_allocation_udms.end());
+    }
+    // Hardware events are only reported where they can be counted
+    if (PerfCounters::available()) {
+        udms.insert(udms.end(), m_perf_event_udms.begin(), m_perf_event_udms.end());
+        udms.insert(udms.end(), m_phase_perf_event_udms.begin(), m_phase_perf_event_udms.end());
+    }
+    return udms;
+}
+
+template <typename CreateSolver, typename SetupBenchmark>
+void SolverFixture<CreateSolver, SetupBenchmark>::addFailure()
+{
+    m_failure_count += 1;
+}
+
+template <typename CreateSolver, typename SetupBenchmark>
+void SolverFixture<CreateSolver, SetupBenchmark>::apply_backend_threads(int64_t experiment_value)
+{
+    const auto& thread_counts = BenchmarkData::instance().m_backend_threads;
+    if (thread_counts.empty()) {
+        m_backend_threads = -1;
+        return;
+    }
+    m_backend_threads = thread_counts.at(experiment_thread_run(experiment_value));
+    set_backend_threads(m_backend_threads);
+    m_solver = CreateSolver::create();
+}
+
+template <typename CreateSolver>
+std::vector<celero::TestFixture::ExperimentValue>
+PipelineFixture<CreateSolver>::getExperimentValues() const
+{
+    if (!BenchmarkData::instance().m_pipeline) {
+        return {};
+    }
+    return system_experiment_values();
+}
+
+template <typename CreateSolver>
+void PipelineFixture<CreateSolver>::setUp(
+    const celero::TestFixture::ExperimentValue& experimentValue)
+{
+    m_phase_time.fill(0);
+    m_num_passes = 0;
+    SolverFixture<CreateSolver, AnalyzeOnly>::setUp(experimentValue);
+}
+
+template <typename CreateSolver>
+void PipelineFixture<CreateSolver>::onExperimentStart(const celero::TestFixture::ExperimentValue&)
+{
+    wait_for_prefetch();
+}
+
+template <typename CreateSolver>
+void PipelineFixture<CreateSolver>::run_pipeline()
+{
+    if (this->m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
+    Phase phase = Phase::Analyze;
+    std::array<double, NumPhases> times = {};
+    // Runs a phase, timing it once the memory monitor, the hardware counters and the allocation
+    // tracking are started
+    auto run = [&](Phase p, auto&& f) {
+        phase = p;
+        const bool track_allocations = allocation_tracking_enabled();
+        const bool count_events = PerfCounters::available();
+        this->m_memory_monitor.start();
+        if (count_events) {
+            this->m_perf_counters.start();
+        }
+        if (track_allocations) {
+            start_allocation_tracking();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        times[size_t(p)] =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (track_allocations) {
+            auto& total = this->m_phase_allocations[size_t(p)];
+            if (!total) {
+                total.emplace();
+            }
+            total->merge(stop_allocation_tracking());
+        }
+        if (count_events) {
+            auto& total = this->m_phase_perf_counts[size_t(p)];
+            if (!total) {
+                total.emplace();
+            }
+            total->merge(this->m_perf_counters.stop());
+        }
+        auto& peak = this->m_phase_peak_memory[size_t(p)];
+        peak = std::max(peak, static_cast<double>(this->m_memory_monitor.stop()));
+    };
+    try {
+        run(Phase::Analyze, [&]() {
+            this->m_solver->analyzePattern(this->A(), this->A().rows());
+        });
+        run(Phase::Factorize, [&]() { this->m_solver->factorize(this->A()); });
+        run(Phase::Solve, [&]() { this->m_solver->solve(this->m_b, this->m_x); });
+        for (size_t p = 0; p < NumPhases; ++p) {
+            m_phase_time[p] += times[p];
+        }
+        ++m_num_passes;
+    } catch (const std::runtime_error& e) {
+        spdlog::warn(
+            "{} failed on {} with message {}",
+            phase_name(phase),
+            this->m_matrix_path.string(),
+            e.what());
+        this->addFailure();
+    } catch (...) {
+        spdlog::warn("{} failed on {}", phase_name(phase), this->m_matrix_path.string());
+        this->addFailure();
+    }
+}
+
+template <typename CreateSolver>
+void PipelineFixture<CreateSolver>::onExperimentEnd()
+{
+    SolverFixture<CreateSolver, AnalyzeOnly>::onExperimentEnd();
+    if (this->m_setup_status == SetupStatus::SUCCESS) {
+        const Eigen::VectorX<Scalar> Ax =
+            benchy::io::multiply(this->A(), this->m_stored_triangle, this->m_x);
+        this->m_residuals.push_back((Ax - this->m_b).norm());
+    }
+}
+
+template <typename CreateSolver>
+void PipelineFixture<CreateSolver>::tearDown()
+{
+    // Phases are only reported for complete passes, failures being reported separately
+    if (m_num_passes > 0) {
+        for (size_t p = 0; p < NumPhases; ++p) {
+            this->m_phase_us[p] = m_phase_time[p] * 1e6 / m_num_passes;
+        }
+    }
+    this->m_peak_memory =
+        *std::max_element(this->m_phase_peak_memory.begin(), this->m_phase_peak_memory.end());
+    this->m_allocations.reset();
+    for (const auto& stats : this->m_phase_allocations) {
+        if (stats) {
+            if (!this->m_allocations) {
+                this->m_allocations.emplace();
+            }
+            this->m_allocations->merge(*stats);
+        }
+    }
+    this->m_perf_counts.reset();
+    for (const auto& counts : this->m_phase_perf_counts) {
+        if (counts) {
+            if (!this->m_perf_counts) {
+                this->m_perf_counts.emplace();
+            }
+            this->m_perf_counts->merge(*counts);
+        }
+    }
+    SolverFixture<CreateSolver, AnalyzeOnly>::tearDown();
+}
+
+template <typename CreateSolver>
+std::vector<celero::TestFixture::ExperimentValue>
+SequenceFixture<CreateSolver>::getExperimentValues() const
+{
+    std::vector<celero::TestFixture::ExperimentValue> problemSpace;
+    const auto& paths = BenchmarkData::instance().m_experiment_paths;
+    for (int64_t t = 0; t < num_thread_runs(); t++) {
+        for (int i = 0; i < paths.size(); i++) {
+            if (paths[i].extension() == ".bseq") {
+                problemSpace.push_back(experiment_value(i, t, 0));
+            }
+        }
+    }
+    return problemSpace;
+}
+
+template <typename CreateSolver>
+void SequenceFixture<CreateSolver>::setUp(
+    const celero::TestFixture::ExperimentValue& experimentValue)
+{
+    this->m_failure_count = 0;
+    this->m_setup_status = SetupStatus::FAILURE;
+    m_sequence.reset();
+    m_analyze_time = 0;
+    m_factorize_time = 0;
+    m_num_factorizations = 0;
+    m_solve_time = 0;
+    m_num_solves = 0;
+
+    // Celero runs groups without any experiment value once, with a negative placeholder
+    const auto& paths = BenchmarkData::instance().m_experiment_paths;
+    if (experimentValue.Value < 0 || paths.empty()) {
+        return;
+    }
+    this->apply_backend_threads(experimentValue.Value);
+    this->m_matrix_path = paths[experimentValue.Value % paths.size()];
+    try {
+        fs::path pack_path;
+        std::string member;
+        if (benchy::io::split_pack_path(this->m_matrix_path, pack_path, member)) {
+            const auto pack = benchy::io::open_pack(pack_path);
+            m_sequence = std::make_unique<benchy::io::MappedSequence>(
+                pack->sequence(pack->index_of(member)));
+        } else {
+            m_sequence = std::make_unique<benchy::io::MappedSequence>(this->m_matrix_path);
+        }
+    } catch (const std::exception& e) {
+        spdlog::warn(
+            "Could not map sequence {} with message {}",
+            this->m_matrix_path.string(),
+            e.what());
+        return;
+    }
+
+    // Pattern read by the solver, holding the index of each entry in the stored values
+    const auto& header = m_sequence->header();
+    std::vector<int> indices(header.nnz);
+    std::iota(indices.begin(), indices.end(), 0);
+    const Eigen::SparseMatrix<int, Eigen::ColMajor> pattern =
+        Eigen::Map<const Eigen::SparseMatrix<int, Eigen::ColMajor>>(
+            header.rows,
+            header.cols,
+            header.nnz,
+            m_sequence->outer_index(),
+            m_sequence->inner_index(),
+            indices.data());
+    const auto stored = benchy::io::stored_triangle(m_sequence->metadata());
+    this->m_stored_triangle =
+        (stored == benchy::io::StoredTriangle::Full ? stored : CreateSolver::accepted_triangle);
+    const Eigen::SparseMatrix<int, Eigen::ColMajor> step_pattern =
+        benchy::io::convert_storage(pattern, stored, this->m_stored_triangle);
+    m_step_A = step_pattern.cast<Scalar>();
+    m_value_map.clear();
+    if (this->m_stored_triangle != stored) {
+        m_value_map.assign(
+            step_pattern.valuePtr(),
+            step_pattern.valuePtr() + step_pattern.nonZeros());
+    }
+    load_step(0);
+    this->m_x = Eigen::VectorX<Scalar>::Zero(this->m_b.size());
+
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        this->m_solver->analyzePattern(m_step_A, m_step_A.rows());
+        m_analyze_time =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        this->m_setup_status = SetupStatus::SUCCESS;
+    } catch (const std::runtime_error& e) {
+        spdlog::warn(
+            "Analyze failed on sequence {} with message {}",
+            this->m_matrix_path.string(),
+            e.what());
+    }
+}
+
+template <typename CreateSolver>
+void SequenceFixture<CreateSolver>::load_step(size_t step)
 {
-    std::string filename = get_current_time() + "_results.csv";
-    fs::path output_file = output_dir / filename;
-
-    int argc = 3;
-    // Command-line arguments
-    std::vector<std::string> argv_s;
-    std::vector<char*> argv_v;
-    argv_s.push_back(exe_name);
-    argv_s.push_back("-t"); // Command-line arg to write to CSV
-    argv_s.push_back(output_file.string());
-    for (auto& x : argv_s) {
-        x.push_back('\0');
-        argv_v.push_back(x.data());
+    auto copy = [&](auto zero) {
+        using FileScalar = decltype(zero);
+        const auto values = m_sequence->template values<FileScalar>(step);
+        Scalar* step_values = m_step_A.valuePtr();
+        if (m_value_map.empty()) {
+            Eigen::Map<Eigen::VectorX<Scalar>>(step_values, m_step_A.nonZeros()) =
+                values.template cast<Scalar>();
+        } else {
+            for (size_t k = 0; k < m_value_map.size(); ++k) {
+                step_values[k] = static_cast<Scalar>(values[m_value_map[k]]);
+            }
+        }
+        this->m_b = m_sequence->template b<FileScalar>(step).col(0).template cast<Scalar>();
+    };
+    if (m_sequence->is_float()) {
+        copy(0.f);
+    } else {
+        copy(0.0);
     }
-    spdlog::info("Running benchmarks");
-    celero::Run(argc, &argv_v[0]);
-    make_final_csv(output_file, output_dir);
 }
 
-std::string get_current_time()
+template <typename CreateSolver>
+void SequenceFixture<CreateSolver>::refactorize()
 {
-    std::time_t t = std::time(nullptr);
-    std::string datetime(100, 0);
-    datetime.resize(
-        std::strftime(&datetime[0], datetime.size(), "%Y_%m_%d_%H_%M", std::localtime(&t)));
-    return datetime;
+    if (this->m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
+    for (size_t step = 0; step < m_sequence->num_steps(); ++step) {
+        load_step(step);
+        try {
+            const auto start = std::chrono::steady_clock::now();
+            this->m_solver->factorize(m_step_A);
+            m_factorize_time +=
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            ++m_num_factorizations;
+            const auto solve_start = std::chrono::steady_clock::now();
+            this->m_solver->solve(this->m_b, this->m_x);
+            m_solve_time +=
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - solve_start)
+                    .count();
+            ++m_num_solves;
+        } catch (const std::runtime_error& e) {
+            spdlog::warn(
+                "Refactorize failed on step {} of {} with message {}",
+                step,
+                this->m_matrix_path.string(),
+                e.what());
+            this->addFailure();
+        } catch (...) {
+            spdlog::warn(
+                "Refactorize failed on step {} of {}",
+                step,
+                this->m_matrix_path.string());
+            this->addFailure();
+        }
+    }
 }
 
-std::map<int, std::tuple<std::string, std::string, int>> generate_index_map()
+template <typename CreateSolver>
+void SequenceFixture<CreateSolver>::onExperimentEnd()
 {
-    std::map<int, std::tuple<std::string, std::string, int>> index_map;
-    spdlog::info("Generating index map");
-    std::vector<fs::path> matrix_paths = BenchmarkData::instance().m_experiment_paths;
-    for (int i = 0; i < matrix_paths.size(); ++i) {
-        auto data = benchy::io::load_compressed(matrix_paths[i]);
-        Eigen::SparseMatrix<Scalar, Eigen::ColMajor> A = data.at("A");
-        nlohmann::json metadata = data.at("metadata");
-        auto parent_path = matrix_paths[i].parent_path().filename();
-        auto filename = matrix_paths[i].filename();
-        auto print_path = parent_path / filename;
-        index_map[i] = {print_path.string(), metadata["dataset_name"], A.nonZeros()};
+    SolverFixture<CreateSolver, AnalyzeOnly>::onExperimentEnd();
+    if (this->m_setup_status == SetupStatus::SUCCESS) {
+        const Eigen::VectorX<Scalar> Ax =
+            benchy::io::multiply(m_step_A, this->m_stored_triangle, this->m_x);
+        this->m_residuals.push_back((Ax - this->m_b).norm());
     }
-    return index_map;
 }
 
-void make_final_csv(fs::path celero_csv, fs::path output_dir)
+template <typename CreateSolver>
+void SequenceFixture<CreateSolver>::tearDown()
 {
-    spdlog::info("Generating final output CSV");
-    std::map<int, std::tuple<std::string, std::string, int>> index_map = generate_index_map();
-    std::ifstream celero_stream(celero_csv);
-
-    std::string filename = get_current_time() + "_benchmark_data.csv";
-    fs::path output_file = output_dir / filename;
-    std::ofstream output_stream(output_file);
+    if (m_factorize_time > 0) {
+        this->m_factorizations_per_second = m_num_factorizations / m_factorize_time;
+    }
+    if (m_solve_time > 0) {
+        this->m_step_solves_per_second = m_num_solves / m_solve_time;
+    }
+    if (m_sequence) {
+        this->m_amortized_analyze_us = m_analyze_time * 1e6 / m_sequence->num_steps();
+    }
+    m_sequence.reset();
+    SolverFixture<CreateSolver, AnalyzeOnly>::tearDown();
+}
 
-    // Write header
-    std::string line;
-    std::getline(celero_stream, line);
-    output_stream << line << "System Name,"
-                  << "Dataset,"
-                  << "Size"
-                  << "\n";
-    while (std::getline(celero_stream, line)) {
-        // get the experiment value, 3rd cell in each line
-        int experiment_value;
-        std::stringstream lineStream(line);
-        std::string cell;
-        int cellnum = 0;
-        while (std::getline(lineStream, cell, ',')) {
-            if (cellnum == 2) {
-                experiment_value = std::stoi(cell);
-                break;
+template <typename CreateSolver, RhsMode Mode>
+std::vector<celero::TestFixture::ExperimentValue>
+MultiSolveFixture<CreateSolver, Mode>::getExperimentValues() const
+{
+    std::vector<celero::TestFixture::ExperimentValue> problemSpace;
+    const auto& data = BenchmarkData::instance();
+    if (!data.m_multi_rhs) {
+        return problemSpace;
+    }
+    const int num_systems = static_cast<int>(data.m_experiment_paths.size());
+    for (int k = 0; k < data.m_rhs_counts.size(); k++) {
+        for (int64_t t = 0; t < num_thread_runs(); t++) {
+            for (int i = 0; i < num_systems; i++) {
+                problemSpace.push_back(experiment_value(i, t, k));
             }
-            cellnum++;
         }
-
-        // Write to new csv file
-        std::tuple<std::string, std::string, int> matrix_info = index_map[experiment_value];
-        output_stream << line << std::get<0>(matrix_info) << "," << std::get<1>(matrix_info) << ","
-                      << std::get<2>(matrix_info) << "\n";
     }
-
-    // Remove old csv
-    std::remove(celero_csv.string().c_str());
+    return problemSpace;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// SolverFixture and UDM
-///////////////////////////////////////////////////////////////////////////////////////////////////
-
-template <typename CreateSolver, typename SetupBenchmark>
-SolverFixture<CreateSolver, SetupBenchmark>::SolverFixture()
+template <typename CreateSolver, RhsMode Mode>
+void MultiSolveFixture<CreateSolver, Mode>::setUp(
+    const celero::TestFixture::ExperimentValue& experimentValue)
 {
-    m_solver = CreateSolver::create();
-    m_residual_udm.reset(new ResidualUDM());
-    m_failure_udm.reset(new FailureUDM());
-    m_memory_udm.reset(new MemoryUDM());
+    m_solve_time = 0;
+    m_num_solves = 0;
+    const auto& data = BenchmarkData::instance();
+    const int64_t num_systems = data.m_experiment_paths.size();
+
+    // Celero runs groups without any experiment value once, with a negative placeholder
+    if (experimentValue.Value < 0 || num_systems == 0) {
+        this->m_failure_count = 0;
+        this->m_setup_status = SetupStatus::FAILURE;
+        return;
+    }
+    SolverFixture<CreateSolver, AnalyzeOnly>::setUp(experimentValue);
+
+    // Repeats the columns of b up to the requested number of rhs
+    const auto& b = this->m_system->b;
+    const int num_rhs = data.m_rhs_counts.at(experiment_variant(experimentValue.Value));
+    m_B.resize(b.rows(), num_rhs);
+    for (int j = 0; j < num_rhs; ++j) {
+        m_B.col(j) = b.col(j % b.cols());
+    }
+    m_X = Eigen::MatrixX<Scalar>::Zero(m_B.rows(), m_B.cols());
+
+    try {
+        if constexpr (Mode == RhsMode::Block) {
+            m_block_solver = CreateSolver::create_block();
+            m_block_solver->analyzePattern(this->A());
+            m_block_solver->factorize(this->A());
+        } else {
+            this->m_solver->analyzePattern(this->A(), this->A().rows());
+            this->m_solver->factorize(this->A());
+        }
+    } catch (const std::runtime_error& e) {
+        spdlog::warn(
+            "Factorization failed on {} with message {}",
+            this->m_matrix_path.string(),
+            e.what());
+        this->m_setup_status = SetupStatus::FAILURE;
+    }
 }
 
-template <typename CreateSolver, typename SetupBenchmark>
-class SolverFixture<CreateSolver, SetupBenchmark>::ResidualUDM
-    : public celero::UserDefinedMeasurementTemplate<Scalar>
+template <typename CreateSolver, RhsMode Mode>
+void MultiSolveFixture<CreateSolver, Mode>::solve()
 {
-    virtual std::string getName() const override { return "Residual"; }
-    virtual bool reportSize() const override { return false; };
-    virtual bool reportVariance() const override { return false; };
-    virtual bool reportStandardDeviation() const override { return false; };
-    virtual bool reportSkewness() const override { return false; };
-    virtual bool reportKurtosis() const override { return false; };
-    virtual bool reportZScore() const override { return false; };
-    virtual bool reportMin() const override { return false; };
-    virtual bool reportMax() const override { return false; };
-};
+    if (this->m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        if constexpr (Mode == RhsMode::Block) {
+            m_block_solver->solve(m_B, m_X);
+        } else {
+            for (Eigen::Index j = 0; j < m_B.cols(); ++j) {
+                this->m_solver->solve(m_B.col(j), m_X.col(j));
+            }
+        }
+        m_solve_time +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        m_num_solves += m_B.cols();
+    } catch (const std::runtime_error& e) {
+        spdlog::warn(
+            "Solve of {} rhs failed on {} with message {}",
+            m_B.cols(),
+            this->m_matrix_path.string(),
+            e.what());
+        this->addFailure();
+    } catch (...) {
+        spdlog::warn("Solve of {} rhs failed on {}", m_B.cols(), this->m_matrix_path.string());
+        this->addFailure();
+    }
+}
 
-template <typename CreateSolver, typename SetupBenchmark>
-class SolverFixture<CreateSolver, SetupBenchmark>::FailureUDM
-    : public celero::UserDefinedMeasurementTemplate<int>
+template <typename CreateSolver, RhsMode Mode>
+void MultiSolveFixture<CreateSolver, Mode>::onExperimentEnd()
 {
-    virtual std::string getName() const override { return "Numerical Failure"; }
-    virtual bool reportSize() const override { return false; };
-    virtual bool reportVariance() const override { return false; };
-    virtual bool reportStandardDeviation() const override { return false; };
-    virtual bool reportSkewness() const override { return false; };
-    virtual bool reportKurtosis() const override { return false; };
-    virtual bool reportZScore() const override { return false; };
-    virtual bool reportMin() const override { return false; };
-    virtual bool reportMax() const override { return false; };
-};
+    SolverFixture<CreateSolver, AnalyzeOnly>::onExperimentEnd();
+    if (this->m_setup_status == SetupStatus::SUCCESS) {
+        Scalar r = 0;
+        for (Eigen::Index j = 0; j < m_B.cols(); ++j) {
+            const Eigen::VectorX<Scalar> x = m_X.col(j);
+            const Eigen::VectorX<Scalar> Ax =
+                benchy::io::multiply(this->A(), this->m_stored_triangle, x);
+            r = std::max(r, (Ax - m_B.col(j)).norm());
+        }
+        this->m_residuals.push_back(r);
+    }
+}
 
-template <typename CreateSolver, typename SetupBenchmark>
-class SolverFixture<CreateSolver, SetupBenchmark>::MemoryUDM
-    : public celero::UserDefinedMeasurementTemplate<size_t>
+template <typename CreateSolver, RhsMode Mode>
+void MultiSolveFixture<CreateSolver, Mode>::tearDown()
 {
-    virtual std::string getName() const override { return "Physical Memory (b)"; }
-    virtual bool reportSize() const override { return false; };
-    virtual bool reportVariance() const override { return false; };
-    virtual bool reportStandardDeviation() const override { return false; };
-    virtual bool reportSkewness() const override { return false; };
-    virtual bool reportKurtosis() const override { return false; };
-    virtual bool reportZScore() const override { return false; };
-    virtual bool reportMin() const override { return false; };
-    virtual bool reportMax() const override { return false; };
-};
+    this->m_rhs_count = static_cast<int>(m_B.cols());
+    if (m_solve_time > 0) {
+        this->m_solves_per_second = m_num_solves / m_solve_time;
+    }
+    m_block_solver.reset();
+    m_B.resize(0, 0);
+    m_X.resize(0, 0);
+    SolverFixture<CreateSolver, AnalyzeOnly>::tearDown();
+}
 
-template <typename CreateSolver, typename SetupBenchmark>
+template <typename CreateSolver>
 std::vector<celero::TestFixture::ExperimentValue>
-SolverFixture<CreateSolver, SetupBenchmark>::getExperimentValues() const
+ConcurrentSolveFixture<CreateSolver>::getExperimentValues() const
 {
     std::vector<celero::TestFixture::ExperimentValue> problemSpace;
-    for (int i = 0; i < BenchmarkData::instance().m_experiment_paths.size(); i++) {
-        problemSpace.push_back(i);
+    const auto& data = BenchmarkData::instance();
+    if (!data.m_concurrent) {
+        return problemSpace;
+    }
+    const int num_systems = static_cast<int>(data.m_experiment_paths.size());
+    for (int k = 0; k < data.m_solve_threads.size(); k++) {
+        for (int64_t t = 0; t < num_thread_runs(); t++) {
+            for (int i = 0; i < num_systems; i++) {
+                problemSpace.push_back(experiment_value(i, t, k));
+            }
+        }
     }
     return problemSpace;
 }
 
-template <typename CreateSolver, typename SetupBenchmark>
-void SolverFixture<CreateSolver, SetupBenchmark>::setUp(
+template <typename CreateSolver>
+void ConcurrentSolveFixture<CreateSolver>::setUp(
     const celero::TestFixture::ExperimentValue& experimentValue)
 {
-    m_failure_count = 0;
-    m_matrix_path = BenchmarkData::instance().m_experiment_paths.at(experimentValue.Value);
-    auto data = benchy::io::load_compressed(m_matrix_path);
-    m_A = data.at("A");
-    Eigen::MatrixX<Scalar> b_mat = data.at("b");
-    m_b = b_mat.col(0); // ensures only one column selected
-    m_x = Eigen::VectorX<Scalar>::Zero(m_b.size());
-    m_setup_status = SetupBenchmark::prepare(m_solver, m_A);
+    m_solve_time = 0;
+    m_num_solves = 0;
+    const auto& data = BenchmarkData::instance();
+    const int64_t num_systems = data.m_experiment_paths.size();
+
+    // Celero runs groups without any experiment value once, with a negative placeholder
+    if (experimentValue.Value < 0 || num_systems == 0) {
+        this->m_failure_count = 0;
+        this->m_setup_status = SetupStatus::FAILURE;
+        return;
+    }
+    SolverFixture<CreateSolver, SolveOnly>::setUp(experimentValue);
+    this->m_num_threads = data.m_solve_threads.at(experiment_variant(experimentValue.Value));
+
+    if (CreateSolver::thread_safe_solve || this->m_setup_status != SetupStatus::SUCCESS) {
+        return;
+    }
+    for (int t = 1; t < this->m_num_threads; ++t) {
+        m_thread_solvers.push_back(CreateSolver::create());
+        if (SolveOnly::prepare(m_thread_solvers.back(), this->A()) != SetupStatus::SUCCESS) {
+            this->m_setup_status = SetupStatus::FAILURE;
+            return;
+        }
+    }
 }
 
-template <typename CreateSolver, typename SetupBenchmark>
-void SolverFixture<CreateSolver, SetupBenchmark>::onExperimentEnd()
+template <typename CreateSolver>
+void ConcurrentSolveFixture<CreateSolver>::solve_concurrently()
 {
-    // only calculate residual on solve phase
-    if constexpr (std::is_same_v<SetupBenchmark, SolveOnly>) {
-        Scalar r = (m_A * m_x - m_b).norm();
-        m_residuals.push_back(r);
+    if (this->m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
+
+    const int num_threads = this->m_num_threads;
+    std::vector<LatencyHistogram> latencies(num_threads);
+    std::vector<size_t> num_solves(num_threads, 0);
+    std::atomic<int> num_failures(0);
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline =
+        start + std::chrono::duration<double>(BenchmarkData::instance().m_solve_duration);
+    auto run = [&](int t) {
+        auto& solver = (t == 0 || m_thread_solvers.empty() ? *this->m_solver
+                                                            : *m_thread_solvers[t - 1]);
+        Eigen::VectorX<Scalar> x(this->m_b.size());
+        Eigen::VectorX<Scalar>& solution = (t == 0 ? this->m_x : x);
+        // The OpenMP setting of the benchmark thread does not apply to the other threads
+        if (t > 0 && this->m_backend_threads > 0) {
+            set_backend_threads(this->m_backend_threads);
+        }
+        try {
+            for (auto now = std::chrono::steady_clock::now(); now < deadline;) {
+                solver.solve(this->m_b, solution);
+                const auto end = std::chrono::steady_clock::now();
+                latencies[t].add(std::chrono::duration<double>(end - now).count());
+                ++num_solves[t];
+                now = end;
+            }
+        } catch (...) {
+            ++num_failures;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t) {
+        threads.emplace_back(run, t);
+    }
+    run(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    m_solve_time +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (int t = 0; t < num_threads; ++t) {
+        this->m_latencies.merge(latencies[t]);
+        m_num_solves += num_solves[t];
+    }
+    if (num_failures > 0) {
+        spdlog::warn(
+            "Concurrent solve failed in {} of {} threads on {}",
+            num_failures.load(),
+            num_threads,
+            this->m_matrix_path.string());
+        this->addFailure();
     }
 }
 
-template <typename CreateSolver, typename SetupBenchmark>
-void SolverFixture<CreateSolver, SetupBenchmark>::tearDown()
+template <typename CreateSolver>
+void ConcurrentSolveFixture<CreateSolver>::tearDown()
 {
-    // Residuals averaged over iterations
-    if constexpr (std::is_same_v<SetupBenchmark, SolveOnly>) {
-        auto const count = static_cast<Scalar>(m_residuals.size());
-        auto const avg = std::reduce(m_residuals.begin(), m_residuals.end()) / count;
-        m_residual_udm->addValue(avg);
-        if (avg > 1e-2) { // somewhat arbitrary definition of failure here
-            this->addFailure();
+    if (m_solve_time > 0) {
+        this->m_solves_per_second = m_num_solves / m_solve_time;
+    }
+    m_thread_solvers.clear();
+    SolverFixture<CreateSolver, SolveOnly>::tearDown();
+}
+
+template <typename CreateSolver, Precision P>
+std::vector<celero::TestFixture::ExperimentValue>
+MixedPrecisionFixture<CreateSolver, P>::getExperimentValues() const
+{
+    if (!BenchmarkData::instance().m_mixed_precision) {
+        return {};
+    }
+    return system_experiment_values();
+}
+
+template <typename CreateSolver, Precision P>
+void MixedPrecisionFixture<CreateSolver, P>::setUp(
+    const celero::TestFixture::ExperimentValue& experimentValue)
+{
+    SolverFixture<CreateSolver, AnalyzeOnly>::setUp(experimentValue);
+    if (this->m_setup_status != SetupStatus::SUCCESS) {
+        return;
+    }
+    m_B = this->m_b;
+    m_X = Eigen::MatrixX<Scalar>::Zero(m_B.rows(), 1);
+    try {
+        if constexpr (P == Precision::Mixed) {
+            m_block_solver = std::make_unique<MixedPrecisionSolver>(
+                CreateSolver::template create_block<float>(),
+                this->m_stored_triangle);
+        } else {
+            m_block_solver = CreateSolver::create_block();
         }
-    } else {
-        m_residual_udm->addValue(-1);
+        m_block_solver->analyzePattern(this->A());
+    } catch (const std::runtime_error& e) {
+        spdlog::warn(
+            "Analysis failed on {} with message {}",
+            this->m_matrix_path.string(),
+            e.what());
+        this->m_setup_status = SetupStatus::FAILURE;
     }
-    m_failure_udm->addValue(m_failure_count);
-    m_memory_udm->addValue(getCurrentRSS());
-    m_residuals.clear();
 }
 
-template <typename CreateSolver, typename SetupBenchmark>
-std::vector<std::shared_ptr<celero::UserDefinedMeasurement>>
-SolverFixture<CreateSolver, SetupBenchmark>::getUserDefinedMeasurements() const
+template <typename CreateSolver, Precision P>
+void MixedPrecisionFixture<CreateSolver, P>::factorize_and_solve()
 {
-    return {this->m_residual_udm, this->m_failure_udm, this->m_memory_udm};
+    if (this->m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
+    try {
+        m_block_solver->factorize(this->A());
+        m_block_solver->solve(m_B, m_X);
+        this->m_x = m_X.col(0);
+    } catch (const std::runtime_error& e) {
+        spdlog::warn(
+            "Factorization or solve failed on {} with message {}",
+            this->m_matrix_path.string(),
+            e.what());
+        this->addFailure();
+    }
 }
 
-template <typename CreateSolver, typename SetupBenchmark>
-void SolverFixture<CreateSolver, SetupBenchmark>::addFailure()
+template <typename CreateSolver, Precision P>
+void MixedPrecisionFixture<CreateSolver, P>::onExperimentEnd()
 {
-    m_failure_count += 1;
+    SolverFixture<CreateSolver, AnalyzeOnly>::onExperimentEnd();
+    if (this->m_setup_status == SetupStatus::SUCCESS) {
+        const Eigen::VectorX<Scalar> Ax =
+            benchy::io::multiply(this->A(), this->m_stored_triangle, this->m_x);
+        this->m_residuals.push_back((Ax - this->m_b).norm());
+    }
+}
+
+template <typename CreateSolver, Precision P>
+void MixedPrecisionFixture<CreateSolver, P>::tearDown()
+{
+    if constexpr (P == Precision::Mixed) {
+        if (m_block_solver) {
+            this->m_refinement_steps =
+                static_cast<const MixedPrecisionSolver&>(*m_block_solver).num_refinement_steps();
+        }
+    } else {
+        this->m_refinement_steps = 0;
+    }
+    m_block_solver.reset();
+    m_B.resize(0, 0);
+    m_X.resize(0, 0);
+    SolverFixture<CreateSolver, AnalyzeOnly>::tearDown();
 }
 
 
@@ -262,14 +1651,28 @@ typedef SolverFixture<CreateEigenSolver, AnalyzeOnly> BaselineFixture;
 BASELINE_FIXED_F(Analyze, Base, BaselineFixture, IterationsCount, 100) {}
 BASELINE_FIXED_F(Factorize, Base, BaselineFixture, IterationsCount, 100) {}
 BASELINE_FIXED_F(Solve, Base, BaselineFixture, IterationsCount, 100) {}
+typedef SequenceFixture<CreateEigenSolver> SequenceBaselineFixture;
+BASELINE_FIXED_F(Refactorize, Base, SequenceBaselineFixture, 1, 100) {}
+typedef MultiSolveFixture<CreateEigenSolver, RhsMode::PerColumn> MultiSolveBaselineFixture;
+BASELINE_FIXED_F(MultiSolve, Base, MultiSolveBaselineFixture, IterationsCount, 100) {}
+typedef ConcurrentSolveFixture<CreateEigenSolver> ConcurrentSolveBaselineFixture;
+BASELINE_FIXED_F(ConcurrentSolve, Base, ConcurrentSolveBaselineFixture, 1, 100) {}
+typedef MixedPrecisionFixture<CreateEigenSolver, Precision::Double> MixedPrecisionBaselineFixture;
+BASELINE_FIXED_F(MixedPrecision, Base, MixedPrecisionBaselineFixture, IterationsCount, 100) {}
+typedef PipelineFixture<CreateEigenSolver> PipelineBaselineFixture;
+BASELINE_FIXED_F(Pipeline, Base, PipelineBaselineFixture, IterationsCount, 100) {}
 
 // Cholmod Supernodal
 #ifdef BENCHY_BENCHMARK_CHOLMOD
 typedef SolverFixture<CreateCholmodSolver, AnalyzeOnly> CholmodAnalyzeFixture;
 BENCHMARK_F(Analyze, Cholmod, CholmodAnalyzeFixture, SamplesCount, IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->analyzePattern(this->m_A, this->m_A.rows());
+        this->m_solver->analyzePattern(this->A(), this->A().rows());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Cholmod Analyze failed on {} with message {}",
@@ -285,8 +1688,12 @@ BENCHMARK_F(Analyze, Cholmod, CholmodAnalyzeFixture, SamplesCount, IterationsCou
 typedef SolverFixture<CreateCholmodSolver, FactorizeOnly> CholmodFactorizeFixture;
 BENCHMARK_F(Factorize, Cholmod, CholmodFactorizeFixture, SamplesCount, IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->factorize(this->m_A);
+        this->m_solver->factorize(this->A());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Cholmod Factorize failed on {} with message {}",
@@ -329,8 +1736,12 @@ BENCHMARK_F(
     SamplesCount,
     IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->analyzePattern(this->m_A, this->m_A.rows());
+        this->m_solver->analyzePattern(this->A(), this->A().rows());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Cholmod Simplicial Analyze failed on {} with message {}",
@@ -352,8 +1763,12 @@ BENCHMARK_F(
     SamplesCount,
     IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->factorize(this->m_A);
+        this->m_solver->factorize(this->A());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Cholmod Simplicial Factorize failed on {} with message {}",
@@ -393,8 +1808,12 @@ BENCHMARK_F(Solve, CholmodSimplicial, CholmodSolveFixture, SamplesCount, Iterati
 typedef SolverFixture<CreateEigenSolver, AnalyzeOnly> EigenAnalyzeFixture;
 BENCHMARK_F(Analyze, Eigen, EigenAnalyzeFixture, SamplesCount, IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->analyzePattern(this->m_A, this->m_A.rows());
+        this->m_solver->analyzePattern(this->A(), this->A().rows());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Eigen Simplicial LLT Analyze failed on {} with message {}",
@@ -410,8 +1829,12 @@ BENCHMARK_F(Analyze, Eigen, EigenAnalyzeFixture, SamplesCount, IterationsCount)
 typedef SolverFixture<CreateEigenSolver, FactorizeOnly> EigenFactorizeFixture;
 BENCHMARK_F(Factorize, Eigen, EigenFactorizeFixture, SamplesCount, IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->factorize(this->m_A);
+        this->m_solver->factorize(this->A());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Eigen Simplicial LLT Factorize failed on {} with message {}",
@@ -451,8 +1874,12 @@ BENCHMARK_F(Solve, Eigen, EigenSolveFixture, SamplesCount, IterationsCount)
 typedef SolverFixture<CreateAccelerateLLTSolver, AnalyzeOnly> AccelerateLLTAnalyzeFixture;
 BENCHMARK_F(Analyze, AccelerateLLT, AccelerateLLTAnalyzeFixture, SamplesCount, IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->analyzePattern(this->m_A, this->m_A.rows());
+        this->m_solver->analyzePattern(this->A(), this->A().rows());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Accelerate LLT Analyze failed on {} with message {}",
@@ -468,8 +1895,12 @@ BENCHMARK_F(Analyze, AccelerateLLT, AccelerateLLTAnalyzeFixture, SamplesCount, I
 typedef SolverFixture<CreateAccelerateLLTSolver, FactorizeOnly> AccelerateLLTFactorizeFixture;
 BENCHMARK_F(Factorize, AccelerateLLT, AccelerateLLTFactorizeFixture, SamplesCount, IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->factorize(this->m_A);
+        this->m_solver->factorize(this->A());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Accelerate LLT Factorize failed on {} with message {}",
@@ -508,8 +1939,12 @@ BENCHMARK_F(Solve, AccelerateLLT, AccelerateLLTSolveFixture, SamplesCount, Itera
 typedef SolverFixture<CreateAccelerateLDLTSolver, AnalyzeOnly> AccelerateLDLTAnalyzeFixture;
 BENCHMARK_F(Analyze, AccelerateLDLT, AccelerateLDLTAnalyzeFixture, SamplesCount, IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->analyzePattern(this->m_A, this->m_A.rows());
+        this->m_solver->analyzePattern(this->A(), this->A().rows());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Accelerate LDLT Analyze failed on {} with message {}",
@@ -530,8 +1965,12 @@ BENCHMARK_F(
     SamplesCount,
     IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->factorize(this->m_A);
+        this->m_solver->factorize(this->A());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Accelerate LDLT Factorize failed on {} with message {}",
@@ -571,8 +2010,12 @@ BENCHMARK_F(Solve, AccelerateLDLT, AccelerateLDLTSolveFixture, SamplesCount, Ite
 typedef SolverFixture<CreatePardisoSolver, AnalyzeOnly> PardisoAnalyzeFixture;
 BENCHMARK_F(Analyze, Pardiso, PardisoAnalyzeFixture, SamplesCount, IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->analyzePattern(this->m_A, this->m_A.rows());
+        this->m_solver->analyzePattern(this->A(), this->A().rows());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "MKL Pardiso Analyze failed on {} with message {}",
@@ -588,8 +2031,12 @@ BENCHMARK_F(Analyze, Pardiso, PardisoAnalyzeFixture, SamplesCount, IterationsCou
 typedef SolverFixture<CreatePardisoSolver, FactorizeOnly> PardisoFactorizeFixture;
 BENCHMARK_F(Factorize, Pardiso, PardisoFactorizeFixture, SamplesCount, IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->factorize(this->m_A);
+        this->m_solver->factorize(this->A());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "MKL Pardiso Factorize failed on {} with message {}",
@@ -629,8 +2076,12 @@ BENCHMARK_F(Solve, Pardiso, PardisoSolveFixture, SamplesCount, IterationsCount)
 typedef SolverFixture<CreateSympilerSolver, AnalyzeOnly> SympilerAnalyzeFixture;
 BENCHMARK_F(Analyze, Sympiler, SympilerAnalyzeFixture, SamplesCount, IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->analyzePattern(this->m_A, this->m_A.rows());
+        this->m_solver->analyzePattern(this->A(), this->A().rows());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Sympiler Analyze failed on {} with message {}",
@@ -646,8 +2097,12 @@ BENCHMARK_F(Analyze, Sympiler, SympilerAnalyzeFixture, SamplesCount, IterationsC
 typedef SolverFixture<CreateSympilerSolver, FactorizeOnly> SympilerFactorizeFixture;
 BENCHMARK_F(Factorize, Sympiler, SympilerFactorizeFixture, SamplesCount, IterationsCount)
 {
+    if (m_setup_status != SetupStatus::SUCCESS) {
+        this->addFailure();
+        return;
+    }
     try {
-        this->m_solver->factorize(this->m_A);
+        this->m_solver->factorize(this->A());
     } catch (const std::runtime_error& e) {
         spdlog::warn(
             "Sympiler Factorize failed on {} with message {}",
@@ -682,5 +2137,427 @@ BENCHMARK_F(Solve, Sympiler, SympilerSolverFixture, SamplesCount, IterationsCoun
 }
 #endif
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Single-pass pipelines
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef BENCHY_BENCHMARK_CHOLMOD
+typedef PipelineFixture<CreateCholmodSolver> CholmodPipelineFixture;
+BENCHMARK_F(Pipeline, Cholmod, CholmodPipelineFixture, SamplesCount, IterationsCount)
+{
+    this->run_pipeline();
+}
+
+typedef PipelineFixture<CreateCholmodSimplicialSolver> CholmodSimplicialPipelineFixture;
+BENCHMARK_F(
+    Pipeline,
+    CholmodSimplicial,
+    CholmodSimplicialPipelineFixture,
+    SamplesCount,
+    IterationsCount)
+{
+    this->run_pipeline();
+}
+#endif
+
+#ifdef BENCHY_BENCHMARK_EIGEN
+typedef PipelineFixture<CreateEigenSolver> EigenPipelineFixture;
+BENCHMARK_F(Pipeline, Eigen, EigenPipelineFixture, SamplesCount, IterationsCount)
+{
+    this->run_pipeline();
+}
+#endif
+
+#ifdef BENCHY_WITH_ACCELERATE
+typedef PipelineFixture<CreateAccelerateLLTSolver> AccelerateLLTPipelineFixture;
+BENCHMARK_F(Pipeline, AccelerateLLT, AccelerateLLTPipelineFixture, SamplesCount, IterationsCount)
+{
+    this->run_pipeline();
+}
+
+typedef PipelineFixture<CreateAccelerateLDLTSolver> AccelerateLDLTPipelineFixture;
+BENCHMARK_F(Pipeline, AccelerateLDLT, AccelerateLDLTPipelineFixture, SamplesCount, IterationsCount)
+{
+    this->run_pipeline();
+}
+#endif
+
+#ifdef BENCHY_WITH_MKL
+typedef PipelineFixture<CreatePardisoSolver> PardisoPipelineFixture;
+BENCHMARK_F(Pipeline, Pardiso, PardisoPipelineFixture, SamplesCount, IterationsCount)
+{
+    this->run_pipeline();
+}
+#endif
+
+#ifdef POLYSOLVE_WITH_SYMPILER
+typedef PipelineFixture<CreateSympilerSolver> SympilerPipelineFixture;
+BENCHMARK_F(Pipeline, Sympiler, SympilerPipelineFixture, SamplesCount, IterationsCount)
+{
+    this->run_pipeline();
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Refactorization of sequences
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Each iteration factorizes and solves a whole sequence
+static const int SequenceIterationsCount = 1;
+
+#ifdef BENCHY_BENCHMARK_CHOLMOD
+typedef SequenceFixture<CreateCholmodSolver> CholmodSequenceFixture;
+BENCHMARK_F(Refactorize, Cholmod, CholmodSequenceFixture, SamplesCount, SequenceIterationsCount)
+{
+    this->refactorize();
+}
+
+typedef SequenceFixture<CreateCholmodSimplicialSolver> CholmodSimplicialSequenceFixture;
+BENCHMARK_F(
+    Refactorize,
+    CholmodSimplicial,
+    CholmodSimplicialSequenceFixture,
+    SamplesCount,
+    SequenceIterationsCount)
+{
+    this->refactorize();
+}
+#endif
+
+#ifdef BENCHY_BENCHMARK_EIGEN
+typedef SequenceFixture<CreateEigenSolver> EigenSequenceFixture;
+BENCHMARK_F(Refactorize, Eigen, EigenSequenceFixture, SamplesCount, SequenceIterationsCount)
+{
+    this->refactorize();
+}
+#endif
+
+#ifdef BENCHY_WITH_ACCELERATE
+typedef SequenceFixture<CreateAccelerateLLTSolver> AccelerateLLTSequenceFixture;
+BENCHMARK_F(
+    Refactorize,
+    AccelerateLLT,
+    AccelerateLLTSequenceFixture,
+    SamplesCount,
+    SequenceIterationsCount)
+{
+    this->refactorize();
+}
+
+typedef SequenceFixture<CreateAccelerateLDLTSolver> AccelerateLDLTSequenceFixture;
+BENCHMARK_F(
+    Refactorize,
+    AccelerateLDLT,
+    AccelerateLDLTSequenceFixture,
+    SamplesCount,
+    SequenceIterationsCount)
+{
+    this->refactorize();
+}
+#endif
+
+#ifdef BENCHY_WITH_MKL
+typedef SequenceFixture<CreatePardisoSolver> PardisoSequenceFixture;
+BENCHMARK_F(Refactorize, Pardiso, PardisoSequenceFixture, SamplesCount, SequenceIterationsCount)
+{
+    this->refactorize();
+}
+#endif
+
+#ifdef POLYSOLVE_WITH_SYMPILER
+typedef SequenceFixture<CreateSympilerSolver> SympilerSequenceFixture;
+BENCHMARK_F(Refactorize, Sympiler, SympilerSequenceFixture, SamplesCount, SequenceIterationsCount)
+{
+    this->refactorize();
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Blocks of right-hand sides
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef BENCHY_BENCHMARK_CHOLMOD
+typedef MultiSolveFixture<CreateCholmodSolver, RhsMode::PerColumn> CholmodPerColumnFixture;
+BENCHMARK_F(MultiSolve, CholmodPerColumn, CholmodPerColumnFixture, SamplesCount, IterationsCount)
+{
+    this->solve();
+}
+
+typedef MultiSolveFixture<CreateCholmodSolver, RhsMode::Block> CholmodBlockFixture;
+BENCHMARK_F(MultiSolve, CholmodBlock, CholmodBlockFixture, SamplesCount, IterationsCount)
+{
+    this->solve();
+}
+
+typedef MultiSolveFixture<CreateCholmodSimplicialSolver, RhsMode::PerColumn>
+    CholmodSimplicialPerColumnFixture;
+BENCHMARK_F(
+    MultiSolve,
+    CholmodSimplicialPerColumn,
+    CholmodSimplicialPerColumnFixture,
+    SamplesCount,
+    IterationsCount)
+{
+    this->solve();
+}
+
+typedef MultiSolveFixture<CreateCholmodSimplicialSolver, RhsMode::Block>
+    CholmodSimplicialBlockFixture;
+BENCHMARK_F(
+    MultiSolve,
+    CholmodSimplicialBlock,
+    CholmodSimplicialBlockFixture,
+    SamplesCount,
+    IterationsCount)
+{
+    this->solve();
+}
+#endif
+
+#ifdef BENCHY_BENCHMARK_EIGEN
+typedef MultiSolveFixture<CreateEigenSolver, RhsMode::PerColumn> EigenPerColumnFixture;
+BENCHMARK_F(MultiSolve, EigenPerColumn, EigenPerColumnFixture, SamplesCount, IterationsCount)
+{
+    this->solve();
+}
+
+typedef MultiSolveFixture<CreateEigenSolver, RhsMode::Block> EigenBlockFixture;
+BENCHMARK_F(MultiSolve, EigenBlock, EigenBlockFixture, SamplesCount, IterationsCount)
+{
+    this->solve();
+}
+#endif
+
+#ifdef BENCHY_WITH_ACCELERATE
+typedef MultiSolveFixture<CreateAccelerateLLTSolver, RhsMode::PerColumn>
+    AccelerateLLTPerColumnFixture;
+BENCHMARK_F(
+    MultiSolve,
+    AccelerateLLTPerColumn,
+    AccelerateLLTPerColumnFixture,
+    SamplesCount,
+    IterationsCount)
+{
+    this->solve();
+}
+
+typedef MultiSolveFixture<CreateAccelerateLLTSolver, RhsMode::Block> AccelerateLLTBlockFixture;
+BENCHMARK_F(
+    MultiSolve,
+    AccelerateLLTBlock,
+    AccelerateLLTBlockFixture,
+    SamplesCount,
+    IterationsCount)
+{
+    this->solve();
+}
+
+typedef MultiSolveFixture<CreateAccelerateLDLTSolver, RhsMode::PerColumn>
+    AccelerateLDLTPerColumnFixture;
+BENCHMARK_F(
+    MultiSolve,
+    AccelerateLDLTPerColumn,
+    AccelerateLDLTPerColumnFixture,
+    SamplesCount,
+    IterationsCount)
+{
+    this->solve();
+}
+
+typedef MultiSolveFixture<CreateAccelerateLDLTSolver, RhsMode::Block> AccelerateLDLTBlockFixture;
+BENCHMARK_F(
+    MultiSolve,
+    AccelerateLDLTBlock,
+    AccelerateLDLTBlockFixture,
+    SamplesCount,
+    IterationsCount)
+{
+    this->solve();
+}
+#endif
+
+#ifdef BENCHY_WITH_MKL
+typedef MultiSolveFixture<CreatePardisoSolver, RhsMode::PerColumn> PardisoPerColumnFixture;
+BENCHMARK_F(MultiSolve, PardisoPerColumn, PardisoPerColumnFixture, SamplesCount, IterationsCount)
+{
+    this->solve();
+}
+
+typedef MultiSolveFixture<CreatePardisoSolver, RhsMode::Block> PardisoBlockFixture;
+BENCHMARK_F(MultiSolve, PardisoBlock, PardisoBlockFixture, SamplesCount, IterationsCount)
+{
+    this->solve();
+}
+#endif
+
+// Sympiler is only reached through polysolve, which solves one rhs at a time
+#ifdef POLYSOLVE_WITH_SYMPILER
+typedef MultiSolveFixture<CreateSympilerSolver, RhsMode::PerColumn> SympilerPerColumnFixture;
+BENCHMARK_F(MultiSolve, SympilerPerColumn, SympilerPerColumnFixture, SamplesCount, IterationsCount)
+{
+    this->solve();
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Concurrent solves
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Each iteration runs the threads for BenchmarkData::m_solve_duration
+static const int ConcurrentIterationsCount = 1;
+
+#ifdef BENCHY_BENCHMARK_CHOLMOD
+typedef ConcurrentSolveFixture<CreateCholmodSolver> CholmodConcurrentFixture;
+BENCHMARK_F(
+    ConcurrentSolve,
+    Cholmod,
+    CholmodConcurrentFixture,
+    SamplesCount,
+    ConcurrentIterationsCount)
+{
+    this->solve_concurrently();
+}
+
+typedef ConcurrentSolveFixture<CreateCholmodSimplicialSolver> CholmodSimplicialConcurrentFixture;
+BENCHMARK_F(
+    ConcurrentSolve,
+    CholmodSimplicial,
+    CholmodSimplicialConcurrentFixture,
+    SamplesCount,
+    ConcurrentIterationsCount)
+{
+    this->solve_concurrently();
+}
+#endif
+
+#ifdef BENCHY_BENCHMARK_EIGEN
+typedef ConcurrentSolveFixture<CreateEigenSolver> EigenConcurrentFixture;
+BENCHMARK_F(ConcurrentSolve, Eigen, EigenConcurrentFixture, SamplesCount, ConcurrentIterationsCount)
+{
+    this->solve_concurrently();
+}
+#endif
+
+#ifdef BENCHY_WITH_ACCELERATE
+typedef ConcurrentSolveFixture<CreateAccelerateLLTSolver> AccelerateLLTConcurrentFixture;
+BENCHMARK_F(
+    ConcurrentSolve,
+    AccelerateLLT,
+    AccelerateLLTConcurrentFixture,
+    SamplesCount,
+    ConcurrentIterationsCount)
+{
+    this->solve_concurrently();
+}
+
+typedef ConcurrentSolveFixture<CreateAccelerateLDLTSolver> AccelerateLDLTConcurrentFixture;
+BENCHMARK_F(
+    ConcurrentSolve,
+    AccelerateLDLT,
+    AccelerateLDLTConcurrentFixture,
+    SamplesCount,
+    ConcurrentIterationsCount)
+{
+    this->solve_concurrently();
+}
+#endif
+
+#ifdef BENCHY_WITH_MKL
+typedef ConcurrentSolveFixture<CreatePardisoSolver> PardisoConcurrentFixture;
+BENCHMARK_F(
+    ConcurrentSolve,
+    Pardiso,
+    PardisoConcurrentFixture,
+    SamplesCount,
+    ConcurrentIterationsCount)
+{
+    this->solve_concurrently();
+}
+#endif
+
+#ifdef POLYSOLVE_WITH_SYMPILER
+typedef ConcurrentSolveFixture<CreateSympilerSolver> SympilerConcurrentFixture;
+BENCHMARK_F(
+    ConcurrentSolve,
+    Sympiler,
+    SympilerConcurrentFixture,
+    SamplesCount,
+    ConcurrentIterationsCount)
+{
+    this->solve_concurrently();
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Mixed-precision solves
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Cholmod and Pardiso are only wrapped by Eigen in double precision, and Sympiler is only reached
+// through polysolve
+
+#ifdef BENCHY_BENCHMARK_EIGEN
+typedef MixedPrecisionFixture<CreateEigenSolver, Precision::Double> EigenDoubleFixture;
+BENCHMARK_F(MixedPrecision, EigenDouble, EigenDoubleFixture, SamplesCount, IterationsCount)
+{
+    this->factorize_and_solve();
+}
+
+typedef MixedPrecisionFixture<CreateEigenSolver, Precision::Mixed> EigenMixedFixture;
+BENCHMARK_F(MixedPrecision, EigenMixed, EigenMixedFixture, SamplesCount, IterationsCount)
+{
+    this->factorize_and_solve();
+}
+#endif
+
+#ifdef BENCHY_WITH_ACCELERATE
+typedef MixedPrecisionFixture<CreateAccelerateLLTSolver, Precision::Double>
+    AccelerateLLTDoubleFixture;
+BENCHMARK_F(
+    MixedPrecision,
+    AccelerateLLTDouble,
+    AccelerateLLTDoubleFixture,
+    SamplesCount,
+    IterationsCount)
+{
+    this->factorize_and_solve();
+}
+
+typedef MixedPrecisionFixture<CreateAccelerateLLTSolver, Precision::Mixed>
+    AccelerateLLTMixedFixture;
+BENCHMARK_F(
+    MixedPrecision,
+    AccelerateLLTMixed,
+    AccelerateLLTMixedFixture,
+    SamplesCount,
+    IterationsCount)
+{
+    this->factorize_and_solve();
+}
+
+typedef MixedPrecisionFixture<CreateAccelerateLDLTSolver, Precision::Double>
+    AccelerateLDLTDoubleFixture;
+BENCHMARK_F(
+    MixedPrecision,
+    AccelerateLDLTDouble,
+    AccelerateLDLTDoubleFixture,
+    SamplesCount,
+    IterationsCount)
+{
+    this->factorize_and_solve();
+}
+
+typedef MixedPrecisionFixture<CreateAccelerateLDLTSolver, Precision::Mixed>
+    AccelerateLDLTMixedFixture;
+BENCHMARK_F(
+    MixedPrecision,
+    AccelerateLDLTMixed,
+    AccelerateLDLTMixedFixture,
+    SamplesCount,
+    IterationsCount)
+{
+    this->factorize_and_solve();
+}
+#endif
+
 } // namespace benchmark
 } // namespace benchy
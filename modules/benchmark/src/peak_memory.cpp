@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+// Local include
+#include <benchy/benchmark/peak_memory.h>
+#include <benchy/benchmark/getRSS.h>
+
+// System include
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+
+namespace benchy {
+namespace benchmark {
+
+namespace {
+
+#if defined(__linux__)
+///
+/// Reads a field of /proc/self/status given in kB, e.g. "VmHWM"
+/// @returns Value of the field in bytes, 0 if it cannot be read
+///
+size_t read_status_bytes(const std::string& key)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, key.size(), key) == 0 && line.size() > key.size() &&
+            line[key.size()] == ':') {
+            return std::stoull(line.substr(key.size() + 1)) * 1024;
+        }
+    }
+    return 0;
+}
+
+///
+/// Resets the peak resident set size of the process to the current one (Linux 4.0 and later)
+/// @returns Whether the peak was reset
+///
+bool reset_peak()
+{
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.close();
+    return static_cast<bool>(clear_refs);
+}
+#else
+size_t read_status_bytes(const std::string&)
+{
+    return 0;
+}
+
+bool reset_peak()
+{
+    return false;
+}
+#endif
+
+} // namespace
+
+bool PeakMemoryMonitor::can_reset_peak()
+{
+    static const bool s_can_reset = reset_peak() && read_status_bytes("VmHWM") > 0;
+    return s_can_reset;
+}
+
+PeakMemoryMonitor::~PeakMemoryMonitor()
+{
+    if (m_running) {
+        stop();
+    }
+}
+
+void PeakMemoryMonitor::start()
+{
+    if (m_running) {
+        stop();
+    }
+    m_running = true;
+    if (can_reset_peak()) {
+        reset_peak();
+        m_baseline = read_status_bytes("VmRSS");
+        return;
+    }
+    m_baseline = getCurrentRSS();
+    m_sampled_peak = m_baseline;
+    m_sampling = true;
+    m_sampler = std::thread([this]() {
+        while (m_sampling) {
+            const size_t rss = getCurrentRSS();
+            if (rss > m_sampled_peak) {
+                m_sampled_peak = rss;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+}
+
+size_t PeakMemoryMonitor::stop()
+{
+    if (!m_running) {
+        return 0;
+    }
+    m_running = false;
+    size_t peak = 0;
+    if (m_sampler.joinable()) {
+        m_sampling = false;
+        m_sampler.join();
+        peak = std::max<size_t>(m_sampled_peak, getCurrentRSS());
+    } else {
+        peak = read_status_bytes("VmHWM");
+    }
+    return peak > m_baseline ? peak - m_baseline : 0;
+}
+
+} // namespace benchmark
+} // namespace benchy
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+// Local include
+#include <benchy/benchmark/perf_counters.h>
+
+// Third-party include
+#include <spdlog/spdlog.h>
+
+// System include
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace benchy {
+namespace benchmark {
+
+namespace {
+
+///
+/// Kernel event counted for a PerfEvent. Several kernel events may be added to count one
+/// PerfEvent, each with its own weight
+///
+struct CounterSpec
+{
+    PerfEvent event;
+    uint32_t type;
+    uint64_t config;
+    double weight;
+};
+
+#if defined(__linux__)
+
+bool is_intel()
+{
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 9, "vendor_id") == 0) {
+            return line.find("GenuineIntel") != std::string::npos;
+        }
+    }
+    return false;
+}
+
+std::vector<CounterSpec> candidate_specs()
+{
+    std::vector<CounterSpec> specs = {
+        {PerfEvent::Cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 1},
+        {PerfEvent::Instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 1},
+        {PerfEvent::LLCMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, 1},
+        {PerfEvent::BranchMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, 1}};
+    if (is_intel()) {
+        // FP_ARITH_INST_RETIRED (event 0xc7) for scalar, 128, 256 and 512-bit double-precision
+        // instructions, weighted by their number of operations
+        const std::pair<uint64_t, double> umasks[] = {{0x01, 1}, {0x04, 2}, {0x10, 4}, {0x40, 8}};
+        for (const auto& [umask, width] : umasks) {
+            specs.push_back({PerfEvent::FPOps, PERF_TYPE_RAW, 0xc7 | (umask << 8), width});
+        }
+    }
+    return specs;
+}
+
+///
+/// Opens a counter of a thread, and of the threads it creates afterwards
+/// @returns File descriptor of the counter, -1 on failure
+///
+int open_counter(const CounterSpec& spec, pid_t tid)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, -1, 0));
+}
+
+///
+/// Kernel events which can be opened on this system, probed on the calling thread
+///
+const std::vector<CounterSpec>& supported_specs()
+{
+    static const std::vector<CounterSpec> s_specs = []() {
+        std::vector<CounterSpec> specs;
+        for (const auto& spec : candidate_specs()) {
+            const int fd = open_counter(spec, 0);
+            if (fd >= 0) {
+                close(fd);
+                specs.push_back(spec);
+            }
+        }
+        if (specs.empty()) {
+            spdlog::info("Hardware performance counters are not available");
+        }
+        return specs;
+    }();
+    return s_specs;
+}
+
+std::vector<pid_t> process_threads()
+{
+    std::vector<pid_t> tids;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/task", ec)) {
+        tids.push_back(static_cast<pid_t>(std::stol(entry.path().filename().string())));
+    }
+    return tids;
+}
+
+#else
+
+const std::vector<CounterSpec>& supported_specs()
+{
+    static const std::vector<CounterSpec> s_specs;
+    return s_specs;
+}
+
+#endif
+
+} // namespace
+
+const char* perf_event_name(PerfEvent event)
+{
+    switch (event) {
+    case PerfEvent::Cycles: return "Cycles";
+    case PerfEvent::Instructions: return "Instructions";
+    case PerfEvent::LLCMisses: return "LLC Misses";
+    case PerfEvent::BranchMisses: return "Branch Misses";
+    case PerfEvent::FPOps: return "FP Ops";
+    }
+    return "";
+}
+
+bool PerfCounters::available()
+{
+    return !supported_specs().empty();
+}
+
+bool PerfCounters::supported(PerfEvent event)
+{
+    const auto& specs = supported_specs();
+    return std::any_of(specs.begin(), specs.end(), [&](const CounterSpec& spec) {
+        return spec.event == event;
+    });
+}
+
+PerfCounters::~PerfCounters()
+{
+    if (m_running) {
+        stop();
+    }
+}
+
+void PerfCounters::start()
+{
+    if (m_running) {
+        stop();
+    }
+    m_running = true;
+#if defined(__linux__)
+    const auto& specs = supported_specs();
+    if (specs.empty()) {
+        return;
+    }
+    for (const pid_t tid : process_threads()) {
+        for (size_t i = 0; i < specs.size(); ++i) {
+            const int fd = open_counter(specs[i], tid);
+            if (fd >= 0) {
+                m_counters.push_back({fd, i});
+            }
+        }
+    }
+#endif
+}
+
+PerfCounts PerfCounters::stop()
+{
+    PerfCounts counts;
+    if (!m_running) {
+        return counts;
+    }
+    m_running = false;
+#if defined(__linux__)
+    const auto& specs = supported_specs();
+    for (const auto& spec : specs) {
+        counts.values[size_t(spec.event)] = 0;
+    }
+    for (const auto& counter : m_counters) {
+        ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (const auto& counter : m_counters) {
+        // Value, time enabled and time running, which differ if the counter was multiplexed
+        uint64_t data[3];
+        if (read(counter.fd, data, sizeof(data)) == sizeof(data) && data[2] > 0) {
+            const auto& spec = specs[counter.spec];
+            const double scale = static_cast<double>(data[1]) / static_cast<double>(data[2]);
+            counts.values[size_t(spec.event)] += static_cast<double>(data[0]) * scale * spec.weight;
+        }
+        close(counter.fd);
+    }
+    m_counters.clear();
+#endif
+    return counts;
+}
+
+} // namespace benchmark
+} // namespace benchy
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+// Local include
+#include <benchy/benchmark/thread_control.h>
+
+// System include
+#include <cstdint>
+
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#endif
+
+namespace benchy {
+namespace benchmark {
+
+namespace {
+
+///
+/// Functions setting the number of threads of the backends, null if not loaded
+///
+struct BackendSetters
+{
+    void (*omp)(int) = nullptr;
+    void (*mkl)(int) = nullptr;
+    void (*openblas)(int) = nullptr;
+    void (*blis)(int64_t) = nullptr;
+    std::vector<std::string> names;
+};
+
+template <typename Function>
+void find_setter(const char* symbol, const char* name, Function& f, std::vector<std::string>& names)
+{
+#if !defined(_WIN32)
+    f = reinterpret_cast<Function>(dlsym(RTLD_DEFAULT, symbol));
+    if (f) {
+        names.push_back(name);
+    }
+#endif
+}
+
+const BackendSetters& backend_setters()
+{
+    static const BackendSetters s_setters = []() {
+        BackendSetters setters;
+        find_setter("omp_set_num_threads", "OpenMP", setters.omp, setters.names);
+        find_setter("MKL_Set_Num_Threads", "MKL", setters.mkl, setters.names);
+        find_setter("openblas_set_num_threads", "OpenBLAS", setters.openblas, setters.names);
+        find_setter("bli_thread_set_num_threads", "BLIS", setters.blis, setters.names);
+        return setters;
+    }();
+    return s_setters;
+}
+
+} // namespace
+
+const std::vector<std::string>& thread_backends()
+{
+    return backend_setters().names;
+}
+
+void set_backend_threads(int num_threads)
+{
+    const auto& setters = backend_setters();
+    if (setters.omp) setters.omp(num_threads);
+    if (setters.mkl) setters.mkl(num_threads);
+    if (setters.openblas) setters.openblas(num_threads);
+    if (setters.blis) setters.blis(num_threads);
+}
+
+} // namespace benchmark
+} // namespace benchy
@@ -0,0 +1,268 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace benchy {
+namespace io {
+
+///
+/// On-disk layout of the binary CSC container (`.bcsc`).
+///
+/// The file starts with this fixed-size header, followed by the metadata (json text) and the raw
+/// CSC arrays of A (outer index, inner index, values) and the dense column-major rhs b. Every
+/// section starts at an offset aligned to `kBinaryAlignment` bytes, so that the arrays can be
+/// memory-mapped and used in place. All values are stored in little-endian byte order.
+///
+/// This header only depends on the STL so that it can be shipped alongside save_problem.h.
+///
+struct BinaryHeader
+{
+    /// Magic string identifying the file format.
+    char magic[8];
+
+    /// Version of the file format.
+    uint32_t version;
+
+    /// Bit flags (`kBinaryFlag*`) describing optional features of the file. Zero for a plain CSC
+    /// container.
+    uint32_t flags;
+
+    /// Always equal to `kBinaryByteOrder` when written on a little-endian machine.
+    uint32_t byte_order;
+
+    /// Size of a scalar in bytes (4 for float, 8 for double).
+    uint32_t scalar_size;
+
+    /// Size of a sparse index in bytes.
+    uint32_t index_size;
+
+    /// Padding (always 0).
+    uint32_t padding;
+
+    /// Number of rows of A.
+    int64_t rows;
+
+    /// Number of columns of A.
+    int64_t cols;
+
+    /// Number of stored nonzeros of A.
+    int64_t nnz;
+
+    /// Number of rows of b.
+    int64_t b_rows;
+
+    /// Number of columns of b.
+    int64_t b_cols;
+
+    /// Byte offset and size of the json metadata.
+    uint64_t metadata_offset;
+    uint64_t metadata_size;
+
+    /// Byte offsets of the outer index, inner index, values and rhs arrays.
+    uint64_t outer_offset;
+    uint64_t inner_offset;
+    uint64_t values_offset;
+    uint64_t b_offset;
+
+    /// Reserved for future versions (always 0).
+    uint64_t reserved[17];
+};
+
+static_assert(sizeof(BinaryHeader) == 256, "Unexpected binary header size");
+
+constexpr char kBinaryMagic[8] = {'B', 'E', 'N', 'C', 'H', 'Y', 'S', 'P'};
+constexpr uint32_t kBinaryVersion = 1;
+constexpr uint32_t kBinaryByteOrder = 0x01020304;
+constexpr uint64_t kBinaryAlignment = 64;
+
+/// Header flags set when A only stores its lower (resp. upper) triangle. The same information is
+/// stored as "stored_triangle" in the metadata.
+constexpr uint32_t kBinaryFlagLowerTriangle = 1u << 0;
+constexpr uint32_t kBinaryFlagUpperTriangle = 1u << 1;
+
+/// Rounds up a byte offset to the next section boundary.
+constexpr uint64_t align_binary_offset(uint64_t offset)
+{
+    return (offset + kBinaryAlignment - 1) / kBinaryAlignment * kBinaryAlignment;
+}
+
+///
+/// Fills the section offsets of a binary header from its array dimensions.
+///
+/// @param[in,out] header  Header with rows, cols, nnz, b_rows, b_cols, scalar_size, index_size and
+///                        metadata_size already set.
+///
+/// @return     Total size of the file in bytes. Offsets are not checked for overflow, so the
+///             dimensions of a header read from a file must first be bounded by its size.
+///
+inline uint64_t layout_binary_header(BinaryHeader& header)
+{
+    std::memcpy(header.magic, kBinaryMagic, sizeof(header.magic));
+    header.version = kBinaryVersion;
+    header.byte_order = kBinaryByteOrder;
+    header.metadata_offset = align_binary_offset(sizeof(BinaryHeader));
+    header.outer_offset = align_binary_offset(header.metadata_offset + header.metadata_size);
+    header.inner_offset =
+        align_binary_offset(header.outer_offset + (header.cols + 1) * header.index_size);
+    header.values_offset =
+        align_binary_offset(header.inner_offset + header.nnz * header.index_size);
+    header.b_offset = align_binary_offset(header.values_offset + header.nnz * header.scalar_size);
+    return header.b_offset + header.b_rows * header.b_cols * header.scalar_size;
+}
+
+///
+/// On-disk layout of a sequence of linear systems sharing the same sparsity pattern (`.bseq`).
+///
+/// The file starts with this fixed-size header, followed by the CSC pattern of A (outer and inner
+/// index), which is stored once. Then comes one block per step, holding the values of A and the
+/// dense column-major rhs b. The json metadata is stored last, so that steps can be written as
+/// they are produced. All step blocks have the same size, so any step is found in constant time.
+/// Alignment and byte order follow the binary CSC container.
+///
+struct SequenceHeader
+{
+    /// Magic string identifying the file format.
+    char magic[8];
+
+    /// Version of the file format.
+    uint32_t version;
+
+    /// Bit flags (`kBinaryFlag*`) describing optional features of the file.
+    uint32_t flags;
+
+    /// Always equal to `kBinaryByteOrder` when written on a little-endian machine.
+    uint32_t byte_order;
+
+    /// Size of a scalar in bytes (4 for float, 8 for double).
+    uint32_t scalar_size;
+
+    /// Size of a sparse index in bytes.
+    uint32_t index_size;
+
+    /// Padding (always 0).
+    uint32_t padding;
+
+    /// Number of rows of A.
+    int64_t rows;
+
+    /// Number of columns of A.
+    int64_t cols;
+
+    /// Number of stored nonzeros of A.
+    int64_t nnz;
+
+    /// Number of rows of b.
+    int64_t b_rows;
+
+    /// Number of columns of b.
+    int64_t b_cols;
+
+    /// Number of steps in the sequence.
+    int64_t num_steps;
+
+    /// Byte offsets of the outer and inner index arrays.
+    uint64_t outer_offset;
+    uint64_t inner_offset;
+
+    /// Byte offset of the first step, and size of a step in bytes.
+    uint64_t steps_offset;
+    uint64_t step_size;
+
+    /// Byte offset of the rhs inside a step. The values of A are at the start of the step.
+    uint64_t step_b_offset;
+
+    /// Byte offset and size of the json metadata.
+    uint64_t metadata_offset;
+    uint64_t metadata_size;
+
+    /// Reserved for future versions (always 0).
+    uint64_t reserved[15];
+};
+
+static_assert(sizeof(SequenceHeader) == 256, "Unexpected sequence header size");
+
+constexpr char kSequenceMagic[8] = {'B', 'E', 'N', 'C', 'H', 'Y', 'S', 'Q'};
+constexpr uint32_t kSequenceVersion = 1;
+
+///
+/// Fills the section offsets of a sequence header from its array dimensions.
+///
+/// @param[in,out] header  Header with rows, cols, nnz, b_rows, b_cols, num_steps, scalar_size,
+///                        index_size and metadata_size already set.
+///
+/// @return     Total size of the file in bytes.
+///
+inline uint64_t layout_sequence_header(SequenceHeader& header)
+{
+    std::memcpy(header.magic, kSequenceMagic, sizeof(header.magic));
+    header.version = kSequenceVersion;
+    header.byte_order = kBinaryByteOrder;
+    header.outer_offset = align_binary_offset(sizeof(SequenceHeader));
+    header.inner_offset =
+        align_binary_offset(header.outer_offset + (header.cols + 1) * header.index_size);
+    header.steps_offset =
+        align_binary_offset(header.inner_offset + header.nnz * header.index_size);
+    header.step_b_offset = align_binary_offset(header.nnz * header.scalar_size);
+    header.step_size = align_binary_offset(
+        header.step_b_offset + header.b_rows * header.b_cols * header.scalar_size);
+    header.metadata_offset = header.steps_offset + header.num_steps * header.step_size;
+    return header.metadata_offset + header.metadata_size;
+}
+
+///
+/// On-disk layout of a pack of linear systems (`.bpack`).
+///
+/// A pack holds many systems in a single file, so that a dataset can be opened without listing
+/// and opening thousands of small files. The file starts with this fixed-size header, followed by
+/// the members, which are complete `.bcsc`, `.zst` or `.bseq` files stored back to back, each one
+/// starting at an offset aligned to `kBinaryAlignment`. The table of members (name, format,
+/// offset, size and summary of every system) is stored last as a messagepack array, so that
+/// members can be appended as they are read.
+///
+struct PackHeader
+{
+    /// Magic string identifying the file format.
+    char magic[8];
+
+    /// Version of the file format.
+    uint32_t version;
+
+    /// Bit flags describing optional features of the file (always 0).
+    uint32_t flags;
+
+    /// Always equal to `kBinaryByteOrder` when written on a little-endian machine.
+    uint32_t byte_order;
+
+    /// Padding (always 0).
+    uint32_t padding;
+
+    /// Number of members.
+    int64_t num_entries;
+
+    /// Byte offset and size of the messagepack table of members.
+    uint64_t table_offset;
+    uint64_t table_size;
+
+    /// Reserved for future versions (always 0).
+    uint64_t reserved[26];
+};
+
+static_assert(sizeof(PackHeader) == 256, "Unexpected pack header size");
+
+constexpr char kPackMagic[8] = {'B', 'E', 'N', 'C', 'H', 'Y', 'P', 'K'};
+constexpr uint32_t kPackVersion = 1;
+
+} // namespace io
+} // namespace benchy
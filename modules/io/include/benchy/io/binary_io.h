@@ -0,0 +1,178 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <benchy/io/binary_format.h>
+#include <benchy/io/linear_system.h>
+#include <benchy/io/mapped_file.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace benchy {
+namespace io {
+
+///
+/// Linear system stored in a memory-mapped binary CSC container (`.bcsc`).
+///
+/// The sparse matrix and rhs are exposed as Eigen maps pointing directly into the file mapping,
+/// so no data is copied or parsed when opening a system. The maps stay valid as long as this
+/// object (or a copy of it) is alive.
+///
+/// @code
+/// benchy::io::MappedSystem system("my_problem.bcsc");
+/// auto A = system.A<double>();
+/// auto b = system.b<double>();
+/// Eigen::VectorXd r = A * x - b.col(0);
+/// @endcode
+///
+class MappedSystem
+{
+public:
+    template <typename Scalar>
+    using SparseMap = Eigen::Map<const Eigen::SparseMatrix<Scalar, Eigen::ColMajor, int32_t>>;
+
+    template <typename Scalar>
+    using DenseMap = Eigen::Map<const Eigen::MatrixX<Scalar>>;
+
+    ///
+    /// Maps a binary container from disk.
+    ///
+    /// @param[in]  filename  Path to the .bcsc file.
+    ///
+    explicit MappedSystem(const std::filesystem::path& filename);
+
+    ///
+    /// Views a binary container stored inside an existing file mapping.
+    ///
+    /// @param[in]  file    Mapped file holding the container.
+    /// @param[in]  offset  Byte offset of the container inside the file. Must be aligned to
+    ///                     `kBinaryAlignment`.
+    ///
+    MappedSystem(std::shared_ptr<const MappedFile> file, size_t offset);
+
+    /// Header of the container.
+    const BinaryHeader& header() const { return m_header; }
+
+    /// Problem metadata.
+    const nlohmann::json& metadata() const { return m_metadata; }
+
+    /// Whether the arrays are stored in single precision.
+    bool is_float() const { return m_header.scalar_size == sizeof(float); }
+
+    ///
+    /// Zero-copy view of the sparse matrix A.
+    ///
+    /// @tparam     Scalar  Must match the scalar type stored in the file.
+    ///
+    template <typename Scalar>
+    SparseMap<Scalar> A() const
+    {
+        check_scalar<Scalar>();
+        return SparseMap<Scalar>(
+            m_header.rows,
+            m_header.cols,
+            m_header.nnz,
+            section<int32_t>(m_header.outer_offset),
+            section<int32_t>(m_header.inner_offset),
+            section<Scalar>(m_header.values_offset));
+    }
+
+    ///
+    /// Zero-copy view of the dense rhs b.
+    ///
+    /// @tparam     Scalar  Must match the scalar type stored in the file.
+    ///
+    template <typename Scalar>
+    DenseMap<Scalar> b() const
+    {
+        check_scalar<Scalar>();
+        return DenseMap<Scalar>(
+            section<Scalar>(m_header.b_offset),
+            m_header.b_rows,
+            m_header.b_cols);
+    }
+
+private:
+    void parse();
+
+    template <typename Scalar>
+    void check_scalar() const
+    {
+        if (m_header.scalar_size != sizeof(Scalar)) {
+            throw std::runtime_error(
+                "Scalar size mismatch: file stores " + std::to_string(m_header.scalar_size) +
+                "-byte scalars");
+        }
+    }
+
+    template <typename T>
+    const T* section(uint64_t offset) const
+    {
+        return reinterpret_cast<const T*>(m_base + offset);
+    }
+
+private:
+    std::shared_ptr<const MappedFile> m_file;
+    const std::byte* m_base = nullptr;
+    size_t m_size = 0;
+    BinaryHeader m_header;
+    nlohmann::json m_metadata;
+};
+
+///
+/// Saves a linear system as a binary CSC container (`.bcsc`).
+///
+/// @param[in]  filename  Output filename.
+/// @param[in]  system    Linear system to save.
+///
+/// @tparam     Scalar    Problem scalar type (float or double).
+///
+template <typename Scalar>
+void save_binary(const std::filesystem::path& filename, const LinearSystem<Scalar>& system);
+
+///
+/// Loads a binary CSC container into an owning linear system.
+///
+/// The file is memory-mapped and its arrays are copied (and converted to `Scalar` if needed)
+/// without any parsing.
+///
+/// @param[in]  filename  Path to the .bcsc file.
+///
+/// @tparam     Scalar    Scalar type of the returned system.
+///
+/// @return     The loaded linear system.
+///
+template <typename Scalar>
+LinearSystem<Scalar> load_binary(const std::filesystem::path& filename);
+
+///
+/// Copies a mapped binary container into an owning linear system, converting it to `Scalar` if
+/// needed.
+///
+/// @param[in]  mapped  Mapped container.
+///
+/// @tparam     Scalar  Scalar type of the returned system.
+///
+/// @return     The copied linear system.
+///
+template <typename Scalar>
+LinearSystem<Scalar> load_binary(const MappedSystem& mapped);
+
+} // namespace io
+} // namespace benchy
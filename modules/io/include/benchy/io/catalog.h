@@ -0,0 +1,136 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+
+namespace benchy {
+namespace io {
+
+///
+/// Summary of a linear system stored on disk, as recorded in a Catalog.
+///
+struct SystemInfo
+{
+    /// Number of rows of A.
+    int64_t rows = 0;
+
+    /// Number of columns of A.
+    int64_t cols = 0;
+
+    /// Number of nonzeros of the full matrix A, even if only one triangle is stored.
+    int64_t nnz = 0;
+
+    /// Short name of the dataset the problem belongs to.
+    std::string dataset_name;
+
+    /// Dimensionality of the underlying problem (0 if unknown).
+    int dimension = 0;
+
+    /// Whether A is flagged as SPD (-1 if unknown).
+    int is_symmetric_positive_definite = -1;
+
+    /// Number of systems sharing the pattern of A, for sequence containers (`.bseq`).
+    int64_t num_steps = 1;
+
+    /// Size of the file in bytes.
+    uint64_t file_size = 0;
+
+    /// Last modification time of the file, in ticks of `std::filesystem::file_time_type`.
+    int64_t mtime = 0;
+};
+
+void to_json(nlohmann::json& j, const SystemInfo& info);
+void from_json(const nlohmann::json& j, SystemInfo& info);
+
+///
+/// Reads the summary of a linear system stored in any supported format, without keeping the
+/// matrix in memory. `.bcsc` containers are only mapped, and `.zst` archives are decoded in a
+/// single streaming pass that does not store any value.
+///
+/// @param[in]  filename  Path to the linear system.
+///
+/// @return     Summary of the system.
+///
+SystemInfo read_system_info(const std::filesystem::path& filename);
+
+///
+/// Persistent index of the linear systems of a dataset, stored as a json sidecar file.
+///
+/// Entries are keyed by path, and are only refreshed when the size or the modification time of
+/// the file changes. Paths inside the directory of the catalog are stored relative to it, so that
+/// the dataset can be moved together with its catalog.
+///
+/// @code
+/// benchy::io::Catalog catalog(data_dir / benchy::io::Catalog::default_filename());
+/// for (const auto& path : paths) {
+///     spdlog::info("{} has {} nonzeros", path.string(), catalog.get(path).nnz);
+/// }
+/// catalog.save();
+/// @endcode
+///
+class Catalog
+{
+public:
+    /// Default name of the catalog file, at the root of a dataset.
+    static const char* default_filename() { return ".benchy_catalog.json"; }
+
+    ///
+    /// Loads a catalog from disk. A missing or unreadable file results in an empty catalog.
+    ///
+    /// @param[in]  filename  Path to the catalog file. If empty, the catalog is only kept in
+    ///                       memory.
+    ///
+    explicit Catalog(std::filesystem::path filename = {});
+
+    ///
+    /// Returns the summary of a linear system, reading the file only if it is not in the catalog
+    /// or has changed since it was recorded.
+    ///
+    /// @param[in]  system  Path to the linear system.
+    ///
+    /// @return     Summary of the system.
+    ///
+    const SystemInfo& get(const std::filesystem::path& system);
+
+    /// Removes the entries of files that do not exist anymore.
+    void remove_missing();
+
+    /// Writes the catalog back to disk if it was modified.
+    void save();
+
+    /// Number of entries in the catalog.
+    size_t size() const { return m_entries.size(); }
+
+    /// Number of files read by `get()` since the catalog was loaded.
+    size_t num_refreshed() const { return m_num_refreshed; }
+
+private:
+    std::string key(const std::filesystem::path& system) const;
+
+    std::filesystem::path resolve(const std::string& key) const;
+
+private:
+    std::filesystem::path m_filename;
+    std::filesystem::path m_root;
+    std::map<std::string, SystemInfo> m_entries;
+    size_t m_num_refreshed = 0;
+    bool m_modified = false;
+};
+
+} // namespace io
+} // namespace benchy
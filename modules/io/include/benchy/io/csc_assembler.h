@@ -0,0 +1,129 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <Eigen/Sparse>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace benchy {
+namespace io {
+
+///
+/// Assembles a column-major sparse matrix from a stream of (row, col, value) entries whose count
+/// is known in advance.
+///
+/// Row indices and values are written directly into the storage of the output matrix. When the
+/// entries come sorted by column and then by row (which is how all our writers emit them), the
+/// outer index is obtained by counting entries per column and no intermediate triplet list is
+/// ever created. Otherwise the entries are assembled with `setFromTriplets()`, which sorts them
+/// and sums duplicates.
+///
+/// @tparam     Scalar        Scalar type of the matrix.
+/// @tparam     StorageIndex  Index type of the matrix.
+///
+template <typename Scalar, typename StorageIndex = int>
+class CscAssembler
+{
+public:
+    using Matrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor, StorageIndex>;
+
+    ///
+    /// Allocates storage for the output matrix.
+    ///
+    /// @param[in]  rows  Number of rows.
+    /// @param[in]  cols  Number of columns.
+    /// @param[in]  nnz   Number of entries that will be set.
+    ///
+    CscAssembler(Eigen::Index rows, Eigen::Index cols, Eigen::Index nnz)
+        : m_cols(nnz)
+    {
+        m_matrix.resize(rows, cols);
+        m_matrix.resizeNonZeros(nnz);
+    }
+
+    /// Number of entries.
+    Eigen::Index nonZeros() const { return static_cast<Eigen::Index>(m_cols.size()); }
+
+    /// Sets the row index of the k-th entry.
+    void set_row(Eigen::Index k, StorageIndex row) { m_matrix.innerIndexPtr()[k] = row; }
+
+    /// Sets the column index of the k-th entry.
+    void set_col(Eigen::Index k, StorageIndex col) { m_cols[k] = col; }
+
+    /// Sets the value of the k-th entry.
+    void set_value(Eigen::Index k, Scalar value) { m_matrix.valuePtr()[k] = value; }
+
+    /// Sets all fields of the k-th entry.
+    void set(Eigen::Index k, StorageIndex row, StorageIndex col, Scalar value)
+    {
+        set_row(k, row);
+        set_col(k, col);
+        set_value(k, value);
+    }
+
+    ///
+    /// Builds the output matrix once all entries have been set. The assembler cannot be reused.
+    ///
+    /// @return     The assembled matrix.
+    ///
+    Matrix finalize()
+    {
+        const Eigen::Index nnz = nonZeros();
+        const Eigen::Index rows = m_matrix.rows();
+        const Eigen::Index cols = m_matrix.cols();
+        const StorageIndex* inner = m_matrix.innerIndexPtr();
+        StorageIndex* outer = m_matrix.outerIndexPtr();
+        std::fill(outer, outer + cols + 1, StorageIndex(0));
+
+        bool sorted = true;
+        for (Eigen::Index k = 0; k < nnz; ++k) {
+            const StorageIndex r = inner[k];
+            const StorageIndex c = m_cols[k];
+            if (r < 0 || r >= rows || c < 0 || c >= cols) {
+                throw std::runtime_error(
+                    "Sparse entry (" + std::to_string(r) + ", " + std::to_string(c) +
+                    ") is out of bounds");
+            }
+            if (k > 0 && (c < m_cols[k - 1] || (c == m_cols[k - 1] && r <= inner[k - 1]))) {
+                sorted = false;
+            }
+            ++outer[c + 1];
+        }
+
+        if (sorted) {
+            for (Eigen::Index j = 0; j < cols; ++j) {
+                outer[j + 1] += outer[j];
+            }
+        } else {
+            std::vector<Eigen::Triplet<Scalar, StorageIndex>> triplets;
+            triplets.reserve(nnz);
+            for (Eigen::Index k = 0; k < nnz; ++k) {
+                triplets.emplace_back(inner[k], m_cols[k], m_matrix.valuePtr()[k]);
+            }
+            m_matrix.setZero();
+            m_matrix.setFromTriplets(triplets.begin(), triplets.end());
+        }
+        m_cols = {};
+        return std::move(m_matrix);
+    }
+
+private:
+    Matrix m_matrix;
+    std::vector<StorageIndex> m_cols;
+};
+
+} // namespace io
+} // namespace benchy
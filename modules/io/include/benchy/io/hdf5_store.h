@@ -0,0 +1,244 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#ifdef BENCHY_WITH_HDF5
+
+#include <benchy/io/linear_system.h>
+
+#include <Eigen/Sparse>
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace benchy {
+namespace io {
+
+///
+/// Settings of the datasets written by `Hdf5Store`.
+///
+struct Hdf5StoreOptions
+{
+    /// Deflate level of the datasets, from 0 (no compression) to 9.
+    int deflate_level = 4;
+
+    /// Number of entries per chunk. A chunk is the unit of compression and of partial reads.
+    size_t chunk_size = size_t(1) << 16;
+};
+
+///
+/// Summary of a problem of an `Hdf5Store`, read from its attributes only.
+///
+struct Hdf5ProblemInfo
+{
+    /// Size of A.
+    int64_t rows = 0;
+    int64_t cols = 0;
+
+    /// Number of stored nonzeros of A (only one triangle for SPD problems in half storage).
+    int64_t nnz = 0;
+
+    /// Size of b.
+    int64_t b_rows = 0;
+    int64_t b_cols = 0;
+
+    /// Number of systems sharing the pattern of A (1 for a single system).
+    int64_t num_steps = 1;
+
+    /// Size in bytes of the stored values (4 or 8).
+    int scalar_size = 0;
+
+    /// Problem metadata.
+    nlohmann::json metadata = nlohmann::json::object();
+};
+
+///
+/// Collection of linear systems stored in a single HDF5 file (`.h5`).
+///
+/// Every problem is a group `/problems/<name>`, where names may contain slashes to mirror the
+/// layout of a dataset directory. A problem is a sequence of one or more systems sharing the
+/// pattern of A, stored as chunked and compressed datasets:
+/// - `outer` and `inner`: CSC pattern of A (int32), stored once.
+/// - `values`: values of A, one row of `nnz` entries per step.
+/// - `b`: rhs of each step in column-major order, one row of `b_rows * b_cols` entries per step.
+///
+/// The sizes and the metadata are attributes of the group, so every part of a problem can be read
+/// on its own: its summary, the pattern of A, or a single step, which only decompresses the
+/// chunks of that step.
+///
+/// A problem can also be referred to by the path `<store>.h5/<name>`, which is accepted by
+/// `load_system()`, `read_system_info()` and `Catalog` (see `split_store_path()`).
+///
+/// HDF5 is not thread-safe, so the operations of all stores are serialized by a global lock. A
+/// store may be shared between threads, but is never read by several threads in parallel.
+///
+/// @code
+/// benchy::io::Hdf5Store store("dataset.h5");
+/// for (const auto& name : store.problems()) {
+///     const auto pattern = store.read_pattern<double>(name);
+///     solver->analyzePattern(pattern, pattern.rows());
+///     benchy::io::LinearSystem<double> system;
+///     for (int64_t k = 0; k < store.info(name).num_steps; ++k) {
+///         store.read_step(name, k, system); // only reads the values after the first step
+///         solver->factorize(system.A);
+///     }
+/// }
+/// @endcode
+///
+class Hdf5Store
+{
+public:
+    enum class Mode {
+        Read, ///< Open an existing file for reading.
+        Append, ///< Open an existing file for writing, or create it.
+        Truncate, ///< Create an empty file, replacing any existing one.
+    };
+
+    ///
+    /// Opens or creates a store.
+    ///
+    /// @param[in]  filename  Path to the .h5 file.
+    /// @param[in]  mode      How to open the file.
+    /// @param[in]  options   Settings of the written datasets.
+    ///
+    /// @throws     std::runtime_error if the file cannot be opened, or is not a problem store.
+    ///
+    explicit Hdf5Store(
+        const std::filesystem::path& filename,
+        Mode mode = Mode::Read,
+        Hdf5StoreOptions options = {});
+
+    ///
+    /// Closes the file.
+    ///
+    ~Hdf5Store();
+
+    Hdf5Store(Hdf5Store&& other) noexcept;
+    Hdf5Store& operator=(Hdf5Store&& other) noexcept;
+    Hdf5Store(const Hdf5Store&) = delete;
+    Hdf5Store& operator=(const Hdf5Store&) = delete;
+
+    /// Names of all problems of the store, in alphabetical order.
+    std::vector<std::string> problems() const;
+
+    /// Whether the store holds a problem.
+    bool contains(const std::string& name) const;
+
+    ///
+    /// Reads the sizes and metadata of a problem, without reading any dataset.
+    ///
+    /// @param[in]  name  Name of the problem.
+    ///
+    Hdf5ProblemInfo info(const std::string& name) const;
+
+    ///
+    /// Reads the pattern of A. Its values are all zero.
+    ///
+    /// @param[in]  name    Name of the problem.
+    ///
+    /// @tparam     Scalar  Scalar type of the returned matrix.
+    ///
+    template <typename Scalar>
+    Eigen::SparseMatrix<Scalar, Eigen::ColMajor> read_pattern(const std::string& name) const;
+
+    ///
+    /// Reads a step of a problem into an owning linear system, converting it to `Scalar` if
+    /// needed.
+    ///
+    /// If `system` already holds a compressed matrix with the stored pattern (for instance because
+    /// it was filled from another step of this problem, or by `read_pattern()`), its index arrays
+    /// are kept and only the values are written into them. Otherwise, e.g. for a system filled
+    /// from another problem of the same size, the pattern is read again.
+    ///
+    /// @param[in]     name    Name of the problem.
+    /// @param[in]     step    Index of the step.
+    /// @param[in,out] system  System receiving the step.
+    ///
+    /// @tparam        Scalar  Scalar type of the system.
+    ///
+    template <typename Scalar>
+    void read_step(const std::string& name, size_t step, LinearSystem<Scalar>& system) const;
+
+    ///
+    /// Reads a step of a problem.
+    ///
+    /// @param[in]  name    Name of the problem.
+    /// @param[in]  step    Index of the step.
+    ///
+    /// @tparam     Scalar  Scalar type of the returned system.
+    ///
+    template <typename Scalar>
+    LinearSystem<Scalar> read(const std::string& name, size_t step = 0) const;
+
+    ///
+    /// Writes a problem made of one or more steps sharing the pattern of A. The metadata of the
+    /// first step is stored, completed with the number of steps and the scalar type. An existing
+    /// problem with the same name is replaced (the file does not shrink, use `h5repack` to
+    /// reclaim the space).
+    ///
+    /// @param[in]  name    Name of the problem.
+    /// @param[in]  steps   Systems of the problem, all with the same pattern and rhs size.
+    ///
+    /// @tparam     Scalar  Scalar type of the stored values (float or double).
+    ///
+    template <typename Scalar>
+    void write(const std::string& name, const std::vector<LinearSystem<Scalar>>& steps);
+
+    ///
+    /// Writes a problem made of a single system. See `write()` above.
+    ///
+    template <typename Scalar>
+    void write(const std::string& name, const LinearSystem<Scalar>& system);
+
+private:
+    /// HDF5 identifier of the file (an `hid_t`).
+    int64_t m_file = -1;
+
+    Hdf5StoreOptions m_options;
+};
+
+///
+/// Splits a path referring to a problem of a store, `<store>.h5/<name>`. The first component
+/// ending with `.h5` is taken as the store, without checking the file system.
+///
+/// @param[in]  path   Path to split.
+/// @param[out] store  Path to the store.
+/// @param[out] name   Name of the problem, with forward slashes.
+///
+/// @return     Whether the path refers to a problem of a store.
+///
+bool split_store_path(
+    const std::filesystem::path& path,
+    std::filesystem::path& store,
+    std::string& name);
+
+///
+/// Opens a store for reading, sharing it with the other users of the same file. The file is
+/// opened again once all previous users have released it.
+///
+/// This function is thread-safe.
+///
+/// @param[in]  filename  Path to the .h5 file.
+///
+/// @return     The opened store.
+///
+std::shared_ptr<const Hdf5Store> open_store(const std::filesystem::path& filename);
+
+} // namespace io
+} // namespace benchy
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <Eigen/Sparse>
+#include <nlohmann/json.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace benchy {
+namespace io {
+
+///
+/// Encodes unsigned integers with a byte-aligned variable-length code ("Stream VByte").
+///
+/// Each value takes 1 to 4 bytes. The 2-bit lengths of the values are grouped in control bytes
+/// (4 values per byte) stored before the value bytes, so that a decoder can expand 4 values at
+/// once with a single byte shuffle.
+///
+/// @param[in]  values  Values to encode.
+/// @param[in]  count   Number of values.
+///
+/// @return     Control bytes, followed by the value bytes.
+///
+std::vector<uint8_t> encode_varints(const uint32_t* values, size_t count);
+
+///
+/// Decodes values written by `encode_varints()`.
+///
+/// Uses SSSE3 (x86-64, detected at runtime) or NEON (arm64) shuffles when available, and a
+/// scalar loop otherwise.
+///
+/// @param[in]  data        Encoded bytes.
+/// @param[in]  size        Number of encoded bytes.
+/// @param[in]  count       Number of values to decode.
+/// @param[out] values      Output array of `count` values.
+/// @param[in]  allow_simd  Set to false to force the scalar decoder.
+///
+/// @throws     std::runtime_error if the encoded size does not match the number of values.
+///
+void decode_varints(
+    const uint8_t* data,
+    size_t size,
+    size_t count,
+    uint32_t* values,
+    bool allow_simd = true);
+
+/// Name of the instruction set used by `decode_varints()` on this machine ("ssse3", "neon" or
+/// "scalar").
+const char* varint_decoder_name();
+
+///
+/// Sparse matrix with compressed indices, as stored in `.zst` archives written with
+/// `benchy_convert --encode-indices`.
+///
+/// Column sizes and per-column deltas of the row indices are small integers, which take 1 or 2
+/// bytes with `encode_varints()` instead of 4, and which zstd compresses much better than
+/// absolute indices. Values are stored as raw little-endian floats, so that a whole matrix is
+/// decoded with a few bulk copies instead of one messagepack token per entry.
+///
+/// In json, it is an object with the keys "index_encoding", "rows", "cols", "nnz",
+/// "value_size", and the binary entries "outer", "inner" and "values". Both
+/// `load_compressed_system()` and the json deserialization of `Eigen::SparseMatrix` accept it in
+/// place of the triplet arrays.
+///
+struct EncodedSparseMatrix
+{
+    /// Value of the "index_encoding" key.
+    static constexpr const char* kIndexEncoding = "delta-streamvbyte";
+
+    Eigen::Index rows = 0;
+    Eigen::Index cols = 0;
+    Eigen::Index nnz = 0;
+
+    /// Size in bytes of each value (4 or 8).
+    int value_size = 0;
+
+    /// Encoded number of entries of each column.
+    std::vector<uint8_t> outer;
+
+    /// Encoded row indices. The first row of each column is stored as is, the next ones as the
+    /// difference with the previous row.
+    std::vector<uint8_t> inner;
+
+    /// Values in column-major order.
+    std::vector<uint8_t> values;
+};
+
+///
+/// Compresses the indices of a sparse matrix.
+///
+/// @param[in]  A     Matrix to encode. Row indices must be sorted within each column.
+///
+/// @tparam     Scalar  Scalar type of the matrix, which is also the type of stored values.
+///
+/// @return     Encoded matrix.
+///
+template <typename Scalar>
+EncodedSparseMatrix encode_sparse_matrix(const Eigen::SparseMatrix<Scalar>& A);
+
+///
+/// Decodes a matrix written by `encode_sparse_matrix()`. Values are converted if they were
+/// stored with a different precision.
+///
+/// @param[in]  encoded  Encoded matrix.
+/// @param[out] A        Decoded matrix, in compressed mode.
+///
+/// @throws     std::runtime_error if the encoded data is inconsistent.
+///
+template <typename Scalar>
+void decode_sparse_matrix(const EncodedSparseMatrix& encoded, Eigen::SparseMatrix<Scalar>& A);
+
+void to_json(nlohmann::json& j, const EncodedSparseMatrix& encoded);
+void from_json(const nlohmann::json& j, EncodedSparseMatrix& encoded);
+
+} // namespace io
+} // namespace benchy
@@ -11,6 +11,8 @@
  */
 #pragma once
 
+#include <benchy/io/index_codec.h>
+
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 #include <nlohmann/json.hpp>
@@ -102,6 +104,13 @@ struct adl_serializer<Eigen::SparseMatrix<Scalar_, Options_, StorageIndex_>>
 
     static void from_json(const nlohmann::json& j, SpMatrix& matrix)
     {
+        if (j.is_object()) {
+            // Compressed indices, see index_codec.h
+            Eigen::SparseMatrix<Scalar_> decoded;
+            benchy::io::decode_sparse_matrix(j.get<benchy::io::EncodedSparseMatrix>(), decoded);
+            matrix = decoded;
+            return;
+        }
         if (j.size() != 5) {
             throw json::other_error::create(
                 502,
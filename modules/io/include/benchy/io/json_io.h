@@ -11,18 +11,56 @@
  */
 #pragma once
 
+#include <benchy/io/linear_system.h>
+
 #include <nlohmann/json.hpp>
 
 #include <filesystem>
+#include <istream>
 
 namespace benchy {
 namespace io {
 
+///
+/// Settings of the zstd encoder used by save_compressed. The defaults produce the same archives
+/// as previous versions (default level, single thread).
+///
+struct CompressionOptions
+{
+    /// Compression level, from ZSTD_minCLevel() (fastest) to ZSTD_maxCLevel() (smallest).
+    /// Zero selects the zstd default level.
+    int level = 0;
+
+    /// Number of worker threads compressing in parallel. Zero compresses on the calling thread.
+    /// The output does not depend on the number of workers once it is nonzero.
+    int num_workers = 0;
+
+    /// Enables long-distance matching, which finds repetitions far apart in large archives.
+    bool long_distance_matching = false;
+
+    /// Base-2 logarithm of the maximum back-reference distance. Zero lets zstd choose based on
+    /// the level. Values above 27 need to be allowed explicitly by other zstd decoders
+    /// (e.g. `zstd --long=31 -d`).
+    int window_log = 0;
+};
+
 // Serialize json to messagepack and compressed with zstd
-void save_compressed(const std::filesystem::path& filename, const nlohmann::json& json);
+void save_compressed(
+    const std::filesystem::path& filename,
+    const nlohmann::json& json,
+    const CompressionOptions& options = {});
 
-// Decompress a zstd archive and load uncompressed messagepack as json
+// Decompress a zstd archive on the fly and load the messagepack stream as json
 nlohmann::json load_compressed(const std::filesystem::path& filename);
 
+// Decompress a zstd archive and decode the messagepack stream directly into a linear system,
+// without building an intermediate json DOM or triplet list. Also accepts legacy "lhs"/"rhs" keys.
+template <typename Scalar>
+LinearSystem<Scalar> load_compressed_system(const std::filesystem::path& filename);
+
+// Same as above, reading the zstd archive from a stream (e.g. a member of a pack file)
+template <typename Scalar>
+LinearSystem<Scalar> load_compressed_system(std::istream& compressed);
+
 } // namespace io
 } // namespace benchy
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <benchy/io/json_eigen.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <nlohmann/json.hpp>
+
+namespace benchy {
+namespace io {
+
+///
+/// Linear system `A x = b` as stored in the benchmark dataset, together with its metadata.
+///
+/// @tparam     Scalar    Problem scalar type (float or double).
+///
+template <typename Scalar>
+struct LinearSystem
+{
+    /// Left-hand side sparse matrix. SPD matrices may only store one triangle, see
+    /// symmetric_storage.h.
+    Eigen::SparseMatrix<Scalar, Eigen::ColMajor> A;
+
+    /// Right-hand side dense matrix, one column per rhs.
+    Eigen::MatrixX<Scalar> b;
+
+    /// Problem metadata (see `Problem` in save_problem.h for the expected keys).
+    nlohmann::json metadata = nlohmann::json::object();
+};
+
+template <typename Scalar>
+void to_json(nlohmann::json& j, const LinearSystem<Scalar>& system)
+{
+    j["A"] = system.A;
+    j["b"] = system.b;
+    j["metadata"] = system.metadata;
+}
+
+template <typename Scalar>
+void from_json(const nlohmann::json& j, LinearSystem<Scalar>& system)
+{
+    // Older archives used "lhs"/"rhs" instead of "A"/"b"
+    system.A = j.contains("A") ? j.at("A") : j.at("lhs");
+    system.b = j.contains("b") ? j.at("b") : j.at("rhs");
+    system.metadata = j.value("metadata", nlohmann::json::object());
+}
+
+} // namespace io
+} // namespace benchy
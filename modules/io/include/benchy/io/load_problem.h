@@ -11,6 +11,8 @@
  */
 #pragma once
 
+#include <benchy/io/linear_system.h>
+
 #include <nlohmann/json.hpp>
 
 #include <filesystem>
@@ -21,5 +23,11 @@ namespace io {
 // Load a file create by "save_problem()" into a json object
 nlohmann::json load_problem(const std::filesystem::path& filename);
 
+// Load a file created by "save_problem()" directly into a linear system. The file is parsed in a
+// single streaming pass and the triplets are written straight into CSC storage, without building
+// a json DOM, so memory usage stays proportional to the size of the matrix.
+template <typename Scalar>
+LinearSystem<Scalar> load_problem_system(const std::filesystem::path& filename);
+
 } // namespace io
 } // namespace benchy
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <benchy/io/linear_system.h>
+
+#include <filesystem>
+
+namespace benchy {
+namespace io {
+
+///
+/// Loads a linear system from any of the supported formats, based on the file extension:
+/// - `<pack>.bpack/<name>`: member of a pack, in any of the formats below (see `MappedPack`).
+/// - `<store>.h5/<name>`: first step of a problem of an HDF5 store, in builds with HDF5 support
+///   (see `Hdf5Store`).
+/// - `.zst`: zstd-compressed messagepack archive (see `load_compressed_system()`).
+/// - `.bcsc`: binary CSC container (see `load_binary()`).
+/// - `.bseq`: first step of a sequence container (see `MappedSequence` for the other steps).
+/// - anything else: json file written by `save_problem()` (see `load_problem_system()`).
+///
+/// @param[in]  filename  Path to the linear system.
+///
+/// @tparam     Scalar    Scalar type of the returned system.
+///
+/// @return     The loaded linear system.
+///
+template <typename Scalar>
+LinearSystem<Scalar> load_system(const std::filesystem::path& filename);
+
+} // namespace io
+} // namespace benchy
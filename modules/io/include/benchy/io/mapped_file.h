@@ -0,0 +1,54 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace benchy {
+namespace io {
+
+///
+/// Read-only memory mapping of a whole file. The mapping is released on destruction.
+///
+class MappedFile
+{
+public:
+    ///
+    /// Maps a file in memory.
+    ///
+    /// @param[in]  filename  File to map. Throws std::runtime_error if it cannot be mapped.
+    ///
+    explicit MappedFile(const std::filesystem::path& filename);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Pointer to the first byte of the file.
+    const std::byte* data() const { return m_data; }
+
+    /// Size of the file in bytes.
+    size_t size() const { return m_size; }
+
+private:
+    const std::byte* m_data = nullptr;
+    size_t m_size = 0;
+#if defined(_WIN32)
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+} // namespace io
+} // namespace benchy
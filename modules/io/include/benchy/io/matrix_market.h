@@ -0,0 +1,72 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <benchy/io/linear_system.h>
+
+#include <cstddef>
+#include <filesystem>
+
+namespace benchy {
+namespace io {
+
+///
+/// Settings of the Matrix Market parser.
+///
+struct MatrixMarketOptions
+{
+    /// Number of parsing threads, 0 to use all cores.
+    size_t num_threads = 0;
+
+    /// Approximate size in bytes of the blocks of lines parsed by each task.
+    size_t chunk_size = size_t(32) << 20;
+};
+
+///
+/// Imports a linear system from Matrix Market files (`.mtx`), as distributed by the SuiteSparse
+/// Matrix Collection.
+///
+/// The matrix must be in coordinate format, with a `real`, `integer` or `pattern` field (entries
+/// of a pattern matrix are set to 1), and `general` or `symmetric` symmetry. The file is
+/// memory-mapped and split into blocks of lines parsed in parallel with `std::from_chars`, in two
+/// passes: the first one counts the entries, the second one writes them directly into the CSC
+/// storage of A. Files sorted by column (which is how the collection stores them) are assembled
+/// without any sorting, other files are sorted column by column. Duplicate entries are summed.
+///
+/// Symmetric matrices are stored as their lower triangle, tagged as `"stored_triangle": "lower"`
+/// in the metadata (see symmetric_storage.h).
+///
+/// The rhs is read from `filename_b` (`array` or `coordinate` format, one column per rhs). When
+/// it is empty, the rhs is computed as `b = A * 1`, so that the exact solution is a vector of
+/// ones, and the metadata is tagged with `"generated_rhs": 1`.
+///
+/// The metadata holds the keys written by `save_problem()`, with `is_symmetric_positive_definite`
+/// set to 0 since the format does not tell, and the comments of the file as the description.
+///
+/// @param[in]  filename_A  Path to the matrix.
+/// @param[in]  filename_b  Path to the rhs, or an empty path to generate it.
+/// @param[in]  options     Settings of the parser.
+///
+/// @tparam     Scalar      Scalar type of the returned system.
+///
+/// @throws     std::runtime_error if a file is malformed or uses an unsupported format.
+///
+/// @return     The imported linear system.
+///
+template <typename Scalar>
+LinearSystem<Scalar> load_matrix_market(
+    const std::filesystem::path& filename_A,
+    const std::filesystem::path& filename_b = {},
+    const MatrixMarketOptions& options = {});
+
+} // namespace io
+} // namespace benchy
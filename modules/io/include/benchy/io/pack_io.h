@@ -0,0 +1,235 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <benchy/io/binary_format.h>
+#include <benchy/io/binary_io.h>
+#include <benchy/io/catalog.h>
+#include <benchy/io/linear_system.h>
+#include <benchy/io/mapped_file.h>
+#include <benchy/io/sequence_io.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace benchy {
+namespace io {
+
+/// Format of a member of a pack, which is a complete file of that format.
+enum class PackFormat {
+    Binary, ///< Binary CSC container (`.bcsc`).
+    Compressed, ///< Zstd-compressed messagepack archive (`.zst`).
+    Sequence, ///< Sequence container (`.bseq`).
+};
+
+///
+/// Entry of the table of members of a pack.
+///
+struct PackEntry
+{
+    /// Name of the member, usually the path of the original file relative to the root of the
+    /// dataset, with forward slashes.
+    std::string name;
+
+    /// Format of the member.
+    PackFormat format = PackFormat::Binary;
+
+    /// Byte offset and size of the member inside the pack.
+    uint64_t offset = 0;
+    uint64_t size = 0;
+
+    /// Summary of the system. The file size and modification time are those of the original file.
+    SystemInfo info;
+};
+
+///
+/// Pack of linear systems stored in a single memory-mapped file (`.bpack`).
+///
+/// The table of members is read once when opening the pack, so that a whole dataset is listed
+/// and summarized without touching the file system again. Members are found by index or by name
+/// in constant time, and are only read when they are loaded: `.bcsc` members can be used in
+/// place through `system()`, `.bseq` members through `sequence()`.
+///
+/// A member can also be referred to by the path `<pack>.bpack/<name>`, which is accepted by
+/// `load_system()`, `read_system_info()` and `Catalog`, so a pack can be used in place of the
+/// directory it was made from (see `split_pack_path()`).
+///
+/// @code
+/// benchy::io::MappedPack pack("dataset.bpack");
+/// for (size_t i = 0; i < pack.size(); ++i) {
+///     spdlog::info("{} has {} nonzeros", pack.entry(i).name, pack.entry(i).info.nnz);
+/// }
+/// auto system = pack.load<double>(pack.index_of("harmonic/my_problem.zst"));
+/// @endcode
+///
+class MappedPack
+{
+public:
+    ///
+    /// Maps a pack from disk and reads its table of members.
+    ///
+    /// @param[in]  filename  Path to the .bpack file.
+    ///
+    explicit MappedPack(const std::filesystem::path& filename);
+
+    /// Path to the pack.
+    const std::filesystem::path& filename() const { return m_filename; }
+
+    /// Header of the pack.
+    const PackHeader& header() const { return m_header; }
+
+    /// Number of members.
+    size_t size() const { return m_entries.size(); }
+
+    /// All members, in the order they were added.
+    const std::vector<PackEntry>& entries() const { return m_entries; }
+
+    /// Member at a given index. Throws std::out_of_range if the index is invalid.
+    const PackEntry& entry(size_t index) const { return m_entries.at(index); }
+
+    /// Index of a member, if the pack holds it.
+    std::optional<size_t> find(const std::string& name) const;
+
+    /// Whether the pack holds a member.
+    bool contains(const std::string& name) const { return find(name).has_value(); }
+
+    /// Index of a member. Throws std::runtime_error if the pack does not hold it.
+    size_t index_of(const std::string& name) const;
+
+    /// Path referring to a member, `<pack>/<name>`.
+    std::filesystem::path member_path(size_t index) const
+    {
+        return m_filename / entry(index).name;
+    }
+
+    ///
+    /// Loads a member into an owning linear system. Sequences are loaded as their first step.
+    ///
+    /// @param[in]  index   Index of the member.
+    ///
+    /// @tparam     Scalar  Scalar type of the returned system.
+    ///
+    template <typename Scalar>
+    LinearSystem<Scalar> load(size_t index) const;
+
+    ///
+    /// Zero-copy view of a `.bcsc` member. Throws std::runtime_error for other formats.
+    ///
+    /// @param[in]  index  Index of the member.
+    ///
+    MappedSystem system(size_t index) const;
+
+    ///
+    /// Zero-copy view of a `.bseq` member. Throws std::runtime_error for other formats.
+    ///
+    /// @param[in]  index  Index of the member.
+    ///
+    MappedSequence sequence(size_t index) const;
+
+private:
+    std::filesystem::path m_filename;
+    std::shared_ptr<const MappedFile> m_file;
+    PackHeader m_header;
+    std::vector<PackEntry> m_entries;
+    std::unordered_map<std::string, size_t> m_index;
+};
+
+///
+/// Writes a pack (`.bpack`) by appending files one at a time. Files are copied as they are, and
+/// summarized with `read_system_info()` for the table of members.
+///
+/// @code
+/// benchy::io::PackWriter writer("dataset.bpack");
+/// for (const auto& path : paths) {
+///     writer.add(path.lexically_relative(data_dir).generic_string(), path);
+/// }
+/// writer.finish();
+/// @endcode
+///
+class PackWriter
+{
+public:
+    ///
+    /// Creates the output file.
+    ///
+    /// @param[in]  filename  Output filename, should end with .bpack.
+    ///
+    explicit PackWriter(const std::filesystem::path& filename);
+
+    ///
+    /// Finishes the file if `finish()` was not called. Errors are logged, not thrown.
+    ///
+    ~PackWriter();
+
+    PackWriter(const PackWriter&) = delete;
+    PackWriter& operator=(const PackWriter&) = delete;
+
+    ///
+    /// Appends a file to the pack.
+    ///
+    /// @param[in]  name    Name of the member. Must be unique within the pack.
+    /// @param[in]  system  Path to a .bcsc, .zst or .bseq file.
+    ///
+    void add(const std::string& name, const std::filesystem::path& system);
+
+    ///
+    /// Writes the table of members and the header, and closes the file.
+    ///
+    void finish();
+
+    /// Number of members added so far.
+    size_t num_entries() const { return m_entries.size(); }
+
+private:
+    std::filesystem::path m_filename;
+    std::ofstream m_stream;
+    std::vector<PackEntry> m_entries;
+    std::unordered_set<std::string> m_names;
+    bool m_finished = false;
+};
+
+///
+/// Splits a path referring to a member of a pack, `<pack>.bpack/<name>`. The first component
+/// ending with `.bpack` is taken as the pack, without checking the file system.
+///
+/// @param[in]  path  Path to split.
+/// @param[out] pack  Path to the pack.
+/// @param[out] name  Name of the member, with forward slashes.
+///
+/// @return     Whether the path refers to a member of a pack.
+///
+bool split_pack_path(
+    const std::filesystem::path& path,
+    std::filesystem::path& pack,
+    std::string& name);
+
+///
+/// Opens a pack, sharing it with the other users of the same file. The pack is mapped and its
+/// table is read again once all previous users have released it.
+///
+/// This function is thread-safe.
+///
+/// @param[in]  filename  Path to the .bpack file.
+///
+/// @return     The opened pack.
+///
+std::shared_ptr<const MappedPack> open_pack(const std::filesystem::path& filename);
+
+} // namespace io
+} // namespace benchy
@@ -11,11 +11,28 @@
  */
 #pragma once
 
+// binary_format.h is expected next to this file when it is copied into another project
+#if __has_include(<benchy/io/binary_format.h>)
+    #include <benchy/io/binary_format.h>
+#else
+    #include "binary_format.h"
+#endif
+
 #include <Eigen/Sparse>
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace benchy {
 namespace io {
@@ -31,8 +48,8 @@ struct Problem
     /// Left-hand side sparse matrix.
     Eigen::SparseMatrix<Scalar> A;
 
-    /// Right-hand side dense matrix. To save multiple rhs, please save separate problems.
-    Eigen::VectorX<Scalar> b;
+    /// Right-hand side dense matrix, one column per rhs. A vector can be assigned directly.
+    Eigen::MatrixX<Scalar> b;
 
     /// Whether the sparse matrix A is supposed to be SPD.
     int is_symmetric_positive_definite = -1;
@@ -56,35 +73,12 @@ struct Problem
     std::string contact_email;
 };
 
-///
-/// Saves a linear system and associated metadata.
-///
-/// To save a specific linear system, you can use the following example code:
-/// @code
-/// benchy::io::Problem<double> problem;
-/// problem.A = A;
-/// problem.b = b;
-/// problem.is_symmetric_positive_definite = 1;
-/// problem.is_sequence_of_problems = 0;
-/// problem.dimension = 3;
-/// problem.description = "Linear elasticity simulation in 3D";
-/// problem.dataset_name = "squishy_cube";
-/// problem.project_url = "https://github.com/polyfem/polyfem/";
-/// problem.contact_email = "my.name@gmail.com";
-/// benchy::io::save_problem("my_problem.json", problem);
-/// @endcode
-///
-/// @param[in]  filename  Filename to save the problem to.
-/// @param[in]  problem   Container describing the linear system to save.
-///
-/// @tparam     Scalar    Problem scalar type (float or double).
-///
-/// @return     True if the problem was successfully saved, False otherwise.
-///
+namespace detail {
+
+/// Checks that a problem can be saved, reporting the first issue found on stderr.
 template <typename Scalar>
-bool save_problem(const std::string& filename, const Problem<Scalar>& problem)
+bool check_problem(const Problem<Scalar>& problem)
 {
-    // Check that all metadata is set
     if (problem.A.size() == 0) {
         std::cerr << "Matrix A is empty" << std::endl;
         return false;
@@ -93,6 +87,10 @@ bool save_problem(const std::string& filename, const Problem<Scalar>& problem)
         std::cerr << "Matrix b is empty" << std::endl;
         return false;
     }
+    if (problem.b.rows() != problem.A.rows()) {
+        std::cerr << "Matrix b must have as many rows as A" << std::endl;
+        return false;
+    }
     if (problem.is_symmetric_positive_definite != 0 &&
         problem.is_symmetric_positive_definite != 1) {
         std::cerr << "problem.is_symmetric_positive_definite must be 0 or 1" << std::endl;
@@ -122,57 +120,469 @@ bool save_problem(const std::string& filename, const Problem<Scalar>& problem)
         std::cerr << "problem.contact_email is empty" << std::endl;
         return false;
     }
+    return true;
+}
+
+/// Quotes a string as a json string literal.
+inline std::string quote_json(const std::string& str)
+{
+    std::string res = "\"";
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            res += '\\';
+            res += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+            res += code;
+        } else {
+            res += c;
+        }
+    }
+    return res + "\"";
+}
+
+/// Metadata of a problem as a json object, with the format version stored under `version_key`.
+template <typename Scalar>
+std::string problem_metadata(const Problem<Scalar>& problem, const char* version_key)
+{
+    return std::string("{") +
+           "\"is_symmetric_positive_definite\": " +
+           std::to_string(problem.is_symmetric_positive_definite) + ", " +
+           "\"is_sequence_of_problems\": " + std::to_string(problem.is_sequence_of_problems) +
+           ", " + "\"dimension\": " + std::to_string(problem.dimension) + ", " +
+           "\"scalar_type\": \"" + (std::is_same<Scalar, float>::value ? "float" : "double") +
+           "\", " + "\"description\": " + quote_json(problem.description) + ", " +
+           "\"dataset_name\": " + quote_json(problem.dataset_name) + ", " +
+           "\"project_url\": " + quote_json(problem.project_url) + ", " +
+           "\"contact_email\": " + quote_json(problem.contact_email) + ", " + "\"" +
+           version_key + "\": " + std::to_string(2) + "}";
+}
+
+///
+/// Output buffer formatting numbers with `std::to_chars`, which is much faster than formatted
+/// insertions into a `std::ostream`. Data is written to the underlying stream in large blocks.
+///
+class TextWriter
+{
+public:
+    explicit TextWriter(std::ostream& out)
+        : m_out(out)
+        , m_buffer(1 << 20)
+    {}
+
+    ~TextWriter() { flush(); }
+
+    void write(const std::string& str)
+    {
+        reserve(str.size());
+        std::copy(str.begin(), str.end(), m_buffer.data() + m_size);
+        m_size += str.size();
+    }
+
+    void write(const char* str) { write(std::string(str)); }
+
+    template <typename Integer>
+    void write_integer(Integer value)
+    {
+        reserve(32);
+        char* ptr = m_buffer.data() + m_size;
+        m_size = std::to_chars(ptr, ptr + 32, value).ptr - m_buffer.data();
+    }
+
+    /// Writes a scalar in the same format as `std::hexfloat`, e.g. "-0x1.8p+1".
+    template <typename Scalar>
+    void write_hexfloat(Scalar value)
+    {
+        reserve(64);
+        char* ptr = m_buffer.data() + m_size;
+#if defined(__cpp_lib_to_chars)
+        if (std::signbit(value)) {
+            *ptr++ = '-';
+            value = -value;
+        }
+        if (std::isfinite(value)) {
+            *ptr++ = '0';
+            *ptr++ = 'x';
+        }
+        ptr = std::to_chars(ptr, ptr + 60, value, std::chars_format::hex).ptr;
+#else
+        ptr += std::snprintf(ptr, 64, "%a", static_cast<double>(value));
+#endif
+        m_size = ptr - m_buffer.data();
+    }
+
+    void flush()
+    {
+        m_out.write(m_buffer.data(), m_size);
+        m_size = 0;
+    }
+
+private:
+    void reserve(size_t size)
+    {
+        if (m_size + size > m_buffer.size()) {
+            flush();
+            if (size > m_buffer.size()) {
+                m_buffer.resize(size);
+            }
+        }
+    }
+
+private:
+    std::ostream& m_out;
+    std::vector<char> m_buffer;
+    size_t m_size = 0;
+};
+
+/// Writes zeros up to the given offset, then the given data.
+inline void write_binary_section(
+    std::ostream& out,
+    uint64_t& pos,
+    uint64_t offset,
+    const void* data,
+    uint64_t size)
+{
+    static const char zeros[kBinaryAlignment] = {};
+    out.write(zeros, offset - pos);
+    out.write(reinterpret_cast<const char*>(data), size);
+    pos = offset + size;
+}
+
+} // namespace detail
+
+///
+/// Saves a linear system and associated metadata as a json text file.
+///
+/// To save a specific linear system, you can use the following example code:
+/// @code
+/// benchy::io::Problem<double> problem;
+/// problem.A = A;
+/// problem.b = b;
+/// problem.is_symmetric_positive_definite = 1;
+/// problem.is_sequence_of_problems = 0;
+/// problem.dimension = 3;
+/// problem.description = "Linear elasticity simulation in 3D";
+/// problem.dataset_name = "squishy_cube";
+/// problem.project_url = "https://github.com/polyfem/polyfem/";
+/// problem.contact_email = "my.name@gmail.com";
+/// benchy::io::save_problem("my_problem.json", problem);
+/// @endcode
+///
+/// If the filename ends with `.bcsc`, the problem is saved with `save_problem_binary()` instead.
+///
+/// @param[in]  filename  Filename to save the problem to.
+/// @param[in]  problem   Container describing the linear system to save.
+///
+/// @tparam     Scalar    Problem scalar type (float or double).
+///
+/// @return     True if the problem was successfully saved, False otherwise.
+///
+template <typename Scalar>
+bool save_problem(const std::string& filename, const Problem<Scalar>& problem);
+
+///
+/// Saves a linear system and associated metadata in the binary CSC container format (`.bcsc`).
+///
+/// The CSC arrays of A and the rhs are written to disk as-is, without any conversion to text,
+/// which makes this the fastest way to dump a system from a running application. The output can
+/// be used directly by the benchmark, or converted with `benchy_convert`.
+///
+/// @param[in]  filename  Filename to save the problem to (should end with `.bcsc`).
+/// @param[in]  problem   Container describing the linear system to save.
+///
+/// @tparam     Scalar    Problem scalar type (float or double).
+///
+/// @return     True if the problem was successfully saved, False otherwise.
+///
+template <typename Scalar>
+bool save_problem_binary(const std::string& filename, const Problem<Scalar>& problem)
+{
     static_assert(
         std::is_same<Scalar, float>::value || std::is_same<Scalar, double>::value,
         "Scalar must be float or double");
+    static_assert(
+        sizeof(typename Eigen::SparseMatrix<Scalar>::StorageIndex) == sizeof(int32_t),
+        "Unexpected sparse index size");
+    if (!detail::check_problem(problem)) {
+        return false;
+    }
 
-    // Write problem to file
-    std::ofstream out(filename, std::ios::out);
+    std::ofstream out(filename, std::ios::out | std::ios::binary);
     if (!out) {
         std::cerr << "Could not open file " << filename << std::endl;
         return false;
     }
 
-    std::vector<Eigen::Triplet<Scalar>> triplets;
-    triplets.reserve(problem.A.nonZeros());
-    for (int j = 0; j < problem.A.outerSize(); ++j) {
-        for (typename Eigen::SparseMatrix<Scalar>::InnerIterator it(problem.A, j); it; ++it) {
-            triplets.emplace_back(it.row(), it.col(), it.value());
+    const auto& A = problem.A;
+    const std::string metadata = detail::problem_metadata(problem, "version_number");
+    BinaryHeader header = {};
+    header.scalar_size = sizeof(Scalar);
+    header.index_size = sizeof(int32_t);
+    header.rows = A.rows();
+    header.cols = A.cols();
+    header.nnz = A.nonZeros();
+    header.b_rows = problem.b.rows();
+    header.b_cols = problem.b.cols();
+    header.metadata_size = metadata.size();
+    layout_binary_header(header);
+
+    uint64_t pos = 0;
+    detail::write_binary_section(out, pos, 0, &header, sizeof(header));
+    detail::write_binary_section(
+        out,
+        pos,
+        header.metadata_offset,
+        metadata.data(),
+        metadata.size());
+    if (A.isCompressed()) {
+        detail::write_binary_section(
+            out,
+            pos,
+            header.outer_offset,
+            A.outerIndexPtr(),
+            (header.cols + 1) * sizeof(int32_t));
+        detail::write_binary_section(
+            out,
+            pos,
+            header.inner_offset,
+            A.innerIndexPtr(),
+            header.nnz * sizeof(int32_t));
+        detail::write_binary_section(
+            out,
+            pos,
+            header.values_offset,
+            A.valuePtr(),
+            header.nnz * sizeof(Scalar));
+    } else {
+        // Skip the free space left at the end of each column
+        std::vector<int32_t> outer(A.cols() + 1, 0);
+        for (Eigen::Index j = 0; j < A.cols(); ++j) {
+            outer[j + 1] = outer[j] + A.innerNonZeroPtr()[j];
+        }
+        detail::write_binary_section(
+            out,
+            pos,
+            header.outer_offset,
+            outer.data(),
+            outer.size() * sizeof(int32_t));
+        detail::write_binary_section(out, pos, header.inner_offset, nullptr, 0);
+        for (Eigen::Index j = 0; j < A.cols(); ++j) {
+            const auto start = A.outerIndexPtr()[j];
+            detail::write_binary_section(
+                out,
+                pos,
+                pos,
+                A.innerIndexPtr() + start,
+                A.innerNonZeroPtr()[j] * sizeof(int32_t));
+        }
+        detail::write_binary_section(out, pos, header.values_offset, nullptr, 0);
+        for (Eigen::Index j = 0; j < A.cols(); ++j) {
+            const auto start = A.outerIndexPtr()[j];
+            detail::write_binary_section(
+                out,
+                pos,
+                pos,
+                A.valuePtr() + start,
+                A.innerNonZeroPtr()[j] * sizeof(Scalar));
         }
     }
+    detail::write_binary_section(
+        out,
+        pos,
+        header.b_offset,
+        problem.b.data(),
+        header.b_rows * header.b_cols * sizeof(Scalar));
 
-    out << std::hexfloat << std::boolalpha;
-    out << "{\"metadata\": {"
-        << "\"is_symmetric_positive_definite\": " << problem.is_symmetric_positive_definite << ", "
-        << "\"is_sequence_of_problems\": " << problem.is_sequence_of_problems << ", "
-        << "\"dimension\": " << problem.dimension << ", "
-        << "\"scalar_type\": \"" << (std::is_same<Scalar, float>::value ? "float" : "double")
-        << "\", "
-        << "\"description\": \"" << problem.description << "\", "
-        << "\"dataset_name\": \"" << problem.dataset_name << "\", "
-        << "\"project_url\": \"" << problem.project_url << "\", "
-        << "\"contact_email\": \"" << problem.contact_email << "\", "
-        << "\"raw_dump_version\": " << 2 << "}, \"A\":{ \"rows\":" << problem.A.rows()
-        << ", \"cols\":" << problem.A.cols() << ", \"nnz\":" << problem.A.nonZeros()
-        << ", \"triplets\":[";
-    for (int i = 0; i < triplets.size(); ++i) {
-        out << "[" << triplets[i].row() << ", " << triplets[i].col() << ", \""
-            << triplets[i].value() << "\"]";
-        if (i < triplets.size() - 1) {
-            out << ", ";
-        }
+    if (!out) {
+        std::cerr << "Could not write file " << filename << std::endl;
+        return false;
     }
-    out << "]}, \"b\":[";
-    for (int i = 0; i < problem.b.size(); ++i) {
-        out << "\"" << problem.b(i) << "\"";
-        if (i < problem.b.size() - 1) {
-            out << ", ";
+    return true;
+}
+
+template <typename Scalar>
+bool save_problem(const std::string& filename, const Problem<Scalar>& problem)
+{
+    static_assert(
+        std::is_same<Scalar, float>::value || std::is_same<Scalar, double>::value,
+        "Scalar must be float or double");
+    const std::string binary_ext = ".bcsc";
+    if (filename.size() >= binary_ext.size() &&
+        filename.compare(filename.size() - binary_ext.size(), binary_ext.size(), binary_ext) ==
+            0) {
+        return save_problem_binary(filename, problem);
+    }
+    if (!detail::check_problem(problem)) {
+        return false;
+    }
+
+    // Write problem to file
+    std::ofstream out(filename, std::ios::out | std::ios::binary);
+    if (!out) {
+        std::cerr << "Could not open file " << filename << std::endl;
+        return false;
+    }
+
+    {
+        detail::TextWriter writer(out);
+        writer.write("{\"metadata\": ");
+        writer.write(detail::problem_metadata(problem, "raw_dump_version"));
+        writer.write(", \"A\":{ \"rows\":");
+        writer.write_integer(problem.A.rows());
+        writer.write(", \"cols\":");
+        writer.write_integer(problem.A.cols());
+        writer.write(", \"nnz\":");
+        writer.write_integer(problem.A.nonZeros());
+        writer.write(", \"triplets\":[");
+        bool first = true;
+        for (int j = 0; j < problem.A.outerSize(); ++j) {
+            for (typename Eigen::SparseMatrix<Scalar>::InnerIterator it(problem.A, j); it; ++it) {
+                writer.write(first ? "[" : ", [");
+                writer.write_integer(it.row());
+                writer.write(", ");
+                writer.write_integer(it.col());
+                writer.write(", \"");
+                writer.write_hexfloat(it.value());
+                writer.write("\"]");
+                first = false;
+            }
         }
+        writer.write("]}, \"b\":[");
+        // A single rhs is written as a flat array, multiple rhs row by row
+        const bool nested = problem.b.cols() > 1;
+        for (Eigen::Index i = 0; i < problem.b.rows(); ++i) {
+            if (nested) {
+                writer.write(i == 0 ? "[" : ", [");
+            }
+            for (Eigen::Index j = 0; j < problem.b.cols(); ++j) {
+                writer.write(j == 0 && (nested || i == 0) ? "\"" : ", \"");
+                writer.write_hexfloat(problem.b(i, j));
+                writer.write("\"");
+            }
+            if (nested) {
+                writer.write("]");
+            }
+        }
+        writer.write("]}");
     }
-    out << "]}";
 
+    if (!out) {
+        std::cerr << "Could not write file " << filename << std::endl;
+        return false;
+    }
     return true;
 }
 
+///
+/// Saves problems on a background thread, so that serialization and disk I/O are kept off the
+/// critical path of the calling application (e.g. a simulation dumping every Newton iteration).
+///
+/// Problems are taken by value: move them into `save()` to avoid a copy. At most `max_pending`
+/// problems are queued in memory; beyond that, `save()` blocks until the writer catches up.
+///
+/// @code
+/// benchy::io::ProblemWriter<double> writer;
+/// for (int it = 0; it < num_iterations; ++it) {
+///     // ... assemble problem ...
+///     writer.save("newton_" + std::to_string(it) + ".bcsc", problem);
+/// }
+/// bool success = writer.wait();
+/// @endcode
+///
+/// @tparam     Scalar    Problem scalar type (float or double).
+///
+template <typename Scalar>
+class ProblemWriter
+{
+public:
+    ///
+    /// Starts the background thread.
+    ///
+    /// @param[in]  max_pending  Maximum number of problems waiting to be written.
+    ///
+    explicit ProblemWriter(size_t max_pending = 2)
+        : m_max_pending(std::max<size_t>(max_pending, 1))
+        , m_thread([this]() { run(); })
+    {}
+
+    /// Writes all pending problems and stops the background thread.
+    ~ProblemWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    ProblemWriter(const ProblemWriter&) = delete;
+    ProblemWriter& operator=(const ProblemWriter&) = delete;
+
+    ///
+    /// Queues a problem to be saved with `save_problem()`.
+    ///
+    /// @param[in]  filename  Filename to save the problem to (.json or .bcsc).
+    /// @param[in]  problem   Container describing the linear system to save.
+    ///
+    void save(std::string filename, Problem<Scalar> problem)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]() { return m_queue.size() < m_max_pending; });
+        m_queue.emplace_back(std::move(filename), std::move(problem));
+        lock.unlock();
+        m_cv.notify_all();
+    }
+
+    ///
+    /// Waits until all queued problems have been written.
+    ///
+    /// @return     True if all problems saved since the last call were successfully saved.
+    ///
+    bool wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]() { return m_queue.empty() && !m_busy; });
+        const bool success = m_success;
+        m_success = true;
+        return success;
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_cv.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return;
+            }
+            auto job = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+            lock.unlock();
+            m_cv.notify_all();
+
+            const bool success = save_problem(job.first, job.second);
+
+            lock.lock();
+            m_busy = false;
+            m_success = m_success && success;
+            m_cv.notify_all();
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::pair<std::string, Problem<Scalar>>> m_queue;
+    size_t m_max_pending;
+    bool m_busy = false;
+    bool m_stop = false;
+    bool m_success = true;
+    std::thread m_thread;
+};
+
 } // namespace io
 } // namespace benchy
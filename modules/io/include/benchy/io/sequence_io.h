@@ -0,0 +1,290 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <benchy/io/binary_format.h>
+#include <benchy/io/linear_system.h>
+#include <benchy/io/mapped_file.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace benchy {
+namespace io {
+
+///
+/// Sequence of linear systems sharing the same sparsity pattern, stored in a memory-mapped
+/// container (`.bseq`).
+///
+/// This is typically the sequence of systems solved by the Newton iterations or time steps of a
+/// simulation. The pattern is stored once, and every step only stores the values of A and the rhs
+/// b. All arrays are exposed as Eigen maps pointing directly into the file mapping.
+///
+/// @code
+/// benchy::io::MappedSequence sequence("my_simulation.bseq");
+/// benchy::io::LinearSystem<double> system;
+/// for (size_t k = 0; k < sequence.num_steps(); ++k) {
+///     sequence.read_step(k, system); // only copies the values after the first step
+///     solver->factorize(system.A);
+/// }
+/// @endcode
+///
+class MappedSequence
+{
+public:
+    template <typename Scalar>
+    using SparseMap = Eigen::Map<const Eigen::SparseMatrix<Scalar, Eigen::ColMajor, int32_t>>;
+
+    template <typename Scalar>
+    using VectorMap = Eigen::Map<const Eigen::VectorX<Scalar>>;
+
+    template <typename Scalar>
+    using DenseMap = Eigen::Map<const Eigen::MatrixX<Scalar>>;
+
+    ///
+    /// Maps a sequence container from disk.
+    ///
+    /// @param[in]  filename  Path to the .bseq file.
+    ///
+    explicit MappedSequence(const std::filesystem::path& filename);
+
+    ///
+    /// Views a sequence container stored inside an existing file mapping.
+    ///
+    /// @param[in]  file    Mapped file holding the container.
+    /// @param[in]  offset  Byte offset of the container inside the file. Must be aligned to
+    ///                     `kBinaryAlignment`.
+    ///
+    MappedSequence(std::shared_ptr<const MappedFile> file, size_t offset);
+
+    /// Header of the container.
+    const SequenceHeader& header() const { return m_header; }
+
+    /// Metadata shared by all steps.
+    const nlohmann::json& metadata() const { return m_metadata; }
+
+    /// Number of steps in the sequence.
+    size_t num_steps() const { return static_cast<size_t>(m_header.num_steps); }
+
+    /// Whether the arrays are stored in single precision.
+    bool is_float() const { return m_header.scalar_size == sizeof(float); }
+
+    /// Outer index array of the shared pattern (`cols + 1` entries).
+    const int32_t* outer_index() const { return section<int32_t>(m_header.outer_offset); }
+
+    /// Inner index array of the shared pattern (`nnz` entries).
+    const int32_t* inner_index() const { return section<int32_t>(m_header.inner_offset); }
+
+    ///
+    /// Zero-copy view of the values of A at a given step, in the order of the shared pattern.
+    ///
+    /// @param[in]  step    Index of the step.
+    ///
+    /// @tparam     Scalar  Must match the scalar type stored in the file.
+    ///
+    template <typename Scalar>
+    VectorMap<Scalar> values(size_t step) const
+    {
+        check_scalar<Scalar>();
+        return VectorMap<Scalar>(section<Scalar>(step_offset(step)), m_header.nnz);
+    }
+
+    ///
+    /// Zero-copy view of the sparse matrix A at a given step.
+    ///
+    /// @param[in]  step    Index of the step.
+    ///
+    /// @tparam     Scalar  Must match the scalar type stored in the file.
+    ///
+    template <typename Scalar>
+    SparseMap<Scalar> A(size_t step) const
+    {
+        check_scalar<Scalar>();
+        return SparseMap<Scalar>(
+            m_header.rows,
+            m_header.cols,
+            m_header.nnz,
+            outer_index(),
+            inner_index(),
+            section<Scalar>(step_offset(step)));
+    }
+
+    ///
+    /// Zero-copy view of the dense rhs b at a given step.
+    ///
+    /// @param[in]  step    Index of the step.
+    ///
+    /// @tparam     Scalar  Must match the scalar type stored in the file.
+    ///
+    template <typename Scalar>
+    DenseMap<Scalar> b(size_t step) const
+    {
+        check_scalar<Scalar>();
+        return DenseMap<Scalar>(
+            section<Scalar>(step_offset(step) + m_header.step_b_offset),
+            m_header.b_rows,
+            m_header.b_cols);
+    }
+
+    ///
+    /// Copies a step into an owning linear system, converting it to `Scalar` if needed.
+    ///
+    /// If `system` already holds a compressed matrix with the shared pattern (for instance because
+    /// it was filled from another step of this sequence), only the values are copied. The pattern
+    /// is checked by comparing the index arrays, so `system` may come from any source.
+    ///
+    /// @param[in]     step    Index of the step.
+    /// @param[in,out] system  System receiving the step.
+    ///
+    /// @tparam        Scalar  Scalar type of the system.
+    ///
+    template <typename Scalar>
+    void read_step(size_t step, LinearSystem<Scalar>& system) const;
+
+private:
+    void parse();
+
+    uint64_t step_offset(size_t step) const
+    {
+        if (step >= num_steps()) {
+            throw std::out_of_range(
+                "Step " + std::to_string(step) + " is out of range (" +
+                std::to_string(num_steps()) + " steps)");
+        }
+        return m_header.steps_offset + step * m_header.step_size;
+    }
+
+    template <typename Scalar>
+    void check_scalar() const
+    {
+        if (m_header.scalar_size != sizeof(Scalar)) {
+            throw std::runtime_error(
+                "Scalar size mismatch: file stores " + std::to_string(m_header.scalar_size) +
+                "-byte scalars");
+        }
+    }
+
+    template <typename T>
+    const T* section(uint64_t offset) const
+    {
+        return reinterpret_cast<const T*>(m_base + offset);
+    }
+
+private:
+    std::shared_ptr<const MappedFile> m_file;
+    const std::byte* m_base = nullptr;
+    size_t m_size = 0;
+    SequenceHeader m_header;
+    nlohmann::json m_metadata;
+};
+
+///
+/// Writes a sequence container (`.bseq`) one step at a time, so that a simulation can save its
+/// systems as they are produced without keeping them in memory.
+///
+/// The first step fixes the sparsity pattern, the size of b and the metadata of the sequence.
+/// Every following step must have the same pattern and rhs size. The metadata is completed with
+/// `"is_sequence_of_problems": 1` and the number of steps when the file is finished.
+///
+/// @code
+/// benchy::io::SequenceWriter<double> writer("my_simulation.bseq");
+/// for (int k = 0; k < num_steps; ++k) {
+///     writer.add(assemble_system(k));
+/// }
+/// writer.finish();
+/// @endcode
+///
+/// @tparam     Scalar  Scalar type of the stored values (float or double).
+///
+template <typename Scalar>
+class SequenceWriter
+{
+public:
+    ///
+    /// Creates the output file.
+    ///
+    /// @param[in]  filename  Output filename, should end with .bseq.
+    ///
+    explicit SequenceWriter(const std::filesystem::path& filename);
+
+    ///
+    /// Finishes the file if `finish()` was not called. Errors are logged, not thrown.
+    ///
+    ~SequenceWriter();
+
+    SequenceWriter(const SequenceWriter&) = delete;
+    SequenceWriter& operator=(const SequenceWriter&) = delete;
+
+    ///
+    /// Appends a step to the sequence.
+    ///
+    /// @param[in]  system  Linear system of the step. Its metadata is only used for the first step.
+    ///
+    void add(const LinearSystem<Scalar>& system);
+
+    ///
+    /// Writes the metadata and the header, and closes the file. A sequence must have at least one
+    /// step.
+    ///
+    void finish();
+
+    /// Number of steps added so far.
+    size_t num_steps() const { return static_cast<size_t>(m_header.num_steps); }
+
+private:
+    std::filesystem::path m_filename;
+    std::ofstream m_stream;
+    SequenceHeader m_header = {};
+    nlohmann::json m_metadata;
+    std::vector<int32_t> m_outer;
+    std::vector<int32_t> m_inner;
+    bool m_finished = false;
+};
+
+///
+/// Saves a sequence of linear systems sharing the same sparsity pattern as a sequence container
+/// (`.bseq`). See `SequenceWriter`.
+///
+/// @param[in]  filename  Output filename.
+/// @param[in]  steps     Linear systems of the sequence, all with the same pattern.
+///
+/// @tparam     Scalar    Problem scalar type (float or double).
+///
+template <typename Scalar>
+void save_sequence(
+    const std::filesystem::path& filename,
+    const std::vector<LinearSystem<Scalar>>& steps);
+
+///
+/// Loads a single step of a sequence container into an owning linear system.
+///
+/// @param[in]  filename  Path to the .bseq file.
+/// @param[in]  step      Index of the step.
+///
+/// @tparam     Scalar    Scalar type of the returned system.
+///
+/// @return     The loaded linear system, with the metadata of the sequence.
+///
+template <typename Scalar>
+LinearSystem<Scalar> load_sequence_step(const std::filesystem::path& filename, size_t step = 0);
+
+} // namespace io
+} // namespace benchy
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <benchy/io/linear_system.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <nlohmann/json.hpp>
+
+namespace benchy {
+namespace io {
+
+///
+/// Part of a symmetric matrix that is actually stored.
+///
+/// SPD systems are usually stored as a single triangle (including the diagonal), which is tagged
+/// in the metadata as `"stored_triangle": "lower"` or `"upper"`. Systems without this tag store
+/// the full matrix.
+///
+enum class StoredTriangle { Full, Lower, Upper };
+
+///
+/// Reads the stored triangle from the metadata of a system.
+///
+/// @param[in]  metadata  Problem metadata.
+///
+/// @return     The stored triangle, `Full` if the metadata has no "stored_triangle" entry.
+///
+StoredTriangle stored_triangle(const nlohmann::json& metadata);
+
+///
+/// Keeps a single triangle of the matrix of an SPD system, and tags it in the metadata.
+///
+/// Systems that are not flagged as SPD (`is_symmetric_positive_definite == 1`), or whose matrix
+/// is not exactly symmetric, are left untouched.
+///
+/// @param[in,out] system    Linear system to convert.
+/// @param[in]     triangle  Triangle to keep (Lower or Upper).
+///
+/// @tparam        Scalar    Scalar type of the system.
+///
+/// @return        True if the system now stores a single triangle.
+///
+template <typename Scalar>
+bool make_half_storage(
+    LinearSystem<Scalar>& system,
+    StoredTriangle triangle = StoredTriangle::Lower);
+
+///
+/// Expands a system storing a single triangle back to the full matrix, and removes the tag from
+/// the metadata. Does nothing if the full matrix is already stored.
+///
+/// @param[in,out] system  Linear system to convert.
+///
+/// @tparam        Scalar  Scalar type of the system.
+///
+template <typename Scalar>
+void make_full_storage(LinearSystem<Scalar>& system);
+
+///
+/// Converts between storages of a symmetric matrix.
+///
+/// @param[in]  A     Matrix stored as `from`.
+/// @param[in]  from  Storage of A.
+/// @param[in]  to    Requested storage.
+///
+/// @tparam     Scalar  Scalar type of the matrix. `int` is supported too, to convert a pattern
+///                     holding the indices of the values.
+///
+/// @return     The matrix stored as `to`.
+///
+template <typename Scalar>
+Eigen::SparseMatrix<Scalar, Eigen::ColMajor> convert_storage(
+    const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A,
+    StoredTriangle from,
+    StoredTriangle to);
+
+///
+/// Number of nonzeros of the full matrix, when only one triangle is stored.
+///
+/// @param[in]  A         Stored matrix.
+/// @param[in]  triangle  Storage of A.
+///
+/// @tparam     Scalar    Scalar type of the matrix.
+///
+/// @return     Number of nonzeros of the full symmetric matrix.
+///
+template <typename Scalar>
+Eigen::Index full_nonzeros(
+    const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A,
+    StoredTriangle triangle);
+
+///
+/// Computes the product of the full matrix with a dense vector, when only one triangle is stored.
+///
+/// @param[in]  A         Stored matrix.
+/// @param[in]  triangle  Storage of A.
+/// @param[in]  x         Dense vector.
+///
+/// @tparam     Scalar    Scalar type of the matrix.
+///
+/// @return     The product `A x`.
+///
+template <typename Scalar>
+Eigen::VectorX<Scalar> multiply(
+    const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A,
+    StoredTriangle triangle,
+    const Eigen::VectorX<Scalar>& x);
+
+} // namespace io
+} // namespace benchy
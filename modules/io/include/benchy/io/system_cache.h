@@ -0,0 +1,166 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <benchy/io/linear_system.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace benchy {
+namespace io {
+
+///
+/// Least-recently-used cache of decoded linear systems, keyed by path.
+///
+/// Systems are shared as immutable objects, so any number of users can borrow the same system
+/// without copying it. The cache holds systems within a budget in bytes and/or in number of
+/// entries, and releases the least recently used systems first. A system is never released
+/// while it is the most recently used one, even if it alone exceeds the budget, and systems
+/// still referenced by a user stay alive until the last reference is dropped.
+///
+/// Systems can also be decoded ahead of time on a background thread with `prefetch()`, as long
+/// as this fits in the budget.
+///
+/// All methods are thread-safe.
+///
+/// @code
+/// benchy::io::SystemCache<double> cache(size_t(4) << 30);
+/// auto system = cache.get(paths[i]);
+/// cache.prefetch(paths[i + 1]);
+/// solver->analyzePattern(system->A, system->A.rows());
+/// @endcode
+///
+/// @tparam     Scalar  Scalar type of the cached systems.
+///
+template <typename Scalar>
+class SystemCache
+{
+public:
+    using SystemPtr = std::shared_ptr<const LinearSystem<Scalar>>;
+
+    ///
+    /// Creates an empty cache.
+    ///
+    /// @param[in]  max_bytes    Maximum memory used by the cached systems, 0 for no limit.
+    /// @param[in]  max_entries  Maximum number of cached systems, 0 for no limit.
+    ///
+    explicit SystemCache(size_t max_bytes = 0, size_t max_entries = 0);
+
+    ///
+    /// Waits for the pending loads and releases all systems.
+    ///
+    ~SystemCache();
+
+    SystemCache(const SystemCache&) = delete;
+    SystemCache& operator=(const SystemCache&) = delete;
+
+    ///
+    /// Returns a system, loading it on the calling thread if it is not cached. If the system is
+    /// being prefetched, waits for it instead.
+    ///
+    /// @param[in]  filename  Path to the system, in any format read by `load_system()`.
+    ///
+    /// @return     The loaded system. Exceptions thrown while loading it are rethrown here, and the
+    ///             failure is not cached.
+    ///
+    SystemPtr get(const std::filesystem::path& filename);
+
+    ///
+    /// Starts loading a system on a background thread, unless it is already cached or there is no
+    /// room left in the budget.
+    ///
+    /// @param[in]  filename  Path to the system, in any format read by `load_system()`.
+    ///
+    void prefetch(const std::filesystem::path& filename);
+
+    ///
+    /// Waits for the systems being prefetched, so that no background load runs past this call
+    /// until the next `prefetch()`. Loads started by `get()` on other threads are not waited for.
+    ///
+    void wait_pending();
+
+    ///
+    /// Releases all systems, waiting for pending loads.
+    ///
+    void clear();
+
+    /// Number of cached systems, including the ones being loaded.
+    size_t size() const;
+
+    /// Memory used by the loaded systems, in bytes.
+    size_t num_bytes() const;
+
+    /// Number of calls to `get()` that found the system already loaded or being loaded.
+    size_t num_hits() const;
+
+    /// Number of calls to `get()` that had to load the system.
+    size_t num_misses() const;
+
+    /// Number of systems released to stay within the budget.
+    size_t num_evictions() const;
+
+private:
+    struct Entry
+    {
+        std::string key;
+        uint64_t id = 0;
+        std::shared_future<SystemPtr> system;
+        bool ready = false;
+        size_t num_bytes = 0;
+    };
+    using EntryIterator = typename std::list<Entry>::iterator;
+
+    /// Inserts a new most recently used entry. Requires m_mutex.
+    EntryIterator insert(std::string key, std::shared_future<SystemPtr> system);
+
+    /// Removes an entry. Requires m_mutex.
+    void erase(EntryIterator it);
+
+    /// Records the size of the systems that finished loading. Requires m_mutex.
+    void update_sizes();
+
+    ///
+    /// Releases loaded systems, from least to most recently used, until the cache holds at most
+    /// `max_entries` systems and `max_bytes` bytes (0 for no limit). The most recently used
+    /// system is kept. Requires m_mutex.
+    ///
+    /// @return     Whether the cache fits within the requested limits.
+    ///
+    bool evict(size_t max_entries, size_t max_bytes);
+
+    const size_t m_max_bytes;
+    const size_t m_max_entries;
+
+    mutable std::mutex m_mutex;
+
+    /// Cached systems, from least to most recently used.
+    std::list<Entry> m_entries;
+    std::unordered_map<std::string, EntryIterator> m_index;
+
+    uint64_t m_next_id = 0;
+    size_t m_num_bytes = 0;
+    size_t m_num_hits = 0;
+    size_t m_num_misses = 0;
+    size_t m_num_evictions = 0;
+};
+
+} // namespace io
+} // namespace benchy
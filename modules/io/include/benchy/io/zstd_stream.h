@@ -0,0 +1,100 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+struct ZSTD_DCtx_s;
+
+namespace benchy {
+namespace io {
+
+///
+/// Stream buffer decompressing a zstd stream on the fly.
+///
+/// Compressed data is read from the source stream in fixed-size chunks and fed to the zstd
+/// streaming decoder, so only a few MB are held in memory regardless of the size of the archive.
+/// A reader thread, running for the lifetime of the buffer, reads the next chunk while the current
+/// one is being decompressed.
+/// Frames without a known content size (e.g. written by streaming compressors) and multiple
+/// concatenated frames are supported.
+///
+/// @code
+/// std::ifstream fl(filename, std::ios::in | std::ios::binary);
+/// benchy::io::ZstdInputBuffer buffer(fl);
+/// std::istream stream(&buffer);
+/// auto json = nlohmann::json::from_msgpack(stream);
+/// @endcode
+///
+class ZstdInputBuffer : public std::streambuf
+{
+public:
+    ///
+    /// Creates a decompressing stream buffer.
+    ///
+    /// @param[in]  source  Stream of compressed data. Must outlive this buffer.
+    ///
+    explicit ZstdInputBuffer(std::istream& source);
+
+    ~ZstdInputBuffer() override;
+
+    ZstdInputBuffer(const ZstdInputBuffer&) = delete;
+    ZstdInputBuffer& operator=(const ZstdInputBuffer&) = delete;
+
+protected:
+    int_type underflow() override;
+
+private:
+    /// Body of the reader thread, filling the read-ahead chunk whenever it was consumed.
+    void read_loop();
+
+    /// Waits for the read-ahead chunk and swaps it with the current one. Returns its size.
+    size_t next_chunk();
+
+private:
+    std::istream& m_source;
+    ZSTD_DCtx_s* m_dctx = nullptr;
+
+    /// Compressed chunk being decoded, and chunk being read ahead from the source.
+    std::vector<char> m_input;
+    std::vector<char> m_next_input;
+    size_t m_input_pos = 0;
+    size_t m_input_size = 0;
+
+    /// Decompressed data exposed through the get area.
+    std::vector<char> m_output;
+
+    /// Last return value of the decoder. Zero when the current frame is complete.
+    size_t m_frame_remaining = 0;
+
+    /// Whether the last decoding call filled the whole output buffer.
+    bool m_output_full = false;
+
+    /// State shared with the reader thread, guarded by m_mutex. The read-ahead chunk belongs to
+    /// the reader while m_next_ready is false, and to the decoder otherwise.
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_next_ready = false;
+    size_t m_next_size = 0;
+    std::exception_ptr m_read_error;
+    bool m_stop = false;
+    std::thread m_reader;
+};
+
+} // namespace io
+} // namespace benchy
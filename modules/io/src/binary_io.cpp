@@ -0,0 +1,196 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#include <benchy/io/binary_io.h>
+
+#include <benchy/io/symmetric_storage.h>
+
+#include <spdlog/spdlog.h>
+
+#include <fstream>
+#include <vector>
+
+namespace benchy {
+namespace io {
+
+namespace {
+
+void write_section(std::ofstream& fl, uint64_t offset, const void* data, uint64_t size)
+{
+    static const char zeros[kBinaryAlignment] = {};
+    const uint64_t pos = static_cast<uint64_t>(fl.tellp());
+    if (pos > offset) {
+        throw std::runtime_error("[save_binary] Overlapping sections");
+    }
+    fl.write(zeros, offset - pos);
+    fl.write(reinterpret_cast<const char*>(data), size);
+}
+
+} // namespace
+
+MappedSystem::MappedSystem(const std::filesystem::path& filename)
+    : m_file(std::make_shared<MappedFile>(filename))
+    , m_base(m_file->data())
+    , m_size(m_file->size())
+{
+    parse();
+}
+
+MappedSystem::MappedSystem(std::shared_ptr<const MappedFile> file, size_t offset)
+    : m_file(std::move(file))
+{
+    if (offset > m_file->size() || offset % kBinaryAlignment != 0) {
+        throw std::runtime_error(fmt::format("[MappedSystem] Invalid container offset {}", offset));
+    }
+    m_base = m_file->data() + offset;
+    m_size = m_file->size() - offset;
+    parse();
+}
+
+void MappedSystem::parse()
+{
+    if (m_size < sizeof(BinaryHeader)) {
+        throw std::runtime_error("[MappedSystem] File is too small to be a binary container");
+    }
+    std::memcpy(&m_header, m_base, sizeof(BinaryHeader));
+    if (std::memcmp(m_header.magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+        throw std::runtime_error("[MappedSystem] Not a binary container (invalid magic)");
+    }
+    if (m_header.byte_order != kBinaryByteOrder) {
+        throw std::runtime_error("[MappedSystem] Unsupported byte order");
+    }
+    if (m_header.version > kBinaryVersion) {
+        throw std::runtime_error(
+            fmt::format("[MappedSystem] Unsupported format version {}", m_header.version));
+    }
+    if (m_header.index_size != sizeof(int32_t) ||
+        (m_header.scalar_size != sizeof(float) && m_header.scalar_size != sizeof(double))) {
+        throw std::runtime_error("[MappedSystem] Unsupported scalar or index size");
+    }
+    // Every array of a valid container fits in the file, which bounds the dimensions well below
+    // the values that would make the layout of the sections overflow
+    const auto fits = [&](int64_t count) {
+        return count >= 0 && static_cast<uint64_t>(count) <= m_size;
+    };
+    if (m_header.rows < 0 || !fits(m_header.cols) || !fits(m_header.nnz) ||
+        !fits(m_header.b_rows) || !fits(m_header.b_cols) || m_header.metadata_size > m_size ||
+        (m_header.b_cols > 0 && static_cast<uint64_t>(m_header.b_rows) >
+                                    m_size / static_cast<uint64_t>(m_header.b_cols))) {
+        throw std::runtime_error("[MappedSystem] Corrupted or truncated binary container");
+    }
+    BinaryHeader expected = m_header;
+    const uint64_t file_size = layout_binary_header(expected);
+    if (expected.metadata_offset != m_header.metadata_offset ||
+        expected.outer_offset != m_header.outer_offset ||
+        expected.inner_offset != m_header.inner_offset ||
+        expected.values_offset != m_header.values_offset ||
+        expected.b_offset != m_header.b_offset || file_size > m_size) {
+        throw std::runtime_error("[MappedSystem] Corrupted or truncated binary container");
+    }
+    const char* metadata = reinterpret_cast<const char*>(m_base + m_header.metadata_offset);
+    m_metadata = nlohmann::json::parse(metadata, metadata + m_header.metadata_size);
+}
+
+template <typename Scalar>
+void save_binary(const std::filesystem::path& filename, const LinearSystem<Scalar>& system)
+{
+    static_assert(
+        std::is_same<Scalar, float>::value || std::is_same<Scalar, double>::value,
+        "Scalar must be float or double");
+    const auto ext = filename.extension();
+    if (ext != ".bcsc") {
+        spdlog::warn("Unexpected file extension: '{}' (should be .bcsc)", ext.string());
+    }
+
+    // Outer/inner arrays must be contiguous
+    const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>* A = &system.A;
+    Eigen::SparseMatrix<Scalar, Eigen::ColMajor> compressed;
+    if (!system.A.isCompressed()) {
+        compressed = system.A;
+        compressed.makeCompressed();
+        A = &compressed;
+    }
+
+    nlohmann::json metadata = system.metadata;
+    metadata["scalar_type"] = std::is_same<Scalar, float>::value ? "float" : "double";
+    const std::string metadata_str = metadata.dump();
+
+    BinaryHeader header = {};
+    switch (stored_triangle(metadata)) {
+    case StoredTriangle::Lower: header.flags = kBinaryFlagLowerTriangle; break;
+    case StoredTriangle::Upper: header.flags = kBinaryFlagUpperTriangle; break;
+    default: break;
+    }
+    header.scalar_size = sizeof(Scalar);
+    header.index_size = sizeof(int32_t);
+    header.rows = A->rows();
+    header.cols = A->cols();
+    header.nnz = A->nonZeros();
+    header.b_rows = system.b.rows();
+    header.b_cols = system.b.cols();
+    header.metadata_size = metadata_str.size();
+    layout_binary_header(header);
+
+    std::ofstream fl(filename, std::ios::out | std::ios::binary);
+    if (!fl.is_open()) {
+        throw std::runtime_error("file `" + filename.string() + "` could not be opened");
+    }
+    spdlog::info("Saving to disk: {}", filename.filename().string());
+    fl.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_section(fl, header.metadata_offset, metadata_str.data(), metadata_str.size());
+    write_section(
+        fl,
+        header.outer_offset,
+        A->outerIndexPtr(),
+        (header.cols + 1) * header.index_size);
+    write_section(fl, header.inner_offset, A->innerIndexPtr(), header.nnz * header.index_size);
+    write_section(fl, header.values_offset, A->valuePtr(), header.nnz * header.scalar_size);
+    write_section(
+        fl,
+        header.b_offset,
+        system.b.data(),
+        header.b_rows * header.b_cols * header.scalar_size);
+    if (!fl) {
+        throw std::runtime_error("file `" + filename.string() + "` could not be written");
+    }
+    spdlog::info("Done!");
+}
+
+template <typename Scalar>
+LinearSystem<Scalar> load_binary(const std::filesystem::path& filename)
+{
+    return load_binary<Scalar>(MappedSystem(filename));
+}
+
+template <typename Scalar>
+LinearSystem<Scalar> load_binary(const MappedSystem& mapped)
+{
+    LinearSystem<Scalar> system;
+    if (mapped.is_float()) {
+        system.A = mapped.A<float>().template cast<Scalar>();
+        system.b = mapped.b<float>().template cast<Scalar>();
+    } else {
+        system.A = mapped.A<double>().template cast<Scalar>();
+        system.b = mapped.b<double>().template cast<Scalar>();
+    }
+    system.metadata = mapped.metadata();
+    return system;
+}
+
+template void save_binary(const std::filesystem::path&, const LinearSystem<float>&);
+template void save_binary(const std::filesystem::path&, const LinearSystem<double>&);
+template LinearSystem<float> load_binary(const std::filesystem::path&);
+template LinearSystem<double> load_binary(const std::filesystem::path&);
+template LinearSystem<float> load_binary(const MappedSystem&);
+template LinearSystem<double> load_binary(const MappedSystem&);
+
+} // namespace io
+} // namespace benchy
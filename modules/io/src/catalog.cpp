@@ -0,0 +1,615 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#include <benchy/io/catalog.h>
+
+#include <benchy/io/binary_io.h>
+#include <benchy/io/hdf5_store.h>
+#include <benchy/io/index_codec.h>
+#include <benchy/io/load_problem.h>
+#include <benchy/io/pack_io.h>
+#include <benchy/io/sequence_io.h>
+#include <benchy/io/symmetric_storage.h>
+#include <benchy/io/zstd_stream.h>
+
+#include <spdlog/spdlog.h>
+
+#include <fstream>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace benchy {
+namespace io {
+
+namespace {
+
+template <typename StorageIndex>
+int64_t count_diagonal(const StorageIndex* outer, const StorageIndex* inner, int64_t cols)
+{
+    int64_t diagonal = 0;
+    for (int64_t j = 0; j < cols; ++j) {
+        for (StorageIndex k = outer[j]; k < outer[j + 1]; ++k) {
+            diagonal += (inner[k] == j);
+        }
+    }
+    return diagonal;
+}
+
+///
+/// Size and modification time of a system, used to detect changes. Members of a pack are stamped
+/// with those of their original file, as recorded in the table of the pack. Problems of an HDF5
+/// store are stamped with the store, so they are all read again when it changes.
+///
+std::pair<uint64_t, int64_t> file_stamp(const std::filesystem::path& system)
+{
+    std::filesystem::path pack;
+    std::string name;
+    if (split_pack_path(system, pack, name)) {
+        const auto mapped = open_pack(pack);
+        const auto& info = mapped->entry(mapped->index_of(name)).info;
+        return {info.file_size, info.mtime};
+    }
+#ifdef BENCHY_WITH_HDF5
+    std::filesystem::path store;
+    if (split_store_path(system, store, name)) {
+        return file_stamp(store);
+    }
+#endif
+    return {
+        std::filesystem::file_size(system),
+        std::filesystem::last_write_time(system).time_since_epoch().count()};
+}
+
+SystemInfo info_from_metadata(const nlohmann::json& metadata)
+{
+    SystemInfo info;
+    if (!metadata.is_object()) {
+        return info;
+    }
+    info.dataset_name = metadata.value("dataset_name", "");
+    info.dimension = metadata.value("dimension", 0);
+    info.is_symmetric_positive_definite = metadata.value("is_symmetric_positive_definite", -1);
+    return info;
+}
+
+#ifdef BENCHY_WITH_HDF5
+///
+/// Summary of a problem of an HDF5 store, read from its attributes. The pattern of A is only read
+/// to count the diagonal entries of matrices storing a single triangle.
+///
+SystemInfo read_store_info(const std::filesystem::path& store, const std::string& name)
+{
+    const auto opened = open_store(store);
+    const auto problem = opened->info(name);
+    SystemInfo info = info_from_metadata(problem.metadata);
+    info.rows = problem.rows;
+    info.cols = problem.cols;
+    info.nnz = problem.nnz;
+    info.num_steps = problem.num_steps;
+    if (stored_triangle(problem.metadata) != StoredTriangle::Full) {
+        const auto pattern = opened->read_pattern<float>(name);
+        const int64_t diagonal =
+            count_diagonal(pattern.outerIndexPtr(), pattern.innerIndexPtr(), problem.cols);
+        info.nnz = 2 * problem.nnz - diagonal;
+    }
+    std::tie(info.file_size, info.mtime) = file_stamp(store);
+    return info;
+}
+#endif
+
+///
+/// Builds a json DOM from SAX events, for the parts of a document a SAX handler wants to keep.
+///
+class JsonDomBuilder
+{
+public:
+    using json = nlohmann::json;
+
+    explicit JsonDomBuilder(json& root)
+        : m_root(root)
+    {}
+
+    bool null() { return add(nullptr) != nullptr; }
+    bool boolean(bool val) { return add(val) != nullptr; }
+    bool number_integer(json::number_integer_t val) { return add(val) != nullptr; }
+    bool number_unsigned(json::number_unsigned_t val) { return add(val) != nullptr; }
+    bool number_float(json::number_float_t val, const json::string_t&)
+    {
+        return add(val) != nullptr;
+    }
+    bool string(json::string_t& val) { return add(std::move(val)) != nullptr; }
+    bool binary(json::binary_t& val) { return add(std::move(val)) != nullptr; }
+
+    bool start_object(std::size_t)
+    {
+        m_stack.push_back(add(json::object()));
+        return true;
+    }
+    bool key(json::string_t& val)
+    {
+        m_key = std::move(val);
+        return true;
+    }
+    bool end_object()
+    {
+        m_stack.pop_back();
+        return true;
+    }
+    bool start_array(std::size_t)
+    {
+        m_stack.push_back(add(json::array()));
+        return true;
+    }
+    bool end_array()
+    {
+        m_stack.pop_back();
+        return true;
+    }
+
+private:
+    /// Adds a value to the innermost open container and returns it. Containers on the stack are
+    /// not modified until their children are closed, so the returned pointers stay valid.
+    json* add(json value)
+    {
+        if (m_stack.empty()) {
+            m_root = std::move(value);
+            return &m_root;
+        }
+        json& parent = *m_stack.back();
+        if (parent.is_array()) {
+            parent.push_back(std::move(value));
+            return &parent.back();
+        }
+        json& slot = parent[m_key];
+        slot = std::move(value);
+        return &slot;
+    }
+
+private:
+    json& m_root;
+    std::vector<json*> m_stack;
+    std::string m_key;
+};
+
+///
+/// SAX handler collecting the summary of a messagepack linear system.
+///
+/// Only the metadata is built as a json DOM. The values of A and b are decoded and dropped, and
+/// the row indices of A are kept until the column indices are read, to count the diagonal entries
+/// of matrices storing a single triangle. Matrices with compressed indices (see
+/// `EncodedSparseMatrix`) only keep their encoded indices, which are decoded if needed.
+///
+class SystemInfoSaxReader
+{
+public:
+    using json = nlohmann::json;
+
+    bool null() { return !in_metadata() || m_metadata_parser.null(); }
+    bool boolean(bool val) { return !in_metadata() || m_metadata_parser.boolean(val); }
+    bool number_integer(json::number_integer_t val)
+    {
+        return in_metadata() ? m_metadata_parser.number_integer(val) : number(val);
+    }
+    bool number_unsigned(json::number_unsigned_t val)
+    {
+        return in_metadata() ? m_metadata_parser.number_unsigned(val) : number(val);
+    }
+    bool number_float(json::number_float_t val, const json::string_t& s)
+    {
+        return in_metadata() ? m_metadata_parser.number_float(val, s) : number(val);
+    }
+    bool string(json::string_t& val) { return !in_metadata() || m_metadata_parser.string(val); }
+    bool binary(json::binary_t& val)
+    {
+        if (m_section == Section::EncodedMatrix) {
+            if (m_field == "outer") {
+                m_encoded_outer = std::move(static_cast<std::vector<uint8_t>&>(val));
+            } else if (m_field == "inner") {
+                m_encoded_inner = std::move(static_cast<std::vector<uint8_t>&>(val));
+            }
+            return true;
+        }
+        return !in_metadata() || m_metadata_parser.binary(val);
+    }
+
+    bool start_object(std::size_t elements)
+    {
+        if (m_section == Section::Root && m_depth == 0) {
+            m_depth = 1;
+            return true;
+        } else if (m_section == Section::Root && m_depth == 1) {
+            if (m_key == "metadata") {
+                m_section = Section::Metadata;
+            } else if (m_key == "A" || m_key == "lhs") {
+                m_section = Section::EncodedMatrix;
+            } else {
+                m_section = Section::Skip;
+            }
+        }
+        return enter(elements, true);
+    }
+
+    bool key(json::string_t& val)
+    {
+        if (m_section == Section::Root) {
+            m_key = val;
+        } else if (m_section == Section::Metadata) {
+            return m_metadata_parser.key(val);
+        } else if (m_section == Section::EncodedMatrix) {
+            m_field = val;
+        }
+        return true;
+    }
+
+    bool end_object() { return leave(true); }
+
+    bool start_array(std::size_t elements)
+    {
+        if (m_section == Section::Root && m_depth == 1) {
+            m_section = (m_key == "A" || m_key == "lhs") ? Section::Matrix : Section::Skip;
+            m_item = 0;
+        } else if (m_section == Section::Matrix && m_nesting == 1) {
+            if (m_item == 2) {
+                m_rows.reserve(elements);
+            }
+            m_k = 0;
+        }
+        return enter(elements, false);
+    }
+
+    bool end_array()
+    {
+        if (m_section == Section::Matrix && m_nesting == 2) {
+            if (m_item == 4) {
+                m_stored_nnz = m_k;
+            }
+            ++m_item;
+        }
+        return leave(false);
+    }
+
+    bool parse_error(std::size_t, const std::string&, const json::exception& ex)
+    {
+        throw std::runtime_error(ex.what());
+    }
+
+    SystemInfo info()
+    {
+        SystemInfo info = info_from_metadata(m_metadata);
+        info.rows = m_num_rows;
+        info.cols = m_num_cols;
+        info.nnz = m_stored_nnz;
+        if (stored_triangle(m_metadata) != StoredTriangle::Full) {
+            const int64_t diagonal = m_encoded_outer.empty() ? m_diagonal : encoded_diagonal();
+            info.nnz = 2 * m_stored_nnz - diagonal;
+        }
+        return info;
+    }
+
+private:
+    enum class Section { Root, Matrix, EncodedMatrix, Metadata, Skip };
+
+    int64_t encoded_diagonal() const
+    {
+        std::vector<uint32_t> counts(m_num_cols);
+        std::vector<uint32_t> deltas(m_stored_nnz);
+        decode_varints(m_encoded_outer.data(), m_encoded_outer.size(), m_num_cols, counts.data());
+        decode_varints(m_encoded_inner.data(), m_encoded_inner.size(), m_stored_nnz, deltas.data());
+        int64_t diagonal = 0;
+        int64_t k = 0;
+        for (int64_t j = 0; j < m_num_cols; ++j) {
+            int64_t row = 0;
+            for (uint32_t c = 0; c < counts[j]; ++c, ++k) {
+                row += deltas[k];
+                diagonal += (row == j);
+            }
+        }
+        return diagonal;
+    }
+
+    bool enter(std::size_t elements, bool object)
+    {
+        ++m_nesting;
+        if (m_section == Section::Metadata) {
+            return object ? m_metadata_parser.start_object(elements)
+                          : m_metadata_parser.start_array(elements);
+        }
+        return true;
+    }
+
+    bool leave(bool object)
+    {
+        if (m_section == Section::Root) {
+            m_depth = 0;
+            return true;
+        }
+        bool res = true;
+        if (m_section == Section::Metadata) {
+            res = object ? m_metadata_parser.end_object() : m_metadata_parser.end_array();
+        }
+        if (--m_nesting == 0) {
+            m_section = Section::Root;
+        }
+        return res;
+    }
+
+    template <typename T>
+    bool number(T val)
+    {
+        if (m_section == Section::EncodedMatrix) {
+            if (m_field == "rows") {
+                m_num_rows = static_cast<int64_t>(val);
+            } else if (m_field == "cols") {
+                m_num_cols = static_cast<int64_t>(val);
+            } else if (m_field == "nnz") {
+                m_stored_nnz = static_cast<int64_t>(val);
+            }
+        } else if (m_section == Section::Matrix) {
+            if (m_nesting == 1 && m_item < 2) {
+                (m_item++ == 0 ? m_num_rows : m_num_cols) = static_cast<int64_t>(val);
+            } else if (m_nesting == 2 && m_item == 2) {
+                m_rows.push_back(static_cast<int32_t>(val));
+            } else if (m_nesting == 2 && m_item == 3) {
+                const int64_t col = static_cast<int64_t>(val);
+                if (m_k < static_cast<int64_t>(m_rows.size()) && m_rows[m_k] == col) {
+                    ++m_diagonal;
+                }
+                ++m_k;
+            } else if (m_nesting == 2 && m_item == 4) {
+                ++m_k;
+            }
+        }
+        return true;
+    }
+
+    bool in_metadata() const { return m_section == Section::Metadata; }
+
+private:
+    Section m_section = Section::Root;
+    int m_depth = 0;
+    int m_nesting = 0;
+    std::string m_key;
+
+    // Matrix summary
+    int64_t m_num_rows = 0;
+    int64_t m_num_cols = 0;
+    int64_t m_stored_nnz = 0;
+    int64_t m_diagonal = 0;
+    int64_t m_item = 0;
+    int64_t m_k = 0;
+    std::vector<int32_t> m_rows;
+
+    // Matrix with compressed indices
+    std::string m_field;
+    std::vector<uint8_t> m_encoded_outer;
+    std::vector<uint8_t> m_encoded_inner;
+
+    // Metadata DOM
+    json m_metadata;
+    JsonDomBuilder m_metadata_parser{m_metadata};
+};
+
+} // namespace
+
+void to_json(nlohmann::json& j, const SystemInfo& info)
+{
+    j["rows"] = info.rows;
+    j["cols"] = info.cols;
+    j["nnz"] = info.nnz;
+    j["dataset_name"] = info.dataset_name;
+    j["dimension"] = info.dimension;
+    j["is_symmetric_positive_definite"] = info.is_symmetric_positive_definite;
+    j["num_steps"] = info.num_steps;
+    j["file_size"] = info.file_size;
+    j["mtime"] = info.mtime;
+}
+
+void from_json(const nlohmann::json& j, SystemInfo& info)
+{
+    info.rows = j.at("rows");
+    info.cols = j.at("cols");
+    info.nnz = j.at("nnz");
+    info.dataset_name = j.at("dataset_name");
+    info.dimension = j.at("dimension");
+    info.is_symmetric_positive_definite = j.at("is_symmetric_positive_definite");
+    info.num_steps = j.value("num_steps", int64_t(1));
+    info.file_size = j.at("file_size");
+    info.mtime = j.at("mtime");
+}
+
+SystemInfo read_system_info(const std::filesystem::path& filename)
+{
+    std::filesystem::path pack;
+    std::string name;
+    if (split_pack_path(filename, pack, name)) {
+        const auto mapped = open_pack(pack);
+        return mapped->entry(mapped->index_of(name)).info;
+    }
+#ifdef BENCHY_WITH_HDF5
+    std::filesystem::path store;
+    if (split_store_path(filename, store, name)) {
+        return read_store_info(store, name);
+    }
+#endif
+    SystemInfo info;
+    const auto ext = filename.extension();
+    if (ext == ".bcsc") {
+        MappedSystem mapped(filename);
+        const auto& header = mapped.header();
+        info = info_from_metadata(mapped.metadata());
+        info.rows = header.rows;
+        info.cols = header.cols;
+        info.nnz = header.nnz;
+        if (stored_triangle(mapped.metadata()) != StoredTriangle::Full) {
+            const auto diagonal = [&](const auto& A) {
+                return count_diagonal(A.outerIndexPtr(), A.innerIndexPtr(), header.cols);
+            };
+            info.nnz = 2 * header.nnz - (mapped.is_float() ? diagonal(mapped.A<float>())
+                                                           : diagonal(mapped.A<double>()));
+        }
+    } else if (ext == ".bseq") {
+        MappedSequence sequence(filename);
+        const auto& header = sequence.header();
+        info = info_from_metadata(sequence.metadata());
+        info.rows = header.rows;
+        info.cols = header.cols;
+        info.nnz = header.nnz;
+        info.num_steps = header.num_steps;
+        if (stored_triangle(sequence.metadata()) != StoredTriangle::Full) {
+            const int64_t diagonal =
+                count_diagonal(sequence.outer_index(), sequence.inner_index(), header.cols);
+            info.nnz = 2 * header.nnz - diagonal;
+        }
+    } else if (ext == ".zst") {
+        std::ifstream fl(filename, std::ios::in | std::ios::binary);
+        if (!fl.is_open()) {
+            throw std::runtime_error("file `" + filename.string() + "` could not be opened");
+        }
+        ZstdInputBuffer buffer(fl);
+        std::istream stream(&buffer);
+        SystemInfoSaxReader reader;
+        nlohmann::json::sax_parse(stream, &reader, nlohmann::json::input_format_t::msgpack);
+        info = reader.info();
+    } else {
+        auto system = load_problem_system<double>(filename);
+        info = info_from_metadata(system.metadata);
+        info.rows = system.A.rows();
+        info.cols = system.A.cols();
+        info.nnz = full_nonzeros(system.A, stored_triangle(system.metadata));
+    }
+    info.file_size = std::filesystem::file_size(filename);
+    info.mtime = std::filesystem::last_write_time(filename).time_since_epoch().count();
+    return info;
+}
+
+Catalog::Catalog(std::filesystem::path filename)
+    : m_filename(std::move(filename))
+{
+    if (m_filename.empty()) {
+        return;
+    }
+    m_root = std::filesystem::absolute(m_filename).parent_path().lexically_normal();
+    std::ifstream fl(m_filename);
+    if (!fl.is_open()) {
+        return;
+    }
+    try {
+        const auto data = nlohmann::json::parse(fl);
+        for (const auto& [path, info] : data.at("systems").items()) {
+            m_entries[path] = info.get<SystemInfo>();
+        }
+    } catch (const std::exception& e) {
+        spdlog::warn("Ignoring invalid catalog {}: {}", m_filename.string(), e.what());
+        m_entries.clear();
+    }
+}
+
+std::string Catalog::key(const std::filesystem::path& system) const
+{
+    const auto path = std::filesystem::absolute(system).lexically_normal();
+    if (!m_root.empty()) {
+        const auto relative = path.lexically_relative(m_root);
+        if (!relative.empty() && *relative.begin() != "..") {
+            return relative.generic_string();
+        }
+    }
+    return path.generic_string();
+}
+
+std::filesystem::path Catalog::resolve(const std::string& key) const
+{
+    const std::filesystem::path path(key);
+    return path.is_absolute() || m_root.empty() ? path : m_root / path;
+}
+
+const SystemInfo& Catalog::get(const std::filesystem::path& system)
+{
+    const std::string k = key(system);
+    const auto [file_size, mtime] = file_stamp(system);
+    auto it = m_entries.find(k);
+    if (it != m_entries.end() && it->second.file_size == file_size && it->second.mtime == mtime) {
+        return it->second;
+    }
+    spdlog::debug("Updating catalog entry of {}", system.string());
+    ++m_num_refreshed;
+    m_modified = true;
+    return m_entries[k] = read_system_info(system);
+}
+
+void Catalog::remove_missing()
+{
+    // Packs stay open while checking their members, so that their table is only read once
+    std::map<std::filesystem::path, std::shared_ptr<const MappedPack>> packs;
+#ifdef BENCHY_WITH_HDF5
+    std::map<std::filesystem::path, std::shared_ptr<const Hdf5Store>> stores;
+#endif
+    const auto exists = [&](const std::filesystem::path& system) {
+        std::filesystem::path pack;
+        std::string name;
+#ifdef BENCHY_WITH_HDF5
+        std::filesystem::path store;
+        if (split_store_path(system, store, name)) {
+            auto& opened = stores[store];
+            if (!opened && std::filesystem::exists(store)) {
+                opened = open_store(store);
+            }
+            return opened && opened->contains(name);
+        }
+#endif
+        if (!split_pack_path(system, pack, name)) {
+            return std::filesystem::exists(system);
+        }
+        auto& mapped = packs[pack];
+        if (!mapped && std::filesystem::exists(pack)) {
+            mapped = open_pack(pack);
+        }
+        return mapped && mapped->contains(name);
+    };
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (!exists(resolve(it->first))) {
+            it = m_entries.erase(it);
+            m_modified = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Catalog::save()
+{
+    if (m_filename.empty() || !m_modified) {
+        return;
+    }
+    nlohmann::json systems = nlohmann::json::object();
+    for (const auto& [path, info] : m_entries) {
+        systems[path] = info;
+    }
+    const nlohmann::json data = {{"version", 1}, {"systems", std::move(systems)}};
+
+    // Write to a temporary file first, so that an interrupted run never leaves a truncated catalog
+    auto tmp = m_filename;
+    tmp += ".tmp";
+    {
+        std::ofstream fl(tmp);
+        if (!fl.is_open()) {
+            spdlog::warn("Could not write catalog {}", m_filename.string());
+            return;
+        }
+        fl << data.dump(1);
+    }
+    std::filesystem::rename(tmp, m_filename);
+    m_modified = false;
+}
+
+} // namespace io
+} // namespace benchy
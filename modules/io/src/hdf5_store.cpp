@@ -0,0 +1,700 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#ifdef BENCHY_WITH_HDF5
+
+#include <benchy/io/hdf5_store.h>
+
+#include <spdlog/spdlog.h>
+
+#include <hdf5.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace benchy {
+namespace io {
+
+namespace {
+
+static_assert(std::is_same<hid_t, int64_t>::value, "Unexpected HDF5 identifier type");
+
+/// Group holding all problems of a store.
+constexpr const char* kProblemsGroup = "/problems";
+
+/// Version of the layout, stored as an attribute of the problems group.
+constexpr int64_t kStoreVersion = 1;
+
+/// Serializes the HDF5 calls of all stores, since the library is not thread-safe.
+std::recursive_mutex& hdf5_mutex()
+{
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+
+/// Owns an HDF5 identifier.
+class Handle
+{
+public:
+    Handle(hid_t id, herr_t (*close)(hid_t), const std::string& what)
+        : m_id(id)
+        , m_close(close)
+    {
+        if (m_id < 0) {
+            throw std::runtime_error("[Hdf5Store] " + what);
+        }
+    }
+
+    ~Handle()
+    {
+        if (m_id >= 0) {
+            m_close(m_id);
+        }
+    }
+
+    Handle(Handle&& other) noexcept
+        : m_id(std::exchange(other.m_id, -1))
+        , m_close(other.m_close)
+    {}
+
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+
+    operator hid_t() const { return m_id; }
+
+private:
+    hid_t m_id;
+    herr_t (*m_close)(hid_t);
+};
+
+void check(herr_t status, const std::string& what)
+{
+    if (status < 0) {
+        throw std::runtime_error("[Hdf5Store] " + what);
+    }
+}
+
+template <typename T>
+hid_t native_type()
+{
+    if constexpr (std::is_same<T, float>::value) {
+        return H5T_NATIVE_FLOAT;
+    } else if constexpr (std::is_same<T, double>::value) {
+        return H5T_NATIVE_DOUBLE;
+    } else {
+        static_assert(std::is_same<T, int32_t>::value, "Unsupported type");
+        return H5T_NATIVE_INT32;
+    }
+}
+
+/// Little-endian type of the stored values, so that files can be shared between platforms.
+template <typename Scalar>
+hid_t file_type()
+{
+    return std::is_same<Scalar, float>::value ? H5T_IEEE_F32LE : H5T_IEEE_F64LE;
+}
+
+std::string problem_path(const std::string& name)
+{
+    if (name.empty() || name.front() == '/' || name.back() == '/' ||
+        name.find("//") != std::string::npos) {
+        throw std::runtime_error("[Hdf5Store] Invalid problem name: '" + name + "'");
+    }
+    return std::string(kProblemsGroup) + "/" + name;
+}
+
+// Checks every component of the path, since H5Lexists() requires the parent group to exist
+bool exists(hid_t file, const std::string& path)
+{
+    for (size_t pos = path.find('/', 1);; pos = path.find('/', pos + 1)) {
+        const std::string prefix = path.substr(0, pos);
+        if (H5Lexists(file, prefix.c_str(), H5P_DEFAULT) <= 0) {
+            return false;
+        }
+        if (pos == std::string::npos) {
+            return true;
+        }
+    }
+}
+
+bool is_problem(hid_t group)
+{
+    return H5Aexists(group, "num_steps") > 0;
+}
+
+void write_int_attribute(hid_t object, const char* name, int64_t value)
+{
+    Handle space(H5Screate(H5S_SCALAR), H5Sclose, "Could not create a dataspace");
+    Handle attribute(
+        H5Acreate2(object, name, H5T_STD_I64LE, space, H5P_DEFAULT, H5P_DEFAULT),
+        H5Aclose,
+        std::string("Could not create attribute ") + name);
+    check(H5Awrite(attribute, H5T_NATIVE_INT64, &value), std::string("Could not write ") + name);
+}
+
+int64_t read_int_attribute(hid_t object, const char* name)
+{
+    Handle attribute(
+        H5Aopen(object, name, H5P_DEFAULT),
+        H5Aclose,
+        std::string("Missing attribute ") + name);
+    int64_t value = 0;
+    check(H5Aread(attribute, H5T_NATIVE_INT64, &value), std::string("Could not read ") + name);
+    return value;
+}
+
+void write_string_attribute(hid_t object, const char* name, const std::string& value)
+{
+    Handle type(H5Tcopy(H5T_C_S1), H5Tclose, "Could not create a string type");
+    check(H5Tset_size(type, std::max<size_t>(value.size(), 1)), "Invalid string size");
+    check(H5Tset_cset(type, H5T_CSET_UTF8), "Invalid string encoding");
+    Handle space(H5Screate(H5S_SCALAR), H5Sclose, "Could not create a dataspace");
+    Handle attribute(
+        H5Acreate2(object, name, type, space, H5P_DEFAULT, H5P_DEFAULT),
+        H5Aclose,
+        std::string("Could not create attribute ") + name);
+    std::vector<char> buffer(value.begin(), value.end());
+    buffer.resize(std::max<size_t>(value.size(), 1));
+    check(H5Awrite(attribute, type, buffer.data()), std::string("Could not write ") + name);
+}
+
+std::string read_string_attribute(hid_t object, const char* name)
+{
+    Handle attribute(
+        H5Aopen(object, name, H5P_DEFAULT),
+        H5Aclose,
+        std::string("Missing attribute ") + name);
+    Handle type(H5Aget_type(attribute), H5Tclose, "Could not read an attribute type");
+    if (H5Tget_class(type) != H5T_STRING || H5Tis_variable_str(type) != 0) {
+        throw std::runtime_error(std::string("[Hdf5Store] Unexpected type of attribute ") + name);
+    }
+    std::vector<char> buffer(H5Tget_size(type));
+    check(H5Aread(attribute, type, buffer.data()), std::string("Could not read ") + name);
+    return std::string(buffer.begin(), std::find(buffer.begin(), buffer.end(), '\0'));
+}
+
+///
+/// Creates a dataset, chunked along its last dimension and compressed. Empty datasets are
+/// stored contiguously, since chunks cannot be larger than the dataset.
+///
+Handle create_dataset(
+    hid_t group,
+    const char* name,
+    hid_t type,
+    std::vector<hsize_t> dims,
+    const Hdf5StoreOptions& options)
+{
+    Handle space(
+        H5Screate_simple(static_cast<int>(dims.size()), dims.data(), nullptr),
+        H5Sclose,
+        "Could not create a dataspace");
+    Handle properties(H5Pcreate(H5P_DATASET_CREATE), H5Pclose, "Could not create properties");
+    if (std::find(dims.begin(), dims.end(), hsize_t(0)) == dims.end()) {
+        std::vector<hsize_t> chunk(dims.size(), 1);
+        chunk.back() = std::min<hsize_t>(dims.back(), std::max<size_t>(options.chunk_size, 1));
+        check(
+            H5Pset_chunk(properties, static_cast<int>(chunk.size()), chunk.data()),
+            "Invalid chunk size");
+        if (options.deflate_level > 0) {
+            check(H5Pset_shuffle(properties), "Could not enable the shuffle filter");
+            check(
+                H5Pset_deflate(properties, static_cast<unsigned>(options.deflate_level)),
+                "Could not enable the deflate filter");
+        }
+    }
+    return Handle(
+        H5Dcreate2(group, name, type, space, H5P_DEFAULT, properties, H5P_DEFAULT),
+        H5Dclose,
+        std::string("Could not create dataset ") + name);
+}
+
+///
+/// Reads or writes row `row` of a 2D dataset, or the whole dataset if it is 1D.
+///
+/// @param[in]  transfer  H5Dread or H5Dwrite.
+///
+template <typename Transfer, typename Pointer>
+void transfer_row(
+    Transfer transfer,
+    hid_t dataset,
+    hid_t type,
+    hsize_t row,
+    hsize_t count,
+    Pointer data,
+    const char* what)
+{
+    if (count == 0) {
+        return;
+    }
+    Handle file_space(H5Dget_space(dataset), H5Sclose, "Could not read a dataspace");
+    const int rank = H5Sget_simple_extent_ndims(file_space);
+    std::vector<hsize_t> dims(std::max(rank, 1));
+    H5Sget_simple_extent_dims(file_space, dims.data(), nullptr);
+    if (dims.back() != count || (rank == 2 && row >= dims.front())) {
+        throw std::runtime_error(std::string("[Hdf5Store] Unexpected size of dataset ") + what);
+    }
+    if (rank == 2) {
+        const hsize_t start[2] = {row, 0};
+        const hsize_t size[2] = {1, count};
+        check(
+            H5Sselect_hyperslab(file_space, H5S_SELECT_SET, start, nullptr, size, nullptr),
+            "Invalid selection");
+    }
+    Handle memory_space(H5Screate_simple(1, &count, nullptr), H5Sclose, "Invalid dataspace");
+    check(
+        transfer(dataset, type, memory_space, file_space, H5P_DEFAULT, data),
+        std::string("Could not transfer dataset ") + what);
+}
+
+template <typename T>
+void write_row(hid_t dataset, hsize_t row, hsize_t count, const T* data, const char* what)
+{
+    transfer_row(H5Dwrite, dataset, native_type<T>(), row, count, data, what);
+}
+
+template <typename T>
+void read_row(hid_t dataset, hsize_t row, hsize_t count, T* data, const char* what)
+{
+    transfer_row(H5Dread, dataset, native_type<T>(), row, count, data, what);
+}
+
+Handle open_dataset(hid_t group, const char* name)
+{
+    return Handle(
+        H5Dopen2(group, name, H5P_DEFAULT),
+        H5Dclose,
+        std::string("Missing dataset ") + name);
+}
+
+Hdf5ProblemInfo read_info(hid_t group)
+{
+    Hdf5ProblemInfo info;
+    info.rows = read_int_attribute(group, "rows");
+    info.cols = read_int_attribute(group, "cols");
+    info.nnz = read_int_attribute(group, "nnz");
+    info.b_rows = read_int_attribute(group, "b_rows");
+    info.b_cols = read_int_attribute(group, "b_cols");
+    info.num_steps = read_int_attribute(group, "num_steps");
+    info.metadata = nlohmann::json::parse(read_string_attribute(group, "metadata"));
+    Handle values = open_dataset(group, "values");
+    Handle type(H5Dget_type(values), H5Tclose, "Could not read a dataset type");
+    info.scalar_size = static_cast<int>(H5Tget_size(type));
+    return info;
+}
+
+template <typename Scalar>
+void read_pattern_into(
+    hid_t group,
+    const Hdf5ProblemInfo& info,
+    Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A)
+{
+    A.resize(info.rows, info.cols);
+    A.resizeNonZeros(info.nnz);
+    read_row(open_dataset(group, "outer"), 0, info.cols + 1, A.outerIndexPtr(), "outer");
+    read_row(open_dataset(group, "inner"), 0, info.nnz, A.innerIndexPtr(), "inner");
+    if (A.outerIndexPtr()[0] != 0 || A.outerIndexPtr()[info.cols] != info.nnz) {
+        throw std::runtime_error("[Hdf5Store] Corrupted pattern");
+    }
+}
+
+Handle open_problem(hid_t file, const std::string& name)
+{
+    const auto path = problem_path(name);
+    if (!exists(file, path)) {
+        throw std::runtime_error("[Hdf5Store] No problem named '" + name + "'");
+    }
+    Handle group(H5Gopen2(file, path.c_str(), H5P_DEFAULT), H5Gclose, "Could not open " + name);
+    if (!is_problem(group)) {
+        throw std::runtime_error("[Hdf5Store] '" + name + "' is not a problem");
+    }
+    return group;
+}
+
+void list_problems(hid_t group, const std::string& prefix, std::vector<std::string>& names)
+{
+    H5G_info_t info;
+    check(H5Gget_info(group, &info), "Could not read a group");
+    for (hsize_t i = 0; i < info.nlinks; ++i) {
+        const ssize_t size = H5Lget_name_by_idx(
+            group,
+            ".",
+            H5_INDEX_NAME,
+            H5_ITER_INC,
+            i,
+            nullptr,
+            0,
+            H5P_DEFAULT);
+        std::vector<char> buffer(std::max<ssize_t>(size, 0) + 1);
+        H5Lget_name_by_idx(
+            group,
+            ".",
+            H5_INDEX_NAME,
+            H5_ITER_INC,
+            i,
+            buffer.data(),
+            buffer.size(),
+            H5P_DEFAULT);
+        const std::string name = prefix + buffer.data();
+        Handle child(
+            H5Oopen(group, buffer.data(), H5P_DEFAULT),
+            H5Oclose,
+            "Could not open " + name);
+        if (H5Iget_type(child) != H5I_GROUP) {
+            continue;
+        }
+        if (is_problem(child)) {
+            names.push_back(name);
+        } else {
+            list_problems(child, name + "/", names);
+        }
+    }
+}
+
+template <typename Scalar>
+void write_problem(
+    hid_t file,
+    const Hdf5StoreOptions& options,
+    const std::string& name,
+    const std::vector<const LinearSystem<Scalar>*>& steps)
+{
+    static_assert(
+        std::is_same<Scalar, float>::value || std::is_same<Scalar, double>::value,
+        "Scalar must be float or double");
+    if (steps.empty()) {
+        throw std::runtime_error("[Hdf5Store] A problem must have at least one step");
+    }
+
+    // Outer/inner arrays must be contiguous
+    using SparseMatrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
+    auto compressed = [](const SparseMatrix& A, SparseMatrix& copy) {
+        if (A.isCompressed()) {
+            return &A;
+        }
+        copy = A;
+        copy.makeCompressed();
+        return static_cast<const SparseMatrix*>(&copy);
+    };
+    SparseMatrix first_copy;
+    const SparseMatrix& A = *compressed(steps.front()->A, first_copy);
+    const Eigen::Index b_rows = steps.front()->b.rows();
+    const Eigen::Index b_cols = steps.front()->b.cols();
+    const hsize_t num_steps = steps.size();
+    const hsize_t nnz = A.nonZeros();
+    const hsize_t b_size = b_rows * b_cols;
+
+    // Problems cannot be nested, nor replace a group of problems
+    const auto path = problem_path(name);
+    for (size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1)) {
+        const auto prefix = path.substr(0, pos);
+        if (exists(file, prefix) && prefix != kProblemsGroup) {
+            Handle parent(H5Gopen2(file, prefix.c_str(), H5P_DEFAULT), H5Gclose, prefix);
+            if (is_problem(parent)) {
+                throw std::runtime_error(
+                    "[Hdf5Store] Cannot write '" + name + "' inside problem " + prefix);
+            }
+        }
+    }
+    if (exists(file, path)) {
+        Handle existing(H5Gopen2(file, path.c_str(), H5P_DEFAULT), H5Gclose, path);
+        if (!is_problem(existing)) {
+            throw std::runtime_error("[Hdf5Store] '" + name + "' is a group of problems");
+        }
+        spdlog::warn("Replacing problem '{}'", name);
+        check(H5Ldelete(file, path.c_str(), H5P_DEFAULT), "Could not replace " + name);
+    }
+
+    spdlog::info("Saving problem '{}' ({} steps)", name, num_steps);
+    Handle link_properties(H5Pcreate(H5P_LINK_CREATE), H5Pclose, "Could not create properties");
+    check(H5Pset_create_intermediate_group(link_properties, 1), "Invalid link properties");
+    Handle group(
+        H5Gcreate2(file, path.c_str(), link_properties, H5P_DEFAULT, H5P_DEFAULT),
+        H5Gclose,
+        "Could not create problem " + name);
+
+    Handle outer =
+        create_dataset(group, "outer", H5T_STD_I32LE, {hsize_t(A.cols()) + 1}, options);
+    write_row(outer, 0, A.cols() + 1, A.outerIndexPtr(), "outer");
+    Handle inner = create_dataset(group, "inner", H5T_STD_I32LE, {nnz}, options);
+    write_row(inner, 0, nnz, A.innerIndexPtr(), "inner");
+
+    Handle values =
+        create_dataset(group, "values", file_type<Scalar>(), {num_steps, nnz}, options);
+    Handle b = create_dataset(group, "b", file_type<Scalar>(), {num_steps, b_size}, options);
+    for (hsize_t k = 0; k < num_steps; ++k) {
+        SparseMatrix copy;
+        const SparseMatrix& Ak = (k == 0 ? A : *compressed(steps[k]->A, copy));
+        if (Ak.rows() != A.rows() || Ak.cols() != A.cols() || Ak.nonZeros() != A.nonZeros() ||
+            !std::equal(A.outerIndexPtr(), A.outerIndexPtr() + A.cols() + 1, Ak.outerIndexPtr()) ||
+            !std::equal(A.innerIndexPtr(), A.innerIndexPtr() + nnz, Ak.innerIndexPtr())) {
+            throw std::runtime_error(fmt::format(
+                "[Hdf5Store] Step {} does not have the sparsity pattern of the first step",
+                k));
+        }
+        if (steps[k]->b.rows() != b_rows || steps[k]->b.cols() != b_cols) {
+            throw std::runtime_error(fmt::format(
+                "[Hdf5Store] Step {} does not have the rhs size of the first step",
+                k));
+        }
+        write_row(values, k, nnz, Ak.valuePtr(), "values");
+        write_row(b, k, b_size, steps[k]->b.data(), "b");
+    }
+
+    auto metadata = steps.front()->metadata;
+    if (num_steps > 1) {
+        metadata["is_sequence_of_problems"] = 1;
+        metadata["num_steps"] = num_steps;
+    }
+    metadata["scalar_type"] = std::is_same<Scalar, float>::value ? "float" : "double";
+    write_string_attribute(group, "metadata", metadata.dump());
+    write_int_attribute(group, "rows", A.rows());
+    write_int_attribute(group, "cols", A.cols());
+    write_int_attribute(group, "nnz", nnz);
+    write_int_attribute(group, "b_rows", b_rows);
+    write_int_attribute(group, "b_cols", b_cols);
+    // Written last, since it marks the group as a complete problem
+    write_int_attribute(group, "num_steps", num_steps);
+}
+
+} // namespace
+
+Hdf5Store::Hdf5Store(const std::filesystem::path& filename, Mode mode, Hdf5StoreOptions options)
+    : m_options(options)
+{
+    std::lock_guard<std::recursive_mutex> lock(hdf5_mutex());
+    const auto ext = filename.extension();
+    if (ext != ".h5" && ext != ".hdf5") {
+        spdlog::warn("Unexpected file extension: '{}' (should be .h5)", ext.string());
+    }
+    const std::string path = filename.string();
+    // Failures are reported by the exception below, instead of the HDF5 error stack
+    H5E_BEGIN_TRY
+    {
+        if (mode == Mode::Read) {
+            m_file = H5Fopen(path.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+        } else if (mode == Mode::Append && std::filesystem::exists(filename)) {
+            m_file = H5Fopen(path.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+        } else {
+            m_file = H5Fcreate(path.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+        }
+    }
+    H5E_END_TRY;
+    if (m_file < 0) {
+        throw std::runtime_error("file `" + path + "` could not be opened");
+    }
+
+    try {
+        if (H5Lexists(m_file, kProblemsGroup, H5P_DEFAULT) > 0) {
+            Handle root(H5Gopen2(m_file, kProblemsGroup, H5P_DEFAULT), H5Gclose, "Invalid store");
+            const int64_t version = read_int_attribute(root, "version");
+            if (version > kStoreVersion) {
+                throw std::runtime_error(
+                    fmt::format("[Hdf5Store] Unsupported store version {}", version));
+            }
+        } else if (mode == Mode::Read) {
+            throw std::runtime_error("[Hdf5Store] Not a problem store: " + path);
+        } else {
+            Handle root(
+                H5Gcreate2(m_file, kProblemsGroup, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT),
+                H5Gclose,
+                "Could not create the problems group");
+            write_int_attribute(root, "version", kStoreVersion);
+        }
+    } catch (...) {
+        H5Fclose(m_file);
+        throw;
+    }
+}
+
+Hdf5Store::~Hdf5Store()
+{
+    std::lock_guard<std::recursive_mutex> lock(hdf5_mutex());
+    if (m_file >= 0) {
+        H5Fclose(m_file);
+    }
+}
+
+Hdf5Store::Hdf5Store(Hdf5Store&& other) noexcept
+    : m_file(std::exchange(other.m_file, -1))
+    , m_options(other.m_options)
+{}
+
+Hdf5Store& Hdf5Store::operator=(Hdf5Store&& other) noexcept
+{
+    if (this != &other) {
+        std::lock_guard<std::recursive_mutex> lock(hdf5_mutex());
+        if (m_file >= 0) {
+            H5Fclose(m_file);
+        }
+        m_file = std::exchange(other.m_file, -1);
+        m_options = other.m_options;
+    }
+    return *this;
+}
+
+std::vector<std::string> Hdf5Store::problems() const
+{
+    std::lock_guard<std::recursive_mutex> lock(hdf5_mutex());
+    std::vector<std::string> names;
+    Handle root(H5Gopen2(m_file, kProblemsGroup, H5P_DEFAULT), H5Gclose, "Invalid store");
+    list_problems(root, "", names);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+bool Hdf5Store::contains(const std::string& name) const
+{
+    std::lock_guard<std::recursive_mutex> lock(hdf5_mutex());
+    const auto path = problem_path(name);
+    if (!exists(m_file, path)) {
+        return false;
+    }
+    Handle object(H5Oopen(m_file, path.c_str(), H5P_DEFAULT), H5Oclose, "Could not open " + name);
+    return H5Iget_type(object) == H5I_GROUP && is_problem(object);
+}
+
+Hdf5ProblemInfo Hdf5Store::info(const std::string& name) const
+{
+    std::lock_guard<std::recursive_mutex> lock(hdf5_mutex());
+    return read_info(open_problem(m_file, name));
+}
+
+template <typename Scalar>
+Eigen::SparseMatrix<Scalar, Eigen::ColMajor> Hdf5Store::read_pattern(const std::string& name) const
+{
+    std::lock_guard<std::recursive_mutex> lock(hdf5_mutex());
+    Handle group = open_problem(m_file, name);
+    Eigen::SparseMatrix<Scalar, Eigen::ColMajor> A;
+    read_pattern_into(group, read_info(group), A);
+    std::fill_n(A.valuePtr(), A.nonZeros(), Scalar(0));
+    return A;
+}
+
+template <typename Scalar>
+void Hdf5Store::read_step(const std::string& name, size_t step, LinearSystem<Scalar>& system) const
+{
+    std::lock_guard<std::recursive_mutex> lock(hdf5_mutex());
+    Handle group = open_problem(m_file, name);
+    const auto info = read_info(group);
+    if (step >= static_cast<size_t>(info.num_steps)) {
+        throw std::out_of_range(
+            "Step " + std::to_string(step) + " is out of range (" +
+            std::to_string(info.num_steps) + " steps)");
+    }
+
+    auto& A = system.A;
+    // The matrix may have been filled from another problem with the same sizes, so its indices
+    // are compared with the stored pattern before being kept
+    bool same_pattern = A.isCompressed() && A.rows() == info.rows && A.cols() == info.cols &&
+                        A.nonZeros() == info.nnz;
+    if (same_pattern) {
+        using StorageIndex = typename Eigen::SparseMatrix<Scalar, Eigen::ColMajor>::StorageIndex;
+        std::vector<StorageIndex> outer(info.cols + 1);
+        std::vector<StorageIndex> inner(info.nnz);
+        read_row(open_dataset(group, "outer"), 0, info.cols + 1, outer.data(), "outer");
+        read_row(open_dataset(group, "inner"), 0, info.nnz, inner.data(), "inner");
+        same_pattern = std::equal(outer.begin(), outer.end(), A.outerIndexPtr()) &&
+                       std::equal(inner.begin(), inner.end(), A.innerIndexPtr());
+    }
+    if (!same_pattern) {
+        read_pattern_into(group, info, A);
+    }
+    // HDF5 converts the stored values to Scalar
+    read_row(open_dataset(group, "values"), step, info.nnz, A.valuePtr(), "values");
+    system.b.resize(info.b_rows, info.b_cols);
+    read_row(open_dataset(group, "b"), step, info.b_rows * info.b_cols, system.b.data(), "b");
+    system.metadata = info.metadata;
+}
+
+template <typename Scalar>
+LinearSystem<Scalar> Hdf5Store::read(const std::string& name, size_t step) const
+{
+    LinearSystem<Scalar> system;
+    read_step(name, step, system);
+    return system;
+}
+
+template <typename Scalar>
+void Hdf5Store::write(const std::string& name, const std::vector<LinearSystem<Scalar>>& steps)
+{
+    std::lock_guard<std::recursive_mutex> lock(hdf5_mutex());
+    std::vector<const LinearSystem<Scalar>*> pointers;
+    for (const auto& step : steps) {
+        pointers.push_back(&step);
+    }
+    write_problem(m_file, m_options, name, pointers);
+}
+
+template <typename Scalar>
+void Hdf5Store::write(const std::string& name, const LinearSystem<Scalar>& system)
+{
+    std::lock_guard<std::recursive_mutex> lock(hdf5_mutex());
+    write_problem<Scalar>(m_file, m_options, name, {&system});
+}
+
+bool split_store_path(
+    const std::filesystem::path& path,
+    std::filesystem::path& store,
+    std::string& name)
+{
+    std::filesystem::path prefix;
+    for (auto it = path.begin(); it != path.end(); ++it) {
+        prefix /= *it;
+        if (it->extension() != ".h5") {
+            continue;
+        }
+        std::filesystem::path problem;
+        for (++it; it != path.end(); ++it) {
+            problem /= *it;
+        }
+        if (problem.empty()) {
+            return false;
+        }
+        store = std::move(prefix);
+        name = problem.generic_string();
+        return true;
+    }
+    return false;
+}
+
+std::shared_ptr<const Hdf5Store> open_store(const std::filesystem::path& filename)
+{
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const Hdf5Store>> stores;
+    const auto key = std::filesystem::absolute(filename).lexically_normal().string();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = stores[key];
+    auto store = slot.lock();
+    if (!store) {
+        store = std::make_shared<const Hdf5Store>(filename);
+        slot = store;
+    }
+    return store;
+}
+
+template Eigen::SparseMatrix<float> Hdf5Store::read_pattern(const std::string&) const;
+template Eigen::SparseMatrix<double> Hdf5Store::read_pattern(const std::string&) const;
+template void Hdf5Store::read_step(const std::string&, size_t, LinearSystem<float>&) const;
+template void Hdf5Store::read_step(const std::string&, size_t, LinearSystem<double>&) const;
+template LinearSystem<float> Hdf5Store::read(const std::string&, size_t) const;
+template LinearSystem<double> Hdf5Store::read(const std::string&, size_t) const;
+template void Hdf5Store::write(const std::string&, const std::vector<LinearSystem<float>>&);
+template void Hdf5Store::write(const std::string&, const std::vector<LinearSystem<double>>&);
+template void Hdf5Store::write(const std::string&, const LinearSystem<float>&);
+template void Hdf5Store::write(const std::string&, const LinearSystem<double>&);
+
+} // namespace io
+} // namespace benchy
+
+#endif
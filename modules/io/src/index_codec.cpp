@@ -0,0 +1,372 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#include <benchy/io/index_codec.h>
+
+#include <spdlog/spdlog.h>
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define BENCHY_VARINT_SSSE3
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define BENCHY_VARINT_NEON
+    #include <arm_neon.h>
+#endif
+
+// The SSSE3 decoder is compiled for SSSE3 even when the rest of the library targets baseline
+// x86-64, and only called after checking the CPU at runtime
+#if defined(BENCHY_VARINT_SSSE3) && (defined(__GNUC__) || defined(__clang__))
+    #define BENCHY_TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+    #define BENCHY_TARGET_SSSE3
+#endif
+
+namespace benchy {
+namespace io {
+
+namespace {
+
+///
+/// Byte shuffles expanding 4 encoded values to 4 x 32 bits, and the number of encoded bytes,
+/// for each of the 256 control bytes.
+///
+struct ShuffleTables
+{
+    ShuffleTables()
+    {
+        for (int ctrl = 0; ctrl < 256; ++ctrl) {
+            int offset = 0;
+            for (int k = 0; k < 4; ++k) {
+                const int len = ((ctrl >> (2 * k)) & 3) + 1;
+                for (int b = 0; b < 4; ++b) {
+                    shuffle[ctrl][4 * k + b] = static_cast<uint8_t>(b < len ? offset + b : 0xFF);
+                }
+                offset += len;
+            }
+            length[ctrl] = static_cast<uint8_t>(offset);
+        }
+    }
+
+    alignas(16) uint8_t shuffle[256][16];
+    uint8_t length[256];
+};
+
+const ShuffleTables& shuffle_tables()
+{
+    static const ShuffleTables tables;
+    return tables;
+}
+
+bool has_simd_decoder()
+{
+#if defined(BENCHY_VARINT_SSSE3)
+    #if defined(__SSSE3__)
+    return true;
+    #elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+    #else
+    return __builtin_cpu_supports("ssse3");
+    #endif
+#elif defined(BENCHY_VARINT_NEON)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool simd_decoder_available()
+{
+    static const bool available = has_simd_decoder();
+    return available;
+}
+
+#if defined(BENCHY_VARINT_SSSE3) || defined(BENCHY_VARINT_NEON)
+
+// Decodes groups of 4 values while 16 bytes can be read from `data`, and returns the number of
+// decoded values. The remaining values are left to the scalar decoder.
+BENCHY_TARGET_SSSE3
+size_t decode_simd(
+    const uint8_t* control,
+    const uint8_t*& data,
+    const uint8_t* end,
+    size_t count,
+    uint32_t* values)
+{
+    const auto& tables = shuffle_tables();
+    size_t i = 0;
+    for (; i + 4 <= count && end - data >= 16; i += 4) {
+        const uint8_t ctrl = control[i / 4];
+    #if defined(BENCHY_VARINT_SSSE3)
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        const __m128i shuffle =
+            _mm_load_si128(reinterpret_cast<const __m128i*>(tables.shuffle[ctrl]));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(values + i),
+            _mm_shuffle_epi8(bytes, shuffle));
+    #else
+        const uint8x16_t bytes = vld1q_u8(data);
+        const uint8x16_t shuffle = vld1q_u8(tables.shuffle[ctrl]);
+        vst1q_u8(reinterpret_cast<uint8_t*>(values + i), vqtbl1q_u8(bytes, shuffle));
+    #endif
+        data += tables.length[ctrl];
+    }
+    return i;
+}
+
+#endif
+
+// Decodes values [i, count) one by one, and returns the end of their encoded bytes
+const uint8_t* decode_scalar(
+    const uint8_t* control,
+    const uint8_t* data,
+    const uint8_t* end,
+    size_t i,
+    size_t count,
+    uint32_t* values)
+{
+    for (; i < count; ++i) {
+        const int len = ((control[i / 4] >> (2 * (i % 4))) & 3) + 1;
+        if (end - data < len) {
+            throw std::runtime_error("[decode_varints] Truncated data");
+        }
+        uint32_t value = 0;
+        for (int b = 0; b < len; ++b) {
+            value |= static_cast<uint32_t>(data[b]) << (8 * b);
+        }
+        values[i] = value;
+        data += len;
+    }
+    return data;
+}
+
+} // namespace
+
+std::vector<uint8_t> encode_varints(const uint32_t* values, size_t count)
+{
+    std::vector<uint8_t> out((count + 3) / 4, 0);
+    out.reserve(out.size() + 2 * count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t value = values[i];
+        const int len = (value < (1u << 8)    ? 1
+                         : value < (1u << 16) ? 2
+                         : value < (1u << 24) ? 3
+                                              : 4);
+        out[i / 4] |= static_cast<uint8_t>((len - 1) << (2 * (i % 4)));
+        for (int b = 0; b < len; ++b) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * b)));
+        }
+    }
+    return out;
+}
+
+void decode_varints(
+    const uint8_t* data,
+    size_t size,
+    size_t count,
+    uint32_t* values,
+    bool allow_simd)
+{
+    const size_t control_size = (count + 3) / 4;
+    if (size < control_size) {
+        throw std::runtime_error("[decode_varints] Truncated data");
+    }
+    const uint8_t* control = data;
+    const uint8_t* bytes = data + control_size;
+    const uint8_t* end = data + size;
+
+    size_t i = 0;
+#if defined(BENCHY_VARINT_SSSE3) || defined(BENCHY_VARINT_NEON)
+    if (allow_simd && simd_decoder_available()) {
+        i = decode_simd(control, bytes, end, count, values);
+    }
+#endif
+    bytes = decode_scalar(control, bytes, end, i, count, values);
+    if (bytes != end) {
+        throw std::runtime_error(fmt::format(
+            "[decode_varints] Expected {} bytes for {} values, got {}",
+            bytes - data,
+            count,
+            size));
+    }
+}
+
+const char* varint_decoder_name()
+{
+    if (!simd_decoder_available()) {
+        return "scalar";
+    }
+#if defined(BENCHY_VARINT_SSSE3)
+    return "ssse3";
+#else
+    return "neon";
+#endif
+}
+
+template <typename Scalar>
+EncodedSparseMatrix encode_sparse_matrix(const Eigen::SparseMatrix<Scalar>& A)
+{
+    if (!A.isCompressed()) {
+        Eigen::SparseMatrix<Scalar> compressed = A;
+        compressed.makeCompressed();
+        return encode_sparse_matrix(compressed);
+    }
+
+    EncodedSparseMatrix encoded;
+    encoded.rows = A.rows();
+    encoded.cols = A.cols();
+    encoded.nnz = A.nonZeros();
+    encoded.value_size = static_cast<int>(sizeof(Scalar));
+
+    const auto* outer = A.outerIndexPtr();
+    const auto* inner = A.innerIndexPtr();
+    std::vector<uint32_t> buffer(A.cols());
+    for (Eigen::Index j = 0; j < A.cols(); ++j) {
+        buffer[j] = static_cast<uint32_t>(outer[j + 1] - outer[j]);
+    }
+    encoded.outer = encode_varints(buffer.data(), buffer.size());
+
+    buffer.resize(A.nonZeros());
+    for (Eigen::Index j = 0; j < A.cols(); ++j) {
+        int prev = 0;
+        for (int k = outer[j]; k < outer[j + 1]; ++k) {
+            if (inner[k] < prev) {
+                throw std::runtime_error(
+                    "[encode_sparse_matrix] Row indices must be sorted within each column");
+            }
+            buffer[k] = static_cast<uint32_t>(inner[k] - prev);
+            prev = inner[k];
+        }
+    }
+    encoded.inner = encode_varints(buffer.data(), buffer.size());
+
+    encoded.values.resize(A.nonZeros() * sizeof(Scalar));
+    std::memcpy(encoded.values.data(), A.valuePtr(), encoded.values.size());
+    return encoded;
+}
+
+template <typename Scalar>
+void decode_sparse_matrix(const EncodedSparseMatrix& encoded, Eigen::SparseMatrix<Scalar>& A)
+{
+    constexpr Eigen::Index max_index = std::numeric_limits<int>::max();
+    if (encoded.rows < 0 || encoded.cols < 0 || encoded.nnz < 0 || encoded.rows > max_index ||
+        encoded.cols > max_index || encoded.nnz > max_index) {
+        throw std::runtime_error(fmt::format(
+            "[decode_sparse_matrix] Invalid matrix size {} x {} with {} entries",
+            encoded.rows,
+            encoded.cols,
+            encoded.nnz));
+    }
+    if (encoded.value_size != sizeof(float) && encoded.value_size != sizeof(double)) {
+        throw std::runtime_error(
+            fmt::format("[decode_sparse_matrix] Invalid value size: {}", encoded.value_size));
+    }
+    if (encoded.values.size() != static_cast<size_t>(encoded.nnz * encoded.value_size)) {
+        throw std::runtime_error("[decode_sparse_matrix] Unexpected size of the values");
+    }
+
+    A.resize(encoded.rows, encoded.cols);
+    A.resizeNonZeros(encoded.nnz);
+
+    // Column sizes, then their prefix sum
+    auto* outer = reinterpret_cast<uint32_t*>(A.outerIndexPtr());
+    decode_varints(encoded.outer.data(), encoded.outer.size(), encoded.cols, outer + 1);
+    uint64_t total = 0;
+    outer[0] = 0;
+    for (Eigen::Index j = 0; j < encoded.cols; ++j) {
+        total += outer[j + 1];
+        if (total > static_cast<uint64_t>(encoded.nnz)) {
+            break;
+        }
+        outer[j + 1] = static_cast<uint32_t>(total);
+    }
+    if (total != static_cast<uint64_t>(encoded.nnz)) {
+        throw std::runtime_error("[decode_sparse_matrix] Column sizes do not match nnz");
+    }
+
+    // Row deltas, then their prefix sum within each column
+    auto* inner = reinterpret_cast<uint32_t*>(A.innerIndexPtr());
+    decode_varints(encoded.inner.data(), encoded.inner.size(), encoded.nnz, inner);
+    const uint64_t rows = static_cast<uint64_t>(encoded.rows);
+    for (Eigen::Index j = 0; j < encoded.cols; ++j) {
+        uint64_t row = 0;
+        for (uint32_t k = outer[j]; k < outer[j + 1]; ++k) {
+            row += inner[k];
+            if (row >= rows) {
+                throw std::runtime_error("[decode_sparse_matrix] Row index out of bounds");
+            }
+            inner[k] = static_cast<uint32_t>(row);
+        }
+    }
+
+    if (encoded.value_size == sizeof(Scalar)) {
+        std::memcpy(A.valuePtr(), encoded.values.data(), encoded.values.size());
+    } else {
+        auto convert = [&](auto stored) {
+            for (Eigen::Index k = 0; k < encoded.nnz; ++k) {
+                std::memcpy(&stored, encoded.values.data() + k * sizeof(stored), sizeof(stored));
+                A.valuePtr()[k] = static_cast<Scalar>(stored);
+            }
+        };
+        if (encoded.value_size == sizeof(float)) {
+            convert(0.f);
+        } else {
+            convert(0.0);
+        }
+    }
+}
+
+void to_json(nlohmann::json& j, const EncodedSparseMatrix& encoded)
+{
+    j = {
+        {"index_encoding", EncodedSparseMatrix::kIndexEncoding},
+        {"rows", encoded.rows},
+        {"cols", encoded.cols},
+        {"nnz", encoded.nnz},
+        {"value_size", encoded.value_size},
+        {"outer", nlohmann::json::binary(encoded.outer)},
+        {"inner", nlohmann::json::binary(encoded.inner)},
+        {"values", nlohmann::json::binary(encoded.values)},
+    };
+}
+
+void from_json(const nlohmann::json& j, EncodedSparseMatrix& encoded)
+{
+    const auto encoding = j.at("index_encoding").get<std::string>();
+    if (encoding != EncodedSparseMatrix::kIndexEncoding) {
+        throw std::runtime_error(
+            fmt::format("[from_json] Unsupported index encoding: {}", encoding));
+    }
+    encoded.rows = j.at("rows").get<Eigen::Index>();
+    encoded.cols = j.at("cols").get<Eigen::Index>();
+    encoded.nnz = j.at("nnz").get<Eigen::Index>();
+    encoded.value_size = j.at("value_size").get<int>();
+    encoded.outer = j.at("outer").get_binary();
+    encoded.inner = j.at("inner").get_binary();
+    encoded.values = j.at("values").get_binary();
+}
+
+template EncodedSparseMatrix encode_sparse_matrix(const Eigen::SparseMatrix<float>&);
+template EncodedSparseMatrix encode_sparse_matrix(const Eigen::SparseMatrix<double>&);
+template void decode_sparse_matrix(const EncodedSparseMatrix&, Eigen::SparseMatrix<float>&);
+template void decode_sparse_matrix(const EncodedSparseMatrix&, Eigen::SparseMatrix<double>&);
+
+} // namespace io
+} // namespace benchy
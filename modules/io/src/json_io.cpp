@@ -11,10 +11,16 @@
  */
 #include <benchy/io/json_io.h>
 
+#include <benchy/io/csc_assembler.h>
+#include <benchy/io/index_codec.h>
+#include <benchy/io/zstd_stream.h>
+
 #include <spdlog/spdlog.h>
 
 #include <exception>
 #include <fstream>
+#include <memory>
+#include <optional>
 
 extern "C" {
 #include <zstd.h>
@@ -25,12 +31,44 @@ namespace io {
 
 namespace {
 
-std::vector<uint8_t> compress(const std::vector<uint8_t>& src)
+void set_parameter(ZSTD_CCtx* cctx, ZSTD_cParameter param, int value, const char* name)
+{
+    const auto code = ZSTD_CCtx_setParameter(cctx, param, value);
+    if (ZSTD_isError(code)) {
+        throw std::runtime_error(fmt::format(
+            "[compress] Invalid value {} for {}: {}",
+            value,
+            name,
+            ZSTD_getErrorName(code)));
+    }
+}
+
+std::vector<uint8_t> compress(const std::vector<uint8_t>& src, const CompressionOptions& options)
 {
     spdlog::info("Compressing binary data");
-    const auto level = ZSTD_defaultCLevel();
+    std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+    if (cctx == nullptr) {
+        throw std::runtime_error("[compress] Could not create compression context");
+    }
+    set_parameter(cctx.get(), ZSTD_c_compressionLevel, options.level, "compression level");
+    if (options.num_workers > 0) {
+        // Fails when zstd was built without multithreading support
+        const auto code = ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_nbWorkers, options.num_workers);
+        if (ZSTD_isError(code)) {
+            spdlog::warn(
+                "Multithreaded compression unavailable ({}), using a single thread",
+                ZSTD_getErrorName(code));
+        }
+    }
+    if (options.long_distance_matching) {
+        set_parameter(cctx.get(), ZSTD_c_enableLongDistanceMatching, 1, "long-distance matching");
+    }
+    if (options.window_log > 0) {
+        set_parameter(cctx.get(), ZSTD_c_windowLog, options.window_log, "window log");
+    }
+
     std::vector<uint8_t> dst(ZSTD_compressBound(src.size()));
-    const auto code = ZSTD_compress(dst.data(), dst.size(), src.data(), src.size(), level);
+    const auto code = ZSTD_compress2(cctx.get(), dst.data(), dst.size(), src.data(), src.size());
     if (ZSTD_isError(code)) {
         throw std::runtime_error(
             fmt::format("[compress] Compression error: {}", ZSTD_getErrorName(code)));
@@ -39,32 +77,349 @@ std::vector<uint8_t> compress(const std::vector<uint8_t>& src)
     return dst;
 }
 
-std::vector<char> decompress(const std::vector<char>& src)
+///
+/// SAX handler decoding a messagepack linear system straight into Eigen storage.
+///
+/// The sparse matrix "A" (or legacy "lhs") is stored by `adl_serializer<SparseMatrix>` as
+/// `[rows, cols, [row indices], [col indices], [values]]`, and the rhs "b" (or legacy "rhs") as
+/// an array of rows. Those arrays are written directly into a CscAssembler and a dense matrix,
+/// while the (small) metadata object is built as a regular json DOM. A matrix with compressed
+/// indices (an object, see `EncodedSparseMatrix`) is collected as binary blobs and decoded in one
+/// pass.
+///
+template <typename Scalar>
+class SystemSaxDecoder
 {
-    const auto dst_size = ZSTD_getFrameContentSize(src.data(), src.size());
-    if (dst_size == ZSTD_CONTENTSIZE_UNKNOWN) {
-        throw std::runtime_error(fmt::format("[decompress] Content size unkown"));
+public:
+    using json = nlohmann::json;
+
+    explicit SystemSaxDecoder(LinearSystem<Scalar>& system)
+        : m_system(system)
+    {}
+
+    bool null() { return value(nullptr); }
+    bool boolean(bool val) { return value(val); }
+    bool number_integer(json::number_integer_t val) { return number(val); }
+    bool number_unsigned(json::number_unsigned_t val) { return number(val); }
+    bool number_float(json::number_float_t val, const json::string_t&) { return number(val); }
+    bool string(json::string_t& val)
+    {
+        if (m_section == Section::EncodedMatrix) {
+            if (m_field == "index_encoding" && val != EncodedSparseMatrix::kIndexEncoding) {
+                return error("unsupported index encoding " + val);
+            }
+            return true;
+        }
+        return value(std::move(val));
     }
-    if (dst_size == ZSTD_CONTENTSIZE_ERROR) {
-        throw std::runtime_error(
-            fmt::format("[decompress] Error occurred when trying to determine content size"));
+
+    bool binary(json::binary_t& val)
+    {
+        if (m_section == Section::EncodedMatrix) {
+            std::vector<uint8_t>& bytes = val;
+            if (m_field == "outer") {
+                m_encoded.outer = std::move(bytes);
+            } else if (m_field == "inner") {
+                m_encoded.inner = std::move(bytes);
+            } else if (m_field == "values") {
+                m_encoded.values = std::move(bytes);
+            }
+            return true;
+        }
+        return value(std::move(val));
     }
-    std::vector<char> dst(dst_size);
-    const auto code = ZSTD_decompress(dst.data(), dst.size(), src.data(), src.size());
-    if (ZSTD_isError(code)) {
-        throw std::runtime_error(
-            fmt::format("[decompress] Decompression error: {}", ZSTD_getErrorName(code)));
+
+    bool start_object(std::size_t)
+    {
+        if (m_section == Section::Root && m_depth == 0) {
+            m_depth = 1;
+        } else if (m_section == Section::Root && m_depth == 1 && (m_key == "A" || m_key == "lhs")) {
+            m_section = Section::EncodedMatrix;
+            m_encoded = {};
+            m_found_matrix = true;
+            m_depth = 2;
+        } else if (m_section == Section::Root && m_depth == 1) {
+            start_dom(json::object());
+        } else if (m_section == Section::Dom) {
+            m_dom.push_back(dom_add(json::object()));
+        } else {
+            return error("unexpected object");
+        }
+        return true;
     }
-    if (code != dst.size()) {
-        throw std::runtime_error(
-            fmt::format("[decompress] Mismatched decompressed size: {} / {}", code, dst.size()));
+
+    bool key(json::string_t& val)
+    {
+        if (m_section == Section::Root && m_depth == 1) {
+            m_key = std::move(val);
+        } else if (m_section == Section::EncodedMatrix) {
+            m_field = std::move(val);
+        } else if (m_section == Section::Dom) {
+            m_dom_key = std::move(val);
+        } else {
+            return error("unexpected key");
+        }
+        return true;
     }
-    return dst;
+
+    bool end_object()
+    {
+        if (m_section == Section::Dom) {
+            end_dom();
+        } else if (m_section == Section::EncodedMatrix) {
+            spdlog::debug("Decoding compressed indices ({})", varint_decoder_name());
+            decode_sparse_matrix(m_encoded, m_system.A);
+            m_encoded = {};
+            m_section = Section::Root;
+            m_depth = 1;
+        } else if (m_section == Section::Root && m_depth == 1) {
+            m_depth = 0;
+        } else {
+            return error("unexpected end of object");
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t elements)
+    {
+        const auto n = static_cast<Eigen::Index>(elements);
+        if (m_section == Section::Root && m_depth == 1) {
+            if (m_key == "A" || m_key == "lhs") {
+                m_section = Section::Matrix;
+                m_item = 0;
+                m_found_matrix = true;
+            } else if (m_key == "b" || m_key == "rhs") {
+                m_section = Section::Rhs;
+                m_rhs_rows = n;
+                m_rhs_cols = -1;
+                m_item = 0;
+                m_found_rhs = true;
+            } else {
+                start_dom(json::array());
+                return true;
+            }
+            m_depth = 2;
+        } else if (m_section == Section::Matrix && m_depth == 2) {
+            if (m_item == 2) {
+                m_assembler.emplace(m_rows, m_cols, n);
+            } else if (m_item < 2 || m_item > 4 || n != m_assembler->nonZeros()) {
+                return error("invalid sparse matrix layout");
+            }
+            m_k = 0;
+            m_depth = 3;
+        } else if (m_section == Section::Rhs && m_depth == 2) {
+            if (m_rhs_cols < 0) {
+                resize_rhs(n);
+            } else if (n != m_rhs_cols) {
+                return error("inconsistent number of rhs columns");
+            }
+            m_k = 0;
+            m_depth = 3;
+        } else if (m_section == Section::Dom) {
+            m_dom.push_back(dom_add(json::array()));
+        } else {
+            return error("unexpected array");
+        }
+        return true;
+    }
+
+    bool end_array()
+    {
+        if (m_section == Section::Matrix && m_depth == 3) {
+            if (m_k != m_assembler->nonZeros()) {
+                return error("truncated sparse matrix array");
+            }
+            ++m_item;
+            m_depth = 2;
+        } else if (m_section == Section::Matrix && m_depth == 2) {
+            if (m_item != 5) {
+                return error("invalid sparse matrix layout");
+            }
+            m_system.A = m_assembler->finalize();
+            m_assembler.reset();
+            m_section = Section::Root;
+            m_depth = 1;
+        } else if (m_section == Section::Rhs && m_depth == 3) {
+            ++m_item;
+            m_depth = 2;
+        } else if (m_section == Section::Rhs && m_depth == 2) {
+            if (m_rhs_cols < 0) {
+                resize_rhs(0);
+            }
+            m_section = Section::Root;
+            m_depth = 1;
+        } else if (m_section == Section::Dom) {
+            end_dom();
+        } else {
+            return error("unexpected end of array");
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const json::exception& ex)
+    {
+        throw std::runtime_error(ex.what());
+    }
+
+    bool found_matrix() const { return m_found_matrix; }
+    bool found_rhs() const { return m_found_rhs; }
+
+private:
+    enum class Section { Root, Matrix, EncodedMatrix, Rhs, Dom };
+
+    template <typename T>
+    bool number(T val)
+    {
+        if (m_section == Section::Matrix && m_depth == 2) {
+            if (m_item == 0) {
+                m_rows = static_cast<Eigen::Index>(val);
+            } else if (m_item == 1) {
+                m_cols = static_cast<Eigen::Index>(val);
+            } else {
+                return error("invalid sparse matrix layout");
+            }
+            ++m_item;
+        } else if (m_section == Section::Matrix && m_depth == 3) {
+            if (m_k >= m_assembler->nonZeros()) {
+                return error("sparse matrix array overflow");
+            }
+            switch (m_item) {
+            case 2: m_assembler->set_row(m_k, static_cast<int>(val)); break;
+            case 3: m_assembler->set_col(m_k, static_cast<int>(val)); break;
+            default: m_assembler->set_value(m_k, static_cast<Scalar>(val)); break;
+            }
+            ++m_k;
+        } else if (m_section == Section::EncodedMatrix) {
+            if (m_field == "rows") {
+                m_encoded.rows = static_cast<Eigen::Index>(val);
+            } else if (m_field == "cols") {
+                m_encoded.cols = static_cast<Eigen::Index>(val);
+            } else if (m_field == "nnz") {
+                m_encoded.nnz = static_cast<Eigen::Index>(val);
+            } else if (m_field == "value_size") {
+                m_encoded.value_size = static_cast<int>(val);
+            }
+        } else if (m_section == Section::Rhs && m_depth == 2) {
+            // Single-column rhs stored as a flat array
+            if (m_rhs_cols < 0) {
+                resize_rhs(1);
+            } else if (m_rhs_cols != 1 || m_item >= m_rhs_rows) {
+                return error("inconsistent rhs layout");
+            }
+            m_system.b(m_item++, 0) = static_cast<Scalar>(val);
+        } else if (m_section == Section::Rhs && m_depth == 3) {
+            if (m_k >= m_rhs_cols || m_item >= m_rhs_rows) {
+                return error("inconsistent rhs layout");
+            }
+            m_system.b(m_item, m_k++) = static_cast<Scalar>(val);
+        } else {
+            return value(val);
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool value(T&& val)
+    {
+        if (m_section == Section::Dom) {
+            dom_add(json(std::forward<T>(val)));
+        } else if (m_section == Section::Root && m_depth == 1) {
+            // Scalar value at the root level
+            if (m_key == "metadata") {
+                m_system.metadata = json(std::forward<T>(val));
+            }
+        } else {
+            return error("unexpected value");
+        }
+        return true;
+    }
+
+    void resize_rhs(Eigen::Index cols)
+    {
+        m_rhs_cols = cols;
+        m_system.b.resize(m_rhs_rows, cols);
+    }
+
+    void start_dom(json&& root)
+    {
+        // Only the metadata is kept, other unknown entries are parsed and discarded
+        json* target = (m_key == "metadata" ? &m_system.metadata : &m_discarded);
+        *target = std::move(root);
+        m_dom = {target};
+        m_section = Section::Dom;
+    }
+
+    json* dom_add(json&& val)
+    {
+        json* parent = m_dom.back();
+        if (parent->is_array()) {
+            parent->push_back(std::move(val));
+            return &parent->back();
+        } else {
+            json& slot = (*parent)[m_dom_key];
+            slot = std::move(val);
+            return &slot;
+        }
+    }
+
+    void end_dom()
+    {
+        m_dom.pop_back();
+        if (m_dom.empty()) {
+            m_section = Section::Root;
+        }
+    }
+
+    bool error(const std::string& msg)
+    {
+        throw std::runtime_error("[load_compressed_system] Invalid archive: " + msg);
+    }
+
+private:
+    LinearSystem<Scalar>& m_system;
+
+    Section m_section = Section::Root;
+    int m_depth = 0;
+    std::string m_key;
+
+    // Sparse matrix and rhs decoding
+    std::optional<CscAssembler<Scalar>> m_assembler;
+    Eigen::Index m_rows = 0;
+    Eigen::Index m_cols = 0;
+    Eigen::Index m_rhs_rows = 0;
+    Eigen::Index m_rhs_cols = -1;
+    Eigen::Index m_item = 0;
+    Eigen::Index m_k = 0;
+    bool m_found_matrix = false;
+    bool m_found_rhs = false;
+
+    // Sparse matrix with compressed indices
+    EncodedSparseMatrix m_encoded;
+    std::string m_field;
+
+    // Generic json building for the metadata
+    std::vector<json*> m_dom;
+    std::string m_dom_key;
+    json m_discarded;
+};
+
+/// Decodes a zstd archive into a linear system. Returns false if A or b is missing.
+template <typename Scalar>
+bool decode_compressed_system(std::istream& compressed, LinearSystem<Scalar>& system)
+{
+    ZstdInputBuffer buffer(compressed);
+    std::istream stream(&buffer);
+    SystemSaxDecoder<Scalar> decoder(system);
+    nlohmann::json::sax_parse(stream, &decoder, nlohmann::json::input_format_t::msgpack);
+    return decoder.found_matrix() && decoder.found_rhs();
 }
 
 } // namespace
 
-void save_compressed(const std::filesystem::path& filename, const nlohmann::json& json)
+void save_compressed(
+    const std::filesystem::path& filename,
+    const nlohmann::json& json,
+    const CompressionOptions& options)
 {
     const auto ext = filename.extension();
     if (ext != ".zst") {
@@ -75,7 +430,7 @@ void save_compressed(const std::filesystem::path& filename, const nlohmann::json
         throw std::runtime_error("file `" + filename.string() + "` could not be opened");
     }
     spdlog::info("Converting to msgpack");
-    std::vector<uint8_t> msgpack = compress(nlohmann::json::to_msgpack(json));
+    std::vector<uint8_t> msgpack = compress(nlohmann::json::to_msgpack(json), options);
     spdlog::info("Saving to disk: {}", filename.filename().string());
     fl.write(reinterpret_cast<char*>(msgpack.data()), msgpack.size());
     spdlog::info("Done!");
@@ -91,10 +446,45 @@ nlohmann::json load_compressed(const std::filesystem::path& filename)
     if (!fl.is_open()) {
         throw std::runtime_error("file `" + filename.string() + "` could not be opened");
     }
-    static_assert(sizeof(char) == sizeof(uint8_t));
-    std::vector<char> msgpack(std::istreambuf_iterator<char>(fl), {});
-    return nlohmann::json::from_msgpack(decompress(msgpack));
+    ZstdInputBuffer buffer(fl);
+    std::istream stream(&buffer);
+    return nlohmann::json::from_msgpack(stream);
 }
 
+template <typename Scalar>
+LinearSystem<Scalar> load_compressed_system(const std::filesystem::path& filename)
+{
+    const auto ext = filename.extension();
+    if (ext != ".zst") {
+        spdlog::warn("Unexpected file extension: '{}' (should be .zst)", ext.string());
+    }
+    std::ifstream fl(filename, std::ios::in | std::ios::binary);
+    if (!fl.is_open()) {
+        throw std::runtime_error("file `" + filename.string() + "` could not be opened");
+    }
+    LinearSystem<Scalar> system;
+    if (!decode_compressed_system(fl, system)) {
+        throw std::runtime_error(
+            "file `" + filename.string() + "` does not contain a linear system");
+    }
+    return system;
+}
+
+template <typename Scalar>
+LinearSystem<Scalar> load_compressed_system(std::istream& compressed)
+{
+    LinearSystem<Scalar> system;
+    if (!decode_compressed_system(compressed, system)) {
+        throw std::runtime_error(
+            "[load_compressed_system] Archive does not contain a linear system");
+    }
+    return system;
+}
+
+template LinearSystem<float> load_compressed_system(const std::filesystem::path&);
+template LinearSystem<double> load_compressed_system(const std::filesystem::path&);
+template LinearSystem<float> load_compressed_system(std::istream&);
+template LinearSystem<double> load_compressed_system(std::istream&);
+
 } // namespace io
 } // namespace benchy
@@ -11,79 +11,504 @@
  */
 #include <benchy/io/load_problem.h>
 
+#include <benchy/io/csc_assembler.h>
 #include <benchy/io/json_eigen.h>
+#include <benchy/io/mapped_file.h>
 
 #include <Eigen/Sparse>
 
-#include <fstream>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
 
 namespace benchy {
 namespace io {
 
 namespace {
 
-template <typename Scalar>
-Eigen::SparseMatrix<Scalar> load_matrix(const nlohmann::json& data)
+///
+/// Parses a hexfloat in the canonical form written by `std::hexfloat` (e.g. "-0x1.8p+1") with at
+/// most 14 significant hex digits, i.e. any float or double written by `save_problem()`. The
+/// mantissa fits exactly in a double, so the result is correctly rounded.
+///
+/// @return     False if the string is not in that form, in which case `value` is left untouched.
+///
+bool parse_hexfloat(const char* first, const char* last, double& value)
 {
-    std::vector<Eigen::Triplet<Scalar>> triplets;
-    triplets.reserve(data["triplets"].size());
-    for (int i = 0; i < data["triplets"].size(); ++i) {
-        const auto& entry = data["triplets"][i];
-        const int row = entry[0];
-        const int col = entry[1];
-        if (entry.size() != 3) {
-            throw std::runtime_error("Invalid triplet size");
-        }
-        if constexpr (std::is_same_v<Scalar, float>) {
-            triplets.emplace_back(row, col, std::stof(entry[2].get<std::string>()));
+    bool negative = false;
+    if (first != last && (*first == '-' || *first == '+')) {
+        negative = (*first == '-');
+        ++first;
+    }
+    if (last - first < 3 || first[0] != '0' || (first[1] != 'x' && first[1] != 'X')) {
+        return false;
+    }
+    first += 2;
+
+    uint64_t mantissa = 0;
+    int num_digits = 0;
+    int exponent = 0;
+    bool has_digits = false;
+    bool has_dot = false;
+    for (; first != last; ++first) {
+        const char c = *first;
+        int digit = 0;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else if (c == '.' && !has_dot) {
+            has_dot = true;
+            continue;
         } else {
-            triplets.emplace_back(row, col, std::stod(entry[2].get<std::string>()));
+            break;
+        }
+        has_digits = true;
+        if (has_dot) {
+            exponent -= 4;
+        }
+        if (mantissa == 0 && digit == 0) {
+            continue;
+        }
+        if (++num_digits > 14) {
+            return false;
+        }
+        mantissa = mantissa * 16 + digit;
+    }
+    if (!has_digits || first == last || (*first != 'p' && *first != 'P')) {
+        return false;
+    }
+    ++first;
+
+    bool negative_exponent = false;
+    if (first != last && (*first == '-' || *first == '+')) {
+        negative_exponent = (*first == '-');
+        ++first;
+    }
+    if (first == last) {
+        return false;
+    }
+    int binary_exponent = 0;
+    for (; first != last; ++first) {
+        if (*first < '0' || *first > '9' || binary_exponent > 100000) {
+            return false;
         }
+        binary_exponent = binary_exponent * 10 + (*first - '0');
+    }
+    exponent += (negative_exponent ? -binary_exponent : binary_exponent);
+
+    const double result = std::ldexp(static_cast<double>(mantissa), exponent);
+    value = (negative ? -result : result);
+    return true;
+}
+
+///
+/// Parses a scalar written by `save_problem()` with `std::hexfloat`. Other representations
+/// (decimal values, "inf", "nan", non-canonical hexfloats) go through the standard library.
+/// Values are always parsed in double precision, which is exact for both float and double dumps.
+///
+double parse_scalar(const std::string& str)
+{
+    const char* first = str.data();
+    const char* last = first + str.size();
+    double value = 0;
+    if (parse_hexfloat(first, last, value)) {
+        return value;
+    }
+#if defined(__cpp_lib_to_chars)
+    // std::from_chars does not accept a leading '+' or the "0x" prefix of hexfloats
+    bool negative = false;
+    if (first != last && (*first == '-' || *first == '+')) {
+        negative = (*first == '-');
+        ++first;
+    }
+    auto format = std::chars_format::general;
+    if (last - first > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X')) {
+        first += 2;
+        format = std::chars_format::hex;
+    }
+    const auto [ptr, ec] = std::from_chars(first, last, value, format);
+    if (ec != std::errc() || ptr != last || first == last) {
+        throw std::runtime_error("[load_problem] Invalid scalar value: '" + str + "'");
+    }
+    return negative ? -value : value;
+#else
+    char* end = nullptr;
+    value = std::strtod(first, &end);
+    if (end != last || first == last) {
+        throw std::runtime_error("[load_problem] Invalid scalar value: '" + str + "'");
     }
-    Eigen::SparseMatrix<Scalar> A(data["rows"], data["cols"]);
-    A.setFromTriplets(triplets.begin(), triplets.end());
-    return A;
+    return value;
+#endif
 }
 
+///
+/// SAX handler decoding the json text written by `save_problem()` straight into Eigen storage.
+///
+/// The file contains `{"metadata": {...}, "A": {"rows": m, "cols": n, "nnz": k, "triplets":
+/// [[row, col, "value"], ...]}, "b": ["value", ...]}`. Triplets are written into a CscAssembler
+/// sized from "rows", "cols" and "nnz", which `save_problem()` writes before the triplets; if a
+/// file lists them afterwards, the triplets are buffered instead. The metadata object is built as
+/// a regular json DOM, and other unknown entries are discarded.
+///
 template <typename Scalar>
-Eigen::VectorX<Scalar> load_vector(const nlohmann::json& data)
+class ProblemSaxDecoder
 {
-    Eigen::VectorX<Scalar> res(data.size());
-    for (int i = 0; i < data.size(); ++i) {
-        if constexpr (std::is_same_v<Scalar, float>) {
-            res[i] = std::stof(data[i].get<std::string>());
+public:
+    using json = nlohmann::json;
+
+    explicit ProblemSaxDecoder(LinearSystem<Scalar>& system)
+        : m_system(system)
+    {}
+
+    bool null() { return value(nullptr); }
+    bool boolean(bool val) { return value(val); }
+    bool number_integer(json::number_integer_t val) { return number(val); }
+    bool number_unsigned(json::number_unsigned_t val) { return number(val); }
+    bool number_float(json::number_float_t val, const json::string_t&) { return number(val); }
+    bool binary(json::binary_t& val) { return value(std::move(val)); }
+
+    bool string(json::string_t& val)
+    {
+        if (m_section == Section::Triplets && m_depth == 4) {
+            return number(parse_scalar(val));
+        } else if (m_section == Section::Rhs) {
+            return number(parse_scalar(val));
+        }
+        return value(std::move(val));
+    }
+
+    bool start_object(std::size_t)
+    {
+        if (m_section == Section::Root && m_depth == 0) {
+            m_depth = 1;
+        } else if (m_section == Section::Root && m_depth == 1) {
+            if (m_key == "A") {
+                m_section = Section::Matrix;
+                m_found_matrix = true;
+                m_depth = 2;
+            } else {
+                start_dom(json::object());
+            }
+        } else if (m_section == Section::Dom) {
+            m_dom.push_back(dom_add(json::object()));
+        } else if (m_section == Section::Matrix) {
+            // Unknown object inside "A"
+            start_dom(json::object());
         } else {
-            res[i] = std::stod(data[i].get<std::string>());
+            return error("unexpected object");
         }
+        return true;
     }
-    return res;
-}
+
+    bool key(json::string_t& val)
+    {
+        if ((m_section == Section::Root && m_depth == 1) || m_section == Section::Matrix) {
+            m_key = std::move(val);
+        } else if (m_section == Section::Dom) {
+            m_dom_key = std::move(val);
+        } else {
+            return error("unexpected key");
+        }
+        return true;
+    }
+
+    bool end_object()
+    {
+        if (m_section == Section::Dom) {
+            end_dom();
+        } else if (m_section == Section::Matrix) {
+            finalize_matrix();
+            m_section = Section::Root;
+            m_depth = 1;
+        } else if (m_section == Section::Root && m_depth == 1) {
+            m_depth = 0;
+        } else {
+            return error("unexpected end of object");
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t)
+    {
+        if (m_section == Section::Root && m_depth == 1) {
+            if (m_key == "b") {
+                m_section = Section::Rhs;
+                m_found_rhs = true;
+                m_rhs.clear();
+                m_rhs_rows = 0;
+                m_rhs_cols = -1;
+                m_depth = 2;
+            } else {
+                start_dom(json::array());
+            }
+        } else if (m_section == Section::Matrix && m_key == "triplets") {
+            if (m_rows >= 0 && m_cols >= 0 && m_nnz >= 0) {
+                m_assembler.emplace(m_rows, m_cols, m_nnz);
+            }
+            m_section = Section::Triplets;
+            m_k = 0;
+            m_depth = 3;
+        } else if (m_section == Section::Triplets && m_depth == 3) {
+            m_item = 0;
+            m_depth = 4;
+        } else if (m_section == Section::Rhs && m_depth == 2) {
+            // Multiple rhs are stored row by row, as in json_eigen.h
+            if (m_rhs_rows == 0 && !m_rhs.empty()) {
+                return error("inconsistent rhs layout");
+            }
+            m_item = 0;
+            m_depth = 3;
+        } else if (m_section == Section::Dom) {
+            m_dom.push_back(dom_add(json::array()));
+        } else if (m_section == Section::Matrix) {
+            // Unknown array inside "A"
+            start_dom(json::array());
+        } else {
+            return error("unexpected array");
+        }
+        return true;
+    }
+
+    bool end_array()
+    {
+        if (m_section == Section::Triplets && m_depth == 4) {
+            if (m_item != 3) {
+                return error("invalid triplet size");
+            }
+            ++m_k;
+            m_depth = 3;
+        } else if (m_section == Section::Triplets && m_depth == 3) {
+            if (m_assembler && m_k != m_assembler->nonZeros()) {
+                return error("number of triplets does not match nnz");
+            }
+            m_section = Section::Matrix;
+            m_depth = 2;
+        } else if (m_section == Section::Rhs && m_depth == 3) {
+            if (m_rhs_cols < 0) {
+                m_rhs_cols = m_item;
+            } else if (m_item != m_rhs_cols) {
+                return error("inconsistent rhs layout");
+            }
+            ++m_rhs_rows;
+            m_depth = 2;
+        } else if (m_section == Section::Rhs) {
+            if (m_rhs_rows > 0) {
+                using RowMajorMatrix =
+                    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+                m_system.b = Eigen::Map<const RowMajorMatrix>(m_rhs.data(), m_rhs_rows, m_rhs_cols);
+            } else {
+                m_system.b = Eigen::Map<const Eigen::VectorX<Scalar>>(
+                    m_rhs.data(),
+                    static_cast<Eigen::Index>(m_rhs.size()));
+            }
+            m_rhs = {};
+            m_section = Section::Root;
+            m_depth = 1;
+        } else if (m_section == Section::Dom) {
+            end_dom();
+        } else {
+            return error("unexpected end of array");
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const json::exception& ex)
+    {
+        throw std::runtime_error(ex.what());
+    }
+
+    bool found_matrix() const { return m_found_matrix; }
+    bool found_rhs() const { return m_found_rhs; }
+
+private:
+    enum class Section { Root, Matrix, Triplets, Rhs, Dom };
+
+    template <typename T>
+    bool number(T val)
+    {
+        if (m_section == Section::Triplets && m_depth == 4) {
+            if (m_assembler && m_k >= m_assembler->nonZeros()) {
+                return error("number of triplets does not match nnz");
+            }
+            switch (m_item++) {
+            case 0: m_row = static_cast<int>(val); break;
+            case 1: m_col = static_cast<int>(val); break;
+            case 2:
+                if (m_assembler) {
+                    m_assembler->set(m_k, m_row, m_col, static_cast<Scalar>(val));
+                } else {
+                    m_triplets.emplace_back(m_row, m_col, static_cast<Scalar>(val));
+                }
+                break;
+            default: return error("invalid triplet size");
+            }
+        } else if (m_section == Section::Rhs) {
+            if (m_depth == 2 && m_rhs_rows > 0) {
+                return error("inconsistent rhs layout");
+            }
+            m_rhs.push_back(static_cast<Scalar>(val));
+            ++m_item;
+        } else if (m_section == Section::Matrix) {
+            if (m_key == "rows") {
+                m_rows = static_cast<Eigen::Index>(val);
+            } else if (m_key == "cols") {
+                m_cols = static_cast<Eigen::Index>(val);
+            } else if (m_key == "nnz") {
+                m_nnz = static_cast<Eigen::Index>(val);
+            }
+        } else {
+            return value(val);
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool value(T&& val)
+    {
+        if (m_section == Section::Dom) {
+            dom_add(json(std::forward<T>(val)));
+        } else if (
+            (m_section == Section::Root && m_depth == 1) || m_section == Section::Matrix) {
+            // Unknown scalar entry, ignored
+        } else {
+            return error("unexpected value");
+        }
+        return true;
+    }
+
+    void finalize_matrix()
+    {
+        if (m_rows < 0 || m_cols < 0) {
+            error("missing matrix dimensions");
+        }
+        if (m_assembler) {
+            m_system.A = m_assembler->finalize();
+            m_assembler.reset();
+        } else {
+            m_system.A.resize(m_rows, m_cols);
+            m_system.A.setFromTriplets(m_triplets.begin(), m_triplets.end());
+            m_triplets = {};
+        }
+    }
+
+    void start_dom(json&& root)
+    {
+        // Only the metadata is kept, other unknown entries are parsed and discarded
+        const bool is_metadata = (m_section == Section::Root && m_key == "metadata");
+        json* target = (is_metadata ? &m_system.metadata : &m_discarded);
+        *target = std::move(root);
+        m_dom = {target};
+        m_dom_parent = m_section;
+        m_section = Section::Dom;
+    }
+
+    json* dom_add(json&& val)
+    {
+        json* parent = m_dom.back();
+        if (parent->is_array()) {
+            parent->push_back(std::move(val));
+            return &parent->back();
+        } else {
+            json& slot = (*parent)[m_dom_key];
+            slot = std::move(val);
+            return &slot;
+        }
+    }
+
+    void end_dom()
+    {
+        m_dom.pop_back();
+        if (m_dom.empty()) {
+            m_section = m_dom_parent;
+        }
+    }
+
+    bool error(const std::string& msg)
+    {
+        throw std::runtime_error("[load_problem] Invalid problem file: " + msg);
+    }
+
+private:
+    LinearSystem<Scalar>& m_system;
+
+    Section m_section = Section::Root;
+    int m_depth = 0;
+    std::string m_key;
+
+    // Sparse matrix and rhs decoding
+    std::optional<CscAssembler<Scalar>> m_assembler;
+    std::vector<Eigen::Triplet<Scalar>> m_triplets;
+    std::vector<Scalar> m_rhs;
+    Eigen::Index m_rhs_rows = 0;
+    Eigen::Index m_rhs_cols = -1;
+    Eigen::Index m_rows = -1;
+    Eigen::Index m_cols = -1;
+    Eigen::Index m_nnz = -1;
+    Eigen::Index m_k = 0;
+    int m_item = 0;
+    int m_row = 0;
+    int m_col = 0;
+    bool m_found_matrix = false;
+    bool m_found_rhs = false;
+
+    // Generic json building for the metadata
+    std::vector<json*> m_dom;
+    std::string m_dom_key;
+    Section m_dom_parent = Section::Root;
+    json m_discarded;
+};
 
 } // namespace
 
-// Decompress a zstd archive and load uncompressed messagepack as json
-nlohmann::json load_problem(const std::filesystem::path& filename)
+template <typename Scalar>
+LinearSystem<Scalar> load_problem_system(const std::filesystem::path& filename)
 {
-    nlohmann::json data = nlohmann::json::parse(std::ifstream(filename));
-    nlohmann::json& metadata = data["metadata"];
-    if (!metadata.contains("raw_dump_version")) {
+    const MappedFile file(filename);
+    const char* begin = reinterpret_cast<const char*>(file.data());
+
+    LinearSystem<Scalar> system;
+    ProblemSaxDecoder<Scalar> decoder(system);
+    nlohmann::json::sax_parse(begin, begin + file.size(), &decoder);
+    if (!decoder.found_matrix() || !decoder.found_rhs()) {
+        throw std::runtime_error(
+            "file `" + filename.string() + "` does not contain a linear system");
+    }
+
+    nlohmann::json& metadata = system.metadata;
+    if (!metadata.is_object() || !metadata.contains("raw_dump_version")) {
         throw std::runtime_error(
             "Attempting to read a problem that was not saved with `save_problem()`");
     }
-    int version_number = metadata["raw_dump_version"];
-    metadata["version_number"] = version_number;
+    metadata["version_number"] = metadata["raw_dump_version"];
     metadata.erase("raw_dump_version");
+    return system;
+}
 
-    if (metadata["scalar_type"] == "double") {
-        data["A"] = load_matrix<double>(data["A"]);
-        data["b"] = load_vector<double>(data["b"]);
+nlohmann::json load_problem(const std::filesystem::path& filename)
+{
+    // Values are decoded in double precision and converted back to the scalar type of the file
+    auto system = load_problem_system<double>(filename);
+    nlohmann::json data;
+    if (system.metadata.value("scalar_type", "double") == "double") {
+        data = system;
     } else {
-        data["A"] = load_matrix<float>(data["A"]);
-        data["b"] = load_vector<float>(data["b"]);
+        data["A"] = Eigen::SparseMatrix<float>(system.A.cast<float>());
+        data["b"] = Eigen::MatrixX<float>(system.b.cast<float>());
+        data["metadata"] = std::move(system.metadata);
     }
-
     return data;
 }
 
+template LinearSystem<float> load_problem_system(const std::filesystem::path&);
+template LinearSystem<double> load_problem_system(const std::filesystem::path&);
+
 } // namespace io
 } // namespace benchy
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#include <benchy/io/load_system.h>
+
+#include <benchy/io/binary_io.h>
+#include <benchy/io/hdf5_store.h>
+#include <benchy/io/json_io.h>
+#include <benchy/io/load_problem.h>
+#include <benchy/io/pack_io.h>
+#include <benchy/io/sequence_io.h>
+
+namespace benchy {
+namespace io {
+
+template <typename Scalar>
+LinearSystem<Scalar> load_system(const std::filesystem::path& filename)
+{
+    std::filesystem::path pack;
+    std::string name;
+    if (split_pack_path(filename, pack, name)) {
+        const auto mapped = open_pack(pack);
+        return mapped->template load<Scalar>(mapped->index_of(name));
+    }
+#ifdef BENCHY_WITH_HDF5
+    std::filesystem::path store;
+    if (split_store_path(filename, store, name)) {
+        return open_store(store)->template read<Scalar>(name);
+    }
+#endif
+    const auto ext = filename.extension();
+    if (ext == ".bcsc") {
+        return load_binary<Scalar>(filename);
+    } else if (ext == ".bseq") {
+        return load_sequence_step<Scalar>(filename, 0);
+    } else if (ext == ".zst") {
+        return load_compressed_system<Scalar>(filename);
+    } else {
+        return load_problem_system<Scalar>(filename);
+    }
+}
+
+template LinearSystem<float> load_system(const std::filesystem::path&);
+template LinearSystem<double> load_system(const std::filesystem::path&);
+
+} // namespace io
+} // namespace benchy
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#include <benchy/io/mapped_file.h>
+
+#include <spdlog/spdlog.h>
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace benchy {
+namespace io {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::filesystem::path& filename)
+{
+    HANDLE file = CreateFileW(
+        filename.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("file `" + filename.string() + "` could not be opened");
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error("file `" + filename.string() + "` could not be stat'ed");
+    }
+    m_file = file;
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0) {
+        return;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        throw std::runtime_error("file `" + filename.string() + "` could not be mapped");
+    }
+    m_mapping = mapping;
+    m_data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("file `" + filename.string() + "` could not be mapped");
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& filename)
+{
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("file `" + filename.string() + "` could not be opened");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("file `" + filename.string() + "` could not be stat'ed");
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size > 0) {
+        void* ptr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("file `" + filename.string() + "` could not be mapped");
+        }
+        m_data = static_cast<const std::byte*>(ptr);
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    spdlog::debug("Mapped {} bytes from {}", m_size, filename.string());
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data) {
+        ::munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+}
+
+#endif
+
+} // namespace io
+} // namespace benchy
@@ -0,0 +1,622 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#include <benchy/io/matrix_market.h>
+
+#include <benchy/io/mapped_file.h>
+#include <benchy/io/symmetric_storage.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace benchy {
+namespace io {
+
+namespace {
+
+using StorageIndex = int;
+
+[[noreturn]] void error(const std::string& msg)
+{
+    throw std::runtime_error("[load_matrix_market] " + msg);
+}
+
+enum class Field { Real, Integer, Pattern };
+enum class Symmetry { General, Symmetric };
+
+///
+/// Banner and size line of a Matrix Market file.
+///
+struct Header
+{
+    bool coordinate = true;
+    Field field = Field::Real;
+    Symmetry symmetry = Symmetry::General;
+    int64_t rows = 0;
+    int64_t cols = 0;
+    int64_t entries = 0;
+
+    /// Comment lines, without their leading '%'.
+    std::string comments;
+
+    /// First byte after the size line.
+    const char* data = nullptr;
+};
+
+/// A line of a coordinate file, with 0-based indices.
+struct Entry
+{
+    int64_t row = 0;
+    int64_t col = 0;
+    double value = 1;
+};
+
+/// How the value token of a line is handled.
+enum class ValueMode { Parse, Skip, None };
+
+const char* skip_blanks(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        ++p;
+    }
+    return p;
+}
+
+const char* end_of_line(const char* p, const char* end)
+{
+    const void* eol = std::memchr(p, '\n', end - p);
+    return eol ? static_cast<const char*>(eol) : end;
+}
+
+std::string lowercase(std::string str)
+{
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return str;
+}
+
+void parse_integer(const char*& p, const char* end, int64_t& value)
+{
+    p = skip_blanks(p, end);
+    const auto [ptr, ec] = std::from_chars(p, end, value);
+    if (ec != std::errc() || ptr == p) {
+        error("Invalid integer: '" + std::string(p, end_of_line(p, end)) + "'");
+    }
+    p = ptr;
+}
+
+void parse_value(const char*& p, const char* end, double& value)
+{
+    p = skip_blanks(p, end);
+    // std::from_chars does not accept a leading '+'
+    const char* first = (p < end && *p == '+') ? p + 1 : p;
+#if defined(__cpp_lib_to_chars)
+    const auto [ptr, ec] = std::from_chars(first, end, value);
+    if (ec != std::errc() || ptr == first) {
+        error("Invalid value: '" + std::string(p, end_of_line(p, end)) + "'");
+    }
+#else
+    // The mapping is not null-terminated, so the token is copied first
+    const char* last = first;
+    while (last < end && !std::isspace(static_cast<unsigned char>(*last))) {
+        ++last;
+    }
+    const std::string token(first, last);
+    char* token_end = nullptr;
+    value = std::strtod(token.c_str(), &token_end);
+    if (token.empty() || token_end != token.c_str() + token.size()) {
+        error("Invalid value: '" + std::string(p, end_of_line(p, end)) + "'");
+    }
+    const char* ptr = last;
+#endif
+    p = ptr;
+}
+
+///
+/// Parses the next non-empty line of a coordinate file.
+///
+/// @param[in,out] p      Current position, moved to the start of the next line.
+/// @param[in]     end    End of the block of lines.
+/// @param[in]     mode   Whether to parse, skip or not expect a value.
+/// @param[in]     header Header of the file, for bounds checks and symmetry.
+/// @param[out]    entry  Parsed entry. Entries of symmetric matrices are moved to the lower
+///                       triangle.
+///
+/// @return        False once the end of the block is reached.
+///
+bool parse_entry(
+    const char*& p,
+    const char* end,
+    ValueMode mode,
+    const Header& header,
+    Entry& entry)
+{
+    while (true) {
+        p = skip_blanks(p, end);
+        if (p == end) {
+            return false;
+        }
+        if (*p != '\n') {
+            break;
+        }
+        ++p;
+    }
+
+    int64_t row = 0;
+    int64_t col = 0;
+    parse_integer(p, end, row);
+    parse_integer(p, end, col);
+    if (row < 1 || row > header.rows || col < 1 || col > header.cols) {
+        error(fmt::format("Entry ({}, {}) is out of bounds", row, col));
+    }
+    entry.row = row - 1;
+    entry.col = col - 1;
+    if (header.symmetry == Symmetry::Symmetric && entry.row < entry.col) {
+        std::swap(entry.row, entry.col);
+    }
+
+    if (mode == ValueMode::Parse) {
+        parse_value(p, end, entry.value);
+    } else if (mode == ValueMode::Skip) {
+        p = end_of_line(p, end);
+    }
+    p = skip_blanks(p, end);
+    if (p < end && *p != '\n') {
+        error("Unexpected token: '" + std::string(p, end_of_line(p, end)) + "'");
+    }
+    if (p < end) {
+        ++p;
+    }
+    return true;
+}
+
+Header parse_header(const char* begin, const char* end)
+{
+    Header header;
+    const char* p = begin;
+    const char* eol = end_of_line(p, end);
+    std::vector<std::string> banner;
+    for (const char* q = p; q < eol;) {
+        q = skip_blanks(q, eol);
+        const char* token = q;
+        while (q < eol && *q != ' ' && *q != '\t' && *q != '\r') {
+            ++q;
+        }
+        if (q > token) {
+            banner.push_back(lowercase(std::string(token, q)));
+        }
+    }
+    if (banner.size() != 5 || banner[0] != "%%matrixmarket" || banner[1] != "matrix") {
+        error("Not a Matrix Market file: '" + std::string(p, eol) + "'");
+    }
+    if (banner[2] == "coordinate" || banner[2] == "array") {
+        header.coordinate = (banner[2] == "coordinate");
+    } else {
+        error("Unsupported format: " + banner[2]);
+    }
+    if (banner[3] == "real" || banner[3] == "double") {
+        header.field = Field::Real;
+    } else if (banner[3] == "integer") {
+        header.field = Field::Integer;
+    } else if (banner[3] == "pattern" && header.coordinate) {
+        header.field = Field::Pattern;
+    } else {
+        error("Unsupported field: " + banner[3]);
+    }
+    if (banner[4] == "general") {
+        header.symmetry = Symmetry::General;
+    } else if (banner[4] == "symmetric") {
+        header.symmetry = Symmetry::Symmetric;
+    } else {
+        error("Unsupported symmetry: " + banner[4]);
+    }
+
+    // Comments, then the size line
+    for (p = eol; p < end;) {
+        p = skip_blanks(p + (*p == '\n'), end);
+        eol = end_of_line(p, end);
+        if (p == eol) {
+            continue;
+        } else if (*p == '%') {
+            const char* comment = p + 1;
+            while (comment < eol && *comment == '%') {
+                ++comment;
+            }
+            comment = skip_blanks(comment, eol);
+            const char* last = eol;
+            while (last > comment && (last[-1] == '\r' || last[-1] == ' ')) {
+                --last;
+            }
+            header.comments += (header.comments.empty() ? "" : "\n") + std::string(comment, last);
+            p = eol;
+        } else {
+            break;
+        }
+    }
+    if (p >= end) {
+        error("Missing size line");
+    }
+    parse_integer(p, eol, header.rows);
+    parse_integer(p, eol, header.cols);
+    if (header.coordinate) {
+        parse_integer(p, eol, header.entries);
+    } else {
+        header.entries = header.rows * header.cols;
+    }
+    if (header.rows < 0 || header.cols < 0 || header.entries < 0 ||
+        skip_blanks(p, eol) != eol) {
+        error("Invalid size line");
+    }
+    if (header.symmetry == Symmetry::Symmetric && header.rows != header.cols) {
+        error("A symmetric matrix must be square");
+    }
+    header.data = (eol < end ? eol + 1 : end);
+    return header;
+}
+
+size_t num_threads(const MatrixMarketOptions& options)
+{
+    return options.num_threads > 0 ? options.num_threads
+                                   : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Runs func(i) for i in [0, num_tasks), on up to num_threads threads
+template <typename Func>
+void parallel_for(size_t num_tasks, size_t num_threads, const Func& func)
+{
+    num_threads = std::min(num_threads, num_tasks);
+    if (num_threads <= 1) {
+        for (size_t i = 0; i < num_tasks; ++i) {
+            func(i);
+        }
+        return;
+    }
+    std::atomic<size_t> next(0);
+    std::exception_ptr exception;
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&] {
+            for (size_t i = next++; i < num_tasks; i = next++) {
+                try {
+                    func(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    exception = std::current_exception();
+                    next = num_tasks;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+// Splits [begin, end) into blocks of whole lines of about chunk_size bytes
+std::vector<std::pair<const char*, const char*>>
+split_lines(const char* begin, const char* end, size_t chunk_size)
+{
+    std::vector<std::pair<const char*, const char*>> chunks;
+    const char* p = begin;
+    while (p < end) {
+        const char* last = end;
+        if (static_cast<size_t>(end - p) > chunk_size) {
+            last = end_of_line(p + chunk_size, end);
+            last += (last < end);
+        }
+        chunks.emplace_back(p, last);
+        p = last;
+    }
+    return chunks;
+}
+
+///
+/// Parses the entries of a coordinate file straight into CSC storage.
+///
+template <typename Scalar>
+Eigen::SparseMatrix<Scalar, Eigen::ColMajor>
+load_sparse(const Header& header, const char* end, const MatrixMarketOptions& options)
+{
+    constexpr int64_t max_index = std::numeric_limits<StorageIndex>::max();
+    if (header.rows > max_index || header.cols > max_index || header.entries > max_index) {
+        error("Matrix is too large for 32-bit indices");
+    }
+    const size_t threads = num_threads(options);
+    const auto chunks = split_lines(header.data, end, std::max<size_t>(options.chunk_size, 1));
+    const bool pattern = (header.field == Field::Pattern);
+    const ValueMode value_mode = (pattern ? ValueMode::None : ValueMode::Parse);
+    const ValueMode skip_mode = (pattern ? ValueMode::None : ValueMode::Skip);
+
+    // First pass: count the entries of each block, and check whether they are sorted by column
+    // and then by row
+    struct Block
+    {
+        int64_t count = 0;
+        bool sorted = true;
+        Entry first;
+        Entry last;
+    };
+    auto precedes = [](const Entry& a, const Entry& b) {
+        return a.col < b.col || (a.col == b.col && a.row < b.row);
+    };
+    std::vector<Block> blocks(chunks.size());
+    parallel_for(chunks.size(), threads, [&](size_t i) {
+        Block& block = blocks[i];
+        const char* p = chunks[i].first;
+        Entry entry;
+        while (parse_entry(p, chunks[i].second, skip_mode, header, entry)) {
+            if (block.count == 0) {
+                block.first = entry;
+            } else if (!precedes(block.last, entry)) {
+                block.sorted = false;
+            }
+            block.last = entry;
+            ++block.count;
+        }
+    });
+
+    std::vector<int64_t> offsets(blocks.size() + 1, 0);
+    bool sorted = true;
+    const Block* previous = nullptr;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        offsets[i + 1] = offsets[i] + blocks[i].count;
+        if (blocks[i].count > 0) {
+            sorted = sorted && blocks[i].sorted &&
+                     (previous == nullptr || precedes(previous->last, blocks[i].first));
+            previous = &blocks[i];
+        }
+    }
+    if (offsets.back() != header.entries) {
+        error(fmt::format("Expected {} entries, found {}", header.entries, offsets.back()));
+    }
+
+    Eigen::SparseMatrix<Scalar, Eigen::ColMajor> A(header.rows, header.cols);
+    A.resizeNonZeros(header.entries);
+    StorageIndex* outer = A.outerIndexPtr();
+    StorageIndex* inner = A.innerIndexPtr();
+    Scalar* values = A.valuePtr();
+    std::fill(outer, outer + header.cols + 1, StorageIndex(0));
+
+    if (sorted) {
+        // Entries are written at their position in the file. The end of each column is written
+        // by the block where the next column starts, so each slot of `outer` has a single writer.
+        parallel_for(chunks.size(), threads, [&](size_t i) {
+            const char* p = chunks[i].first;
+            int64_t k = offsets[i];
+            Entry entry;
+            int64_t col = -1;
+            while (parse_entry(p, chunks[i].second, value_mode, header, entry)) {
+                if (col >= 0 && entry.col != col) {
+                    outer[col + 1] = static_cast<StorageIndex>(k);
+                }
+                col = entry.col;
+                inner[k] = static_cast<StorageIndex>(entry.row);
+                values[k] = static_cast<Scalar>(entry.value);
+                ++k;
+            }
+        });
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            if (blocks[i].count > 0) {
+                StorageIndex& last = outer[blocks[i].last.col + 1];
+                last = std::max(last, static_cast<StorageIndex>(offsets[i + 1]));
+            }
+        }
+        for (int64_t j = 0; j < header.cols; ++j) {
+            outer[j + 1] = std::max(outer[j + 1], outer[j]);
+        }
+        return A;
+    }
+
+    // Otherwise, count the entries of each column, scatter the entries, then sort each column
+    spdlog::debug("Entries are not sorted by column, sorting them");
+    std::vector<std::atomic<StorageIndex>> cursors(header.cols);
+    parallel_for(chunks.size(), threads, [&](size_t i) {
+        const char* p = chunks[i].first;
+        Entry entry;
+        while (parse_entry(p, chunks[i].second, skip_mode, header, entry)) {
+            cursors[entry.col].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    for (int64_t j = 0; j < header.cols; ++j) {
+        outer[j + 1] = outer[j] + cursors[j].load(std::memory_order_relaxed);
+        cursors[j].store(outer[j], std::memory_order_relaxed);
+    }
+    parallel_for(chunks.size(), threads, [&](size_t i) {
+        const char* p = chunks[i].first;
+        Entry entry;
+        while (parse_entry(p, chunks[i].second, value_mode, header, entry)) {
+            const StorageIndex k = cursors[entry.col].fetch_add(1, std::memory_order_relaxed);
+            inner[k] = static_cast<StorageIndex>(entry.row);
+            values[k] = static_cast<Scalar>(entry.value);
+        }
+    });
+
+    const size_t num_column_blocks = std::max<size_t>(threads * 8, 1);
+    const int64_t block_size = (header.cols + num_column_blocks - 1) / num_column_blocks;
+    std::atomic<bool> has_duplicates(false);
+    parallel_for(num_column_blocks, threads, [&](size_t b) {
+        std::vector<std::pair<StorageIndex, Scalar>> column;
+        const int64_t last = std::min<int64_t>((b + 1) * block_size, header.cols);
+        for (int64_t j = b * block_size; j < last; ++j) {
+            column.clear();
+            for (StorageIndex k = outer[j]; k < outer[j + 1]; ++k) {
+                column.emplace_back(inner[k], values[k]);
+            }
+            std::sort(column.begin(), column.end(), [](const auto& x, const auto& y) {
+                return x.first < y.first;
+            });
+            for (size_t k = 0; k < column.size(); ++k) {
+                inner[outer[j] + k] = column[k].first;
+                values[outer[j] + k] = column[k].second;
+                if (k > 0 && column[k].first == column[k - 1].first) {
+                    has_duplicates = true;
+                }
+            }
+        }
+    });
+
+    if (has_duplicates) {
+        spdlog::warn("Summing duplicate entries");
+        StorageIndex k = 0;
+        StorageIndex begin = 0;
+        for (int64_t j = 0; j < header.cols; ++j) {
+            const StorageIndex start = k;
+            const StorageIndex stop = outer[j + 1];
+            for (StorageIndex i = begin; i < stop; ++i) {
+                if (k > start && inner[k - 1] == inner[i]) {
+                    values[k - 1] += values[i];
+                } else {
+                    inner[k] = inner[i];
+                    values[k] = values[i];
+                    ++k;
+                }
+            }
+            outer[j + 1] = k;
+            begin = stop;
+        }
+        A.resizeNonZeros(k);
+    }
+    return A;
+}
+
+///
+/// Reads a dense matrix stored in array format, or in coordinate format.
+///
+template <typename Scalar>
+Eigen::MatrixX<Scalar> load_dense(
+    const std::filesystem::path& filename,
+    const MatrixMarketOptions& options)
+{
+    const MappedFile file(filename);
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    const char* end = begin + file.size();
+    const Header header = parse_header(begin, end);
+    if (header.coordinate) {
+        return load_sparse<Scalar>(header, end, options).toDense();
+    }
+    if (header.symmetry != Symmetry::General) {
+        error("Dense matrices must be general");
+    }
+
+    // Stored in column-major order, one value per line
+    Eigen::MatrixX<Scalar> b(header.rows, header.cols);
+    const char* p = header.data;
+    for (Eigen::Index k = 0; k < b.size(); ++k) {
+        while (p < end && std::isspace(static_cast<unsigned char>(*p))) {
+            ++p;
+        }
+        if (p == end) {
+            error(fmt::format("Expected {} values, found {}", b.size(), k));
+        }
+        double value = 0;
+        parse_value(p, end, value);
+        b.data()[k] = static_cast<Scalar>(value);
+    }
+    while (p < end && std::isspace(static_cast<unsigned char>(*p))) {
+        ++p;
+    }
+    if (p != end) {
+        error("Unexpected data after the last value");
+    }
+    return b;
+}
+
+} // namespace
+
+template <typename Scalar>
+LinearSystem<Scalar> load_matrix_market(
+    const std::filesystem::path& filename_A,
+    const std::filesystem::path& filename_b,
+    const MatrixMarketOptions& options)
+{
+    LinearSystem<Scalar> system;
+    std::string description;
+    bool symmetric = false;
+    {
+        const MappedFile file(filename_A);
+        const char* begin = reinterpret_cast<const char*>(file.data());
+        const char* end = begin + file.size();
+        const Header header = parse_header(begin, end);
+        if (!header.coordinate) {
+            error("The matrix must be in coordinate format: " + filename_A.string());
+        }
+        spdlog::info(
+            "Importing {}x{} matrix with {} entries from {}",
+            header.rows,
+            header.cols,
+            header.entries,
+            filename_A.filename().string());
+        system.A = load_sparse<Scalar>(header, end, options);
+        description = header.comments;
+        symmetric = (header.symmetry == Symmetry::Symmetric);
+    }
+    const StoredTriangle triangle = (symmetric ? StoredTriangle::Lower : StoredTriangle::Full);
+
+    auto& metadata = system.metadata;
+    metadata["is_symmetric_positive_definite"] = 0;
+    metadata["is_sequence_of_problems"] = 0;
+    metadata["dimension"] = 0;
+    metadata["scalar_type"] = std::is_same<Scalar, float>::value ? "float" : "double";
+    metadata["description"] = description;
+    metadata["dataset_name"] = "matrix_market";
+    metadata["project_url"] = "";
+    metadata["contact_email"] = "";
+    metadata["version_number"] = 2;
+    if (symmetric) {
+        metadata["stored_triangle"] = "lower";
+    }
+
+    if (filename_b.empty()) {
+        const Eigen::VectorX<Scalar> ones = Eigen::VectorX<Scalar>::Ones(system.A.cols());
+        system.b = multiply(system.A, triangle, ones);
+        metadata["generated_rhs"] = 1;
+    } else {
+        system.b = load_dense<Scalar>(filename_b, options);
+        if (system.b.rows() != system.A.rows()) {
+            error(fmt::format(
+                "The rhs has {} rows instead of {}",
+                system.b.rows(),
+                system.A.rows()));
+        }
+    }
+    return system;
+}
+
+template LinearSystem<float> load_matrix_market(
+    const std::filesystem::path&,
+    const std::filesystem::path&,
+    const MatrixMarketOptions&);
+template LinearSystem<double> load_matrix_market(
+    const std::filesystem::path&,
+    const std::filesystem::path&,
+    const MatrixMarketOptions&);
+
+} // namespace io
+} // namespace benchy
@@ -0,0 +1,313 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#include <benchy/io/pack_io.h>
+
+#include <benchy/io/json_io.h>
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <cstring>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <streambuf>
+
+namespace benchy {
+namespace io {
+
+namespace {
+
+const char* format_name(PackFormat format)
+{
+    switch (format) {
+    case PackFormat::Binary: return "bcsc";
+    case PackFormat::Compressed: return "zst";
+    case PackFormat::Sequence: return "bseq";
+    }
+    return "";
+}
+
+std::optional<PackFormat> parse_format(const std::string& name)
+{
+    if (name == "bcsc") return PackFormat::Binary;
+    if (name == "zst") return PackFormat::Compressed;
+    if (name == "bseq") return PackFormat::Sequence;
+    return std::nullopt;
+}
+
+///
+/// Read-only stream buffer over a block of memory, used to decompress `.zst` members in place.
+///
+class MemoryBuffer : public std::streambuf
+{
+public:
+    MemoryBuffer(const std::byte* data, size_t size)
+    {
+        char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+        setg(begin, begin, begin + size);
+    }
+};
+
+} // namespace
+
+MappedPack::MappedPack(const std::filesystem::path& filename)
+    : m_filename(filename)
+    , m_file(std::make_shared<MappedFile>(filename))
+{
+    if (m_file->size() < sizeof(PackHeader)) {
+        throw std::runtime_error("[MappedPack] File is too small to be a pack");
+    }
+    std::memcpy(&m_header, m_file->data(), sizeof(PackHeader));
+    if (std::memcmp(m_header.magic, kPackMagic, sizeof(kPackMagic)) != 0) {
+        throw std::runtime_error("[MappedPack] Not a pack (invalid magic)");
+    }
+    if (m_header.byte_order != kBinaryByteOrder) {
+        throw std::runtime_error("[MappedPack] Unsupported byte order");
+    }
+    if (m_header.version > kPackVersion) {
+        throw std::runtime_error(
+            fmt::format("[MappedPack] Unsupported format version {}", m_header.version));
+    }
+    if (m_header.table_offset < sizeof(PackHeader) || m_header.table_offset > m_file->size() ||
+        m_header.table_size > m_file->size() - m_header.table_offset) {
+        throw std::runtime_error("[MappedPack] Corrupted or truncated pack");
+    }
+
+    const auto* table_data =
+        reinterpret_cast<const uint8_t*>(m_file->data() + m_header.table_offset);
+    const auto table = nlohmann::json::from_msgpack(table_data, table_data + m_header.table_size);
+    if (!table.is_array() || table.size() != static_cast<size_t>(m_header.num_entries)) {
+        throw std::runtime_error("[MappedPack] Corrupted table of members");
+    }
+    m_entries.reserve(table.size());
+    m_index.reserve(table.size());
+    for (const auto& item : table) {
+        PackEntry entry;
+        entry.name = item.at("name");
+        const auto format = parse_format(item.at("format"));
+        entry.offset = item.at("offset");
+        entry.size = item.at("size");
+        entry.info = item.at("info");
+        if (!format || entry.offset < sizeof(PackHeader) || entry.offset % kBinaryAlignment != 0 ||
+            entry.offset > m_header.table_offset ||
+            entry.size > m_header.table_offset - entry.offset) {
+            throw std::runtime_error(
+                fmt::format("[MappedPack] Corrupted table entry of member '{}'", entry.name));
+        }
+        entry.format = *format;
+        if (!m_index.emplace(entry.name, m_entries.size()).second) {
+            throw std::runtime_error(
+                fmt::format("[MappedPack] Duplicate member '{}'", entry.name));
+        }
+        m_entries.push_back(std::move(entry));
+    }
+}
+
+std::optional<size_t> MappedPack::find(const std::string& name) const
+{
+    const auto it = m_index.find(name);
+    if (it == m_index.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+size_t MappedPack::index_of(const std::string& name) const
+{
+    if (const auto index = find(name)) {
+        return *index;
+    }
+    throw std::runtime_error(
+        fmt::format("[MappedPack] {} has no member '{}'", m_filename.string(), name));
+}
+
+template <typename Scalar>
+LinearSystem<Scalar> MappedPack::load(size_t index) const
+{
+    const auto& e = entry(index);
+    switch (e.format) {
+    case PackFormat::Binary: return load_binary<Scalar>(system(index));
+    case PackFormat::Compressed: {
+        MemoryBuffer buffer(m_file->data() + e.offset, e.size);
+        std::istream stream(&buffer);
+        return load_compressed_system<Scalar>(stream);
+    }
+    case PackFormat::Sequence: {
+        LinearSystem<Scalar> system;
+        sequence(index).read_step(0, system);
+        return system;
+    }
+    }
+    throw std::runtime_error("[MappedPack] Unknown member format");
+}
+
+MappedSystem MappedPack::system(size_t index) const
+{
+    const auto& e = entry(index);
+    if (e.format != PackFormat::Binary) {
+        throw std::runtime_error(
+            fmt::format("[MappedPack] Member '{}' is not a binary container", e.name));
+    }
+    return MappedSystem(m_file, e.offset);
+}
+
+MappedSequence MappedPack::sequence(size_t index) const
+{
+    const auto& e = entry(index);
+    if (e.format != PackFormat::Sequence) {
+        throw std::runtime_error(
+            fmt::format("[MappedPack] Member '{}' is not a sequence container", e.name));
+    }
+    return MappedSequence(m_file, e.offset);
+}
+
+PackWriter::PackWriter(const std::filesystem::path& filename)
+    : m_filename(filename)
+{
+    const auto ext = filename.extension();
+    if (ext != ".bpack") {
+        spdlog::warn("Unexpected file extension: '{}' (should be .bpack)", ext.string());
+    }
+    m_stream.open(filename, std::ios::out | std::ios::binary);
+    if (!m_stream.is_open()) {
+        throw std::runtime_error("file `" + filename.string() + "` could not be opened");
+    }
+    // Written again once the table of members is known
+    const PackHeader header = {};
+    m_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+PackWriter::~PackWriter()
+{
+    if (!m_finished) {
+        try {
+            finish();
+        } catch (const std::exception& e) {
+            spdlog::error("[PackWriter] Could not finish {}: {}", m_filename.string(), e.what());
+        }
+    }
+}
+
+void PackWriter::add(const std::string& name, const std::filesystem::path& system)
+{
+    if (m_finished) {
+        throw std::runtime_error("[PackWriter] Cannot add members to a finished pack");
+    }
+    if (name.empty() || m_names.count(name)) {
+        throw std::runtime_error(fmt::format("[PackWriter] Invalid or duplicate name '{}'", name));
+    }
+    PackEntry entry;
+    entry.name = name;
+    const auto ext = system.extension().string();
+    const auto format = parse_format(ext.empty() ? ext : ext.substr(1));
+    if (!format) {
+        throw std::runtime_error(
+            fmt::format("[PackWriter] Unsupported format of {}", system.string()));
+    }
+    entry.format = *format;
+    entry.info = read_system_info(system);
+
+    static const char zeros[kBinaryAlignment] = {};
+    const uint64_t pos = static_cast<uint64_t>(m_stream.tellp());
+    entry.offset = align_binary_offset(pos);
+    m_stream.write(zeros, entry.offset - pos);
+    MappedFile file(system);
+    entry.size = file.size();
+    m_stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+    if (!m_stream) {
+        throw std::runtime_error("file `" + m_filename.string() + "` could not be written");
+    }
+    m_names.insert(name);
+    m_entries.push_back(std::move(entry));
+}
+
+void PackWriter::finish()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+
+    nlohmann::json table = nlohmann::json::array();
+    for (const auto& entry : m_entries) {
+        table.push_back(
+            {{"name", entry.name},
+             {"format", format_name(entry.format)},
+             {"offset", entry.offset},
+             {"size", entry.size},
+             {"info", entry.info}});
+    }
+    const std::vector<uint8_t> table_data = nlohmann::json::to_msgpack(table);
+
+    PackHeader header = {};
+    std::memcpy(header.magic, kPackMagic, sizeof(header.magic));
+    header.version = kPackVersion;
+    header.byte_order = kBinaryByteOrder;
+    header.num_entries = static_cast<int64_t>(m_entries.size());
+    header.table_offset = static_cast<uint64_t>(m_stream.tellp());
+    header.table_size = table_data.size();
+    m_stream.write(reinterpret_cast<const char*>(table_data.data()), table_data.size());
+    m_stream.seekp(0);
+    m_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_stream.close();
+    if (!m_stream) {
+        throw std::runtime_error("file `" + m_filename.string() + "` could not be written");
+    }
+    spdlog::info("Done! Packed {} systems", m_entries.size());
+}
+
+bool split_pack_path(
+    const std::filesystem::path& path,
+    std::filesystem::path& pack,
+    std::string& name)
+{
+    std::filesystem::path prefix;
+    for (auto it = path.begin(); it != path.end(); ++it) {
+        prefix /= *it;
+        if (it->extension() != ".bpack") {
+            continue;
+        }
+        std::filesystem::path member;
+        for (++it; it != path.end(); ++it) {
+            member /= *it;
+        }
+        if (member.empty()) {
+            return false;
+        }
+        pack = std::move(prefix);
+        name = member.generic_string();
+        return true;
+    }
+    return false;
+}
+
+std::shared_ptr<const MappedPack> open_pack(const std::filesystem::path& filename)
+{
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const MappedPack>> packs;
+    const auto key = std::filesystem::absolute(filename).lexically_normal().string();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = packs[key];
+    auto pack = slot.lock();
+    if (!pack) {
+        pack = std::make_shared<const MappedPack>(filename);
+        slot = pack;
+    }
+    return pack;
+}
+
+template LinearSystem<float> MappedPack::load(size_t) const;
+template LinearSystem<double> MappedPack::load(size_t) const;
+
+} // namespace io
+} // namespace benchy
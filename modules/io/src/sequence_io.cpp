@@ -0,0 +1,280 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#include <benchy/io/sequence_io.h>
+
+#include <benchy/io/symmetric_storage.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace benchy {
+namespace io {
+
+namespace {
+
+void write_section(std::ofstream& fl, uint64_t offset, const void* data, uint64_t size)
+{
+    static const char zeros[kBinaryAlignment] = {};
+    const uint64_t pos = static_cast<uint64_t>(fl.tellp());
+    if (pos > offset || offset - pos > kBinaryAlignment) {
+        throw std::runtime_error("[SequenceWriter] Unexpected section offset");
+    }
+    fl.write(zeros, offset - pos);
+    fl.write(reinterpret_cast<const char*>(data), size);
+}
+
+} // namespace
+
+MappedSequence::MappedSequence(const std::filesystem::path& filename)
+    : m_file(std::make_shared<MappedFile>(filename))
+    , m_base(m_file->data())
+    , m_size(m_file->size())
+{
+    parse();
+}
+
+MappedSequence::MappedSequence(std::shared_ptr<const MappedFile> file, size_t offset)
+    : m_file(std::move(file))
+{
+    if (offset > m_file->size() || offset % kBinaryAlignment != 0) {
+        throw std::runtime_error(
+            fmt::format("[MappedSequence] Invalid container offset {}", offset));
+    }
+    m_base = m_file->data() + offset;
+    m_size = m_file->size() - offset;
+    parse();
+}
+
+void MappedSequence::parse()
+{
+    if (m_size < sizeof(SequenceHeader)) {
+        throw std::runtime_error("[MappedSequence] File is too small to be a sequence container");
+    }
+    std::memcpy(&m_header, m_base, sizeof(SequenceHeader));
+    if (std::memcmp(m_header.magic, kSequenceMagic, sizeof(kSequenceMagic)) != 0) {
+        throw std::runtime_error("[MappedSequence] Not a sequence container (invalid magic)");
+    }
+    if (m_header.byte_order != kBinaryByteOrder) {
+        throw std::runtime_error("[MappedSequence] Unsupported byte order");
+    }
+    if (m_header.version > kSequenceVersion) {
+        throw std::runtime_error(
+            fmt::format("[MappedSequence] Unsupported format version {}", m_header.version));
+    }
+    if (m_header.index_size != sizeof(int32_t) ||
+        (m_header.scalar_size != sizeof(float) && m_header.scalar_size != sizeof(double))) {
+        throw std::runtime_error("[MappedSequence] Unsupported scalar or index size");
+    }
+    SequenceHeader expected = m_header;
+    const uint64_t file_size = layout_sequence_header(expected);
+    if (expected.outer_offset != m_header.outer_offset ||
+        expected.inner_offset != m_header.inner_offset ||
+        expected.steps_offset != m_header.steps_offset ||
+        expected.step_size != m_header.step_size ||
+        expected.step_b_offset != m_header.step_b_offset ||
+        expected.metadata_offset != m_header.metadata_offset || file_size > m_size) {
+        throw std::runtime_error("[MappedSequence] Corrupted or truncated sequence container");
+    }
+    const char* metadata = section<char>(m_header.metadata_offset);
+    m_metadata = nlohmann::json::parse(metadata, metadata + m_header.metadata_size);
+}
+
+template <typename Scalar>
+void MappedSequence::read_step(size_t step, LinearSystem<Scalar>& system) const
+{
+    auto& A = system.A;
+    // The matrix may have been filled from another sequence with the same sizes, so its indices
+    // are compared with the shared pattern, which is much cheaper than rebuilding them
+    const bool same_pattern =
+        A.isCompressed() && A.rows() == m_header.rows && A.cols() == m_header.cols &&
+        A.nonZeros() == m_header.nnz &&
+        std::equal(A.outerIndexPtr(), A.outerIndexPtr() + A.cols() + 1, outer_index()) &&
+        std::equal(A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros(), inner_index());
+    auto copy = [&](auto zero) {
+        using FileScalar = decltype(zero);
+        if (same_pattern) {
+            Eigen::Map<Eigen::VectorX<Scalar>>(A.valuePtr(), A.nonZeros()) =
+                this->template values<FileScalar>(step).template cast<Scalar>();
+        } else {
+            A = this->template A<FileScalar>(step).template cast<Scalar>();
+        }
+        system.b = this->template b<FileScalar>(step).template cast<Scalar>();
+    };
+    if (is_float()) {
+        copy(0.f);
+    } else {
+        copy(0.0);
+    }
+    system.metadata = m_metadata;
+}
+
+template <typename Scalar>
+SequenceWriter<Scalar>::SequenceWriter(const std::filesystem::path& filename)
+    : m_filename(filename)
+{
+    static_assert(
+        std::is_same<Scalar, float>::value || std::is_same<Scalar, double>::value,
+        "Scalar must be float or double");
+    const auto ext = filename.extension();
+    if (ext != ".bseq") {
+        spdlog::warn("Unexpected file extension: '{}' (should be .bseq)", ext.string());
+    }
+    m_stream.open(filename, std::ios::out | std::ios::binary);
+    if (!m_stream.is_open()) {
+        throw std::runtime_error("file `" + filename.string() + "` could not be opened");
+    }
+    spdlog::info("Saving to disk: {}", filename.filename().string());
+    // Written again once the number of steps and the metadata are known
+    m_stream.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+}
+
+template <typename Scalar>
+SequenceWriter<Scalar>::~SequenceWriter()
+{
+    if (!m_finished) {
+        try {
+            finish();
+        } catch (const std::exception& e) {
+            spdlog::error(
+                "[SequenceWriter] Could not finish {}: {}",
+                m_filename.string(),
+                e.what());
+        }
+    }
+}
+
+template <typename Scalar>
+void SequenceWriter<Scalar>::add(const LinearSystem<Scalar>& system)
+{
+    if (m_finished) {
+        throw std::runtime_error("[SequenceWriter] Cannot add a step to a finished sequence");
+    }
+
+    // Outer/inner arrays must be contiguous
+    const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>* A = &system.A;
+    Eigen::SparseMatrix<Scalar, Eigen::ColMajor> compressed;
+    if (!system.A.isCompressed()) {
+        compressed = system.A;
+        compressed.makeCompressed();
+        A = &compressed;
+    }
+    const int32_t* outer = A->outerIndexPtr();
+    const int32_t* inner = A->innerIndexPtr();
+
+    if (m_header.num_steps == 0) {
+        switch (stored_triangle(system.metadata)) {
+        case StoredTriangle::Lower: m_header.flags = kBinaryFlagLowerTriangle; break;
+        case StoredTriangle::Upper: m_header.flags = kBinaryFlagUpperTriangle; break;
+        default: break;
+        }
+        m_header.scalar_size = sizeof(Scalar);
+        m_header.index_size = sizeof(int32_t);
+        m_header.rows = A->rows();
+        m_header.cols = A->cols();
+        m_header.nnz = A->nonZeros();
+        m_header.b_rows = system.b.rows();
+        m_header.b_cols = system.b.cols();
+        layout_sequence_header(m_header);
+        m_metadata = system.metadata;
+        m_outer.assign(outer, outer + m_header.cols + 1);
+        m_inner.assign(inner, inner + m_header.nnz);
+        write_section(m_stream, m_header.outer_offset, outer, m_outer.size() * sizeof(int32_t));
+        write_section(m_stream, m_header.inner_offset, inner, m_inner.size() * sizeof(int32_t));
+    } else if (
+        A->rows() != m_header.rows || A->cols() != m_header.cols ||
+        A->nonZeros() != m_header.nnz || !std::equal(m_outer.begin(), m_outer.end(), outer) ||
+        !std::equal(m_inner.begin(), m_inner.end(), inner)) {
+        throw std::runtime_error(fmt::format(
+            "[SequenceWriter] Step {} does not have the sparsity pattern of the first step",
+            m_header.num_steps));
+    } else if (system.b.rows() != m_header.b_rows || system.b.cols() != m_header.b_cols) {
+        throw std::runtime_error(fmt::format(
+            "[SequenceWriter] Step {} does not have the rhs size of the first step",
+            m_header.num_steps));
+    }
+
+    const uint64_t offset = m_header.steps_offset + m_header.num_steps * m_header.step_size;
+    write_section(m_stream, offset, A->valuePtr(), m_header.nnz * m_header.scalar_size);
+    write_section(
+        m_stream,
+        offset + m_header.step_b_offset,
+        system.b.data(),
+        m_header.b_rows * m_header.b_cols * m_header.scalar_size);
+    if (!m_stream) {
+        throw std::runtime_error("file `" + m_filename.string() + "` could not be written");
+    }
+    ++m_header.num_steps;
+}
+
+template <typename Scalar>
+void SequenceWriter<Scalar>::finish()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    if (m_header.num_steps == 0) {
+        throw std::runtime_error("[SequenceWriter] A sequence must have at least one step");
+    }
+
+    m_metadata["is_sequence_of_problems"] = 1;
+    m_metadata["num_steps"] = m_header.num_steps;
+    m_metadata["scalar_type"] = std::is_same<Scalar, float>::value ? "float" : "double";
+    const std::string metadata_str = m_metadata.dump();
+    m_header.metadata_size = metadata_str.size();
+    layout_sequence_header(m_header);
+
+    write_section(m_stream, m_header.metadata_offset, metadata_str.data(), metadata_str.size());
+    m_stream.seekp(0);
+    m_stream.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+    m_stream.close();
+    if (!m_stream) {
+        throw std::runtime_error("file `" + m_filename.string() + "` could not be written");
+    }
+    spdlog::info("Done! Saved {} steps", m_header.num_steps);
+}
+
+template <typename Scalar>
+void save_sequence(
+    const std::filesystem::path& filename,
+    const std::vector<LinearSystem<Scalar>>& steps)
+{
+    SequenceWriter<Scalar> writer(filename);
+    for (const auto& step : steps) {
+        writer.add(step);
+    }
+    writer.finish();
+}
+
+template <typename Scalar>
+LinearSystem<Scalar> load_sequence_step(const std::filesystem::path& filename, size_t step)
+{
+    MappedSequence sequence(filename);
+    LinearSystem<Scalar> system;
+    sequence.read_step(step, system);
+    return system;
+}
+
+template void MappedSequence::read_step(size_t, LinearSystem<float>&) const;
+template void MappedSequence::read_step(size_t, LinearSystem<double>&) const;
+template class SequenceWriter<float>;
+template class SequenceWriter<double>;
+template void save_sequence(const std::filesystem::path&, const std::vector<LinearSystem<float>>&);
+template void save_sequence(
+    const std::filesystem::path&,
+    const std::vector<LinearSystem<double>>&);
+template LinearSystem<float> load_sequence_step(const std::filesystem::path&, size_t);
+template LinearSystem<double> load_sequence_step(const std::filesystem::path&, size_t);
+
+} // namespace io
+} // namespace benchy
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#include <benchy/io/symmetric_storage.h>
+
+#include <spdlog/spdlog.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace benchy {
+namespace io {
+
+namespace {
+
+const char* triangle_name(StoredTriangle triangle)
+{
+    switch (triangle) {
+    case StoredTriangle::Lower: return "lower";
+    case StoredTriangle::Upper: return "upper";
+    default: return "full";
+    }
+}
+
+} // namespace
+
+StoredTriangle stored_triangle(const nlohmann::json& metadata)
+{
+    if (!metadata.is_object() || !metadata.contains("stored_triangle")) {
+        return StoredTriangle::Full;
+    }
+    const std::string name = metadata["stored_triangle"];
+    if (name == "lower") {
+        return StoredTriangle::Lower;
+    } else if (name == "upper") {
+        return StoredTriangle::Upper;
+    } else if (name == "full") {
+        return StoredTriangle::Full;
+    }
+    throw std::runtime_error(fmt::format("[stored_triangle] Invalid stored triangle: '{}'", name));
+}
+
+template <typename Scalar>
+bool make_half_storage(LinearSystem<Scalar>& system, StoredTriangle triangle)
+{
+    if (triangle == StoredTriangle::Full) {
+        throw std::runtime_error("[make_half_storage] Expected a lower or upper triangle");
+    }
+    const StoredTriangle current = stored_triangle(system.metadata);
+    if (current != StoredTriangle::Full) {
+        system.A = convert_storage(system.A, current, triangle);
+        system.metadata["stored_triangle"] = triangle_name(triangle);
+        return true;
+    }
+    if (system.metadata.value("is_symmetric_positive_definite", 0) != 1) {
+        return false;
+    }
+    const Eigen::SparseMatrix<Scalar, Eigen::ColMajor> At = system.A.transpose();
+    if (system.A.rows() != system.A.cols() || !At.isApprox(system.A, Scalar(0))) {
+        spdlog::warn("Matrix flagged as SPD is not symmetric, storing the full matrix");
+        return false;
+    }
+    system.A = convert_storage(system.A, StoredTriangle::Full, triangle);
+    system.metadata["stored_triangle"] = triangle_name(triangle);
+    return true;
+}
+
+template <typename Scalar>
+void make_full_storage(LinearSystem<Scalar>& system)
+{
+    const StoredTriangle current = stored_triangle(system.metadata);
+    if (current != StoredTriangle::Full) {
+        system.A = convert_storage(system.A, current, StoredTriangle::Full);
+        system.metadata.erase("stored_triangle");
+    }
+}
+
+template <typename Scalar>
+Eigen::SparseMatrix<Scalar, Eigen::ColMajor> convert_storage(
+    const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A,
+    StoredTriangle from,
+    StoredTriangle to)
+{
+    using Matrix = Eigen::SparseMatrix<Scalar, Eigen::ColMajor>;
+    if (from == to) {
+        return A;
+    } else if (from == StoredTriangle::Full) {
+        return to == StoredTriangle::Lower ? Matrix(A.template triangularView<Eigen::Lower>())
+                                           : Matrix(A.template triangularView<Eigen::Upper>());
+    } else if (to == StoredTriangle::Full) {
+        return from == StoredTriangle::Lower ? Matrix(A.template selfadjointView<Eigen::Lower>())
+                                             : Matrix(A.template selfadjointView<Eigen::Upper>());
+    } else {
+        // The upper triangle of a symmetric matrix is the transpose of its lower triangle
+        return A.transpose();
+    }
+}
+
+template <typename Scalar>
+Eigen::Index full_nonzeros(
+    const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A,
+    StoredTriangle triangle)
+{
+    if (triangle == StoredTriangle::Full) {
+        return A.nonZeros();
+    }
+    Eigen::Index diagonal = 0;
+    for (Eigen::Index j = 0; j < A.outerSize(); ++j) {
+        for (typename Eigen::SparseMatrix<Scalar, Eigen::ColMajor>::InnerIterator it(A, j); it;
+             ++it) {
+            diagonal += (it.row() == it.col());
+        }
+    }
+    return 2 * A.nonZeros() - diagonal;
+}
+
+template <typename Scalar>
+Eigen::VectorX<Scalar> multiply(
+    const Eigen::SparseMatrix<Scalar, Eigen::ColMajor>& A,
+    StoredTriangle triangle,
+    const Eigen::VectorX<Scalar>& x)
+{
+    switch (triangle) {
+    case StoredTriangle::Lower: return A.template selfadjointView<Eigen::Lower>() * x;
+    case StoredTriangle::Upper: return A.template selfadjointView<Eigen::Upper>() * x;
+    default: return A * x;
+    }
+}
+
+template bool make_half_storage(LinearSystem<float>&, StoredTriangle);
+template bool make_half_storage(LinearSystem<double>&, StoredTriangle);
+template void make_full_storage(LinearSystem<float>&);
+template void make_full_storage(LinearSystem<double>&);
+template Eigen::SparseMatrix<float, Eigen::ColMajor> convert_storage(
+    const Eigen::SparseMatrix<float, Eigen::ColMajor>&,
+    StoredTriangle,
+    StoredTriangle);
+template Eigen::SparseMatrix<double, Eigen::ColMajor> convert_storage(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor>&,
+    StoredTriangle,
+    StoredTriangle);
+template Eigen::SparseMatrix<int, Eigen::ColMajor> convert_storage(
+    const Eigen::SparseMatrix<int, Eigen::ColMajor>&,
+    StoredTriangle,
+    StoredTriangle);
+template Eigen::Index full_nonzeros(
+    const Eigen::SparseMatrix<float, Eigen::ColMajor>&,
+    StoredTriangle);
+template Eigen::Index full_nonzeros(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor>&,
+    StoredTriangle);
+template Eigen::VectorX<float> multiply(
+    const Eigen::SparseMatrix<float, Eigen::ColMajor>&,
+    StoredTriangle,
+    const Eigen::VectorX<float>&);
+template Eigen::VectorX<double> multiply(
+    const Eigen::SparseMatrix<double, Eigen::ColMajor>&,
+    StoredTriangle,
+    const Eigen::VectorX<double>&);
+
+} // namespace io
+} // namespace benchy
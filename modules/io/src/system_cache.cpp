@@ -0,0 +1,260 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#include <benchy/io/load_system.h>
+#include <benchy/io/system_cache.h>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+
+namespace benchy {
+namespace io {
+
+namespace {
+
+template <typename Scalar>
+typename SystemCache<Scalar>::SystemPtr load_shared(const std::filesystem::path& filename)
+{
+    return std::make_shared<LinearSystem<Scalar>>(load_system<Scalar>(filename));
+}
+
+template <typename Scalar>
+size_t memory_size(const LinearSystem<Scalar>& system)
+{
+    using StorageIndex = typename Eigen::SparseMatrix<Scalar>::StorageIndex;
+    const auto& A = system.A;
+    return static_cast<size_t>(A.nonZeros()) * (sizeof(Scalar) + sizeof(StorageIndex)) +
+           static_cast<size_t>(A.outerSize() + 1) * sizeof(StorageIndex) +
+           static_cast<size_t>(system.b.size()) * sizeof(Scalar);
+}
+
+std::string cache_key(const std::filesystem::path& filename)
+{
+    return std::filesystem::absolute(filename).lexically_normal().string();
+}
+
+} // namespace
+
+template <typename Scalar>
+SystemCache<Scalar>::SystemCache(size_t max_bytes, size_t max_entries)
+    : m_max_bytes(max_bytes)
+    , m_max_entries(max_entries)
+{}
+
+template <typename Scalar>
+SystemCache<Scalar>::~SystemCache() = default;
+
+template <typename Scalar>
+typename SystemCache<Scalar>::SystemPtr SystemCache<Scalar>::get(
+    const std::filesystem::path& filename)
+{
+    std::string key = cache_key(filename);
+    std::shared_future<SystemPtr> future;
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            // Mark as most recently used
+            m_entries.splice(m_entries.end(), m_entries, it->second);
+            ++m_num_hits;
+        } else {
+            // Loaded on the calling thread by the call to get() below
+            auto system = std::async(std::launch::deferred, load_shared<Scalar>, filename);
+            it = m_index.emplace(key, insert(key, std::move(system))).first;
+            ++m_num_misses;
+        }
+        future = it->second->system;
+        id = it->second->id;
+    }
+
+    SystemPtr system;
+    try {
+        system = future.get();
+    } catch (...) {
+        // Do not keep the failure around, so that the next request tries again
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it != m_index.end() && it->second->id == id) {
+            erase(it->second);
+        }
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(key);
+    if (it != m_index.end() && it->second->id == id && !it->second->ready) {
+        it->second->ready = true;
+        it->second->num_bytes = memory_size(*system);
+        m_num_bytes += it->second->num_bytes;
+    }
+    update_sizes();
+    evict(m_max_entries, m_max_bytes);
+    return system;
+}
+
+template <typename Scalar>
+void SystemCache<Scalar>::prefetch(const std::filesystem::path& filename)
+{
+    std::string key = cache_key(filename);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_index.count(key) || m_max_entries == 1) {
+        return;
+    }
+    // Make room for one more system, without knowing its size yet
+    update_sizes();
+    const size_t max_entries = (m_max_entries > 0 ? m_max_entries - 1 : 0);
+    const size_t max_bytes = (m_max_bytes > 0 ? m_max_bytes - 1 : 0);
+    if (!evict(max_entries, max_bytes) || (m_max_bytes > 0 && m_num_bytes >= m_max_bytes)) {
+        return;
+    }
+    spdlog::debug("Prefetching {}", filename.string());
+    auto system = std::async(std::launch::async, load_shared<Scalar>, filename);
+    m_index.emplace(key, insert(key, std::move(system)));
+}
+
+template <typename Scalar>
+void SystemCache<Scalar>::wait_pending()
+{
+    std::vector<std::shared_future<SystemPtr>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& entry : m_entries) {
+            // Deferred loads belong to a get() call, and would be run here by waiting on them
+            if (!entry.ready && entry.system.wait_for(std::chrono::seconds(0)) ==
+                                    std::future_status::timeout) {
+                pending.push_back(entry.system);
+            }
+        }
+    }
+    // Waited for without holding the lock, failures being reported by get()
+    for (const auto& system : pending) {
+        system.wait();
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    update_sizes();
+}
+
+template <typename Scalar>
+void SystemCache<Scalar>::clear()
+{
+    std::list<Entry> entries;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(entries, m_entries);
+        m_index.clear();
+        m_num_bytes = 0;
+    }
+    // Pending loads are waited for here, without holding the lock
+    entries.clear();
+}
+
+template <typename Scalar>
+size_t SystemCache<Scalar>::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+template <typename Scalar>
+size_t SystemCache<Scalar>::num_bytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_num_bytes;
+}
+
+template <typename Scalar>
+size_t SystemCache<Scalar>::num_hits() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_num_hits;
+}
+
+template <typename Scalar>
+size_t SystemCache<Scalar>::num_misses() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_num_misses;
+}
+
+template <typename Scalar>
+size_t SystemCache<Scalar>::num_evictions() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_num_evictions;
+}
+
+template <typename Scalar>
+typename SystemCache<Scalar>::EntryIterator SystemCache<Scalar>::insert(
+    std::string key,
+    std::shared_future<SystemPtr> system)
+{
+    Entry entry;
+    entry.key = std::move(key);
+    entry.id = m_next_id++;
+    entry.system = std::move(system);
+    return m_entries.insert(m_entries.end(), std::move(entry));
+}
+
+template <typename Scalar>
+void SystemCache<Scalar>::erase(EntryIterator it)
+{
+    m_num_bytes -= it->num_bytes;
+    m_index.erase(it->key);
+    m_entries.erase(it);
+}
+
+template <typename Scalar>
+void SystemCache<Scalar>::update_sizes()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        auto current = it++;
+        if (current->ready ||
+            current->system.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            continue;
+        }
+        try {
+            current->num_bytes = memory_size(*current->system.get());
+            current->ready = true;
+            m_num_bytes += current->num_bytes;
+        } catch (const std::exception& e) {
+            // Reported again if the system is requested
+            spdlog::debug("Prefetching {} failed: {}", current->key, e.what());
+            erase(current);
+        }
+    }
+}
+
+template <typename Scalar>
+bool SystemCache<Scalar>::evict(size_t max_entries, size_t max_bytes)
+{
+    auto fits = [&] {
+        return (max_entries == 0 || m_entries.size() <= max_entries) &&
+               (max_bytes == 0 || m_num_bytes <= max_bytes);
+    };
+    // Systems still being loaded are skipped, since releasing them would wait for the loading
+    for (auto it = m_entries.begin(); !fits() && it != m_entries.end();) {
+        auto current = it++;
+        if (current->ready && it != m_entries.end()) {
+            spdlog::debug("Releasing {} from the system cache", current->key);
+            erase(current);
+            ++m_num_evictions;
+        }
+    }
+    return fits();
+}
+
+template class SystemCache<float>;
+template class SystemCache<double>;
+
+} // namespace io
+} // namespace benchy
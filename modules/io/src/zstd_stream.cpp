@@ -0,0 +1,143 @@
+/*
+ * Copyright 2023 Adobe. All rights reserved.
+ * This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain a copy
+ * of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under
+ * the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ * OF ANY KIND, either express or implied. See the License for the specific language
+ * governing permissions and limitations under the License.
+ */
+#include <benchy/io/zstd_stream.h>
+
+#include <spdlog/spdlog.h>
+
+#include <stdexcept>
+
+extern "C" {
+#include <zstd.h>
+}
+
+namespace benchy {
+namespace io {
+
+ZstdInputBuffer::ZstdInputBuffer(std::istream& source)
+    : m_source(source)
+    , m_dctx(ZSTD_createDCtx())
+    , m_input(ZSTD_DStreamInSize())
+    , m_next_input(ZSTD_DStreamInSize())
+    , m_output(ZSTD_DStreamOutSize())
+{
+    if (m_dctx == nullptr) {
+        throw std::runtime_error("[ZstdInputBuffer] Could not create decompression context");
+    }
+    // Accept archives written with a large window (see CompressionOptions::window_log)
+    const auto bounds = ZSTD_dParam_getBounds(ZSTD_d_windowLogMax);
+    ZSTD_DCtx_setParameter(m_dctx, ZSTD_d_windowLogMax, bounds.upperBound);
+    setg(m_output.data(), m_output.data(), m_output.data());
+    m_reader = std::thread(&ZstdInputBuffer::read_loop, this);
+}
+
+ZstdInputBuffer::~ZstdInputBuffer()
+{
+    // The reader references our buffers, stop it before releasing them
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_reader.join();
+    ZSTD_freeDCtx(m_dctx);
+}
+
+void ZstdInputBuffer::read_loop()
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || !m_next_ready; });
+            if (m_stop) {
+                return;
+            }
+        }
+        size_t size = 0;
+        std::exception_ptr error;
+        try {
+            m_source.read(m_next_input.data(), m_next_input.size());
+            size = static_cast<size_t>(m_source.gcount());
+        } catch (...) {
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_next_size = size;
+            m_read_error = error;
+            m_next_ready = true;
+        }
+        m_cv.notify_all();
+        // The end of the source or an error is kept as the last chunk
+        if (size == 0) {
+            return;
+        }
+    }
+}
+
+size_t ZstdInputBuffer::next_chunk()
+{
+    size_t size = 0;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_next_ready; });
+        if (m_read_error) {
+            std::rethrow_exception(m_read_error);
+        }
+        size = m_next_size;
+        if (size == 0) {
+            return 0;
+        }
+        std::swap(m_input, m_next_input);
+        m_next_ready = false;
+    }
+    m_cv.notify_all();
+    return size;
+}
+
+ZstdInputBuffer::int_type ZstdInputBuffer::underflow()
+{
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    while (true) {
+        // When the output buffer was filled, the decoder may still hold data to flush
+        if (m_input_pos == m_input_size && !m_output_full) {
+            m_input_size = next_chunk();
+            m_input_pos = 0;
+            if (m_input_size == 0) {
+                break;
+            }
+        }
+
+        ZSTD_inBuffer in = {m_input.data(), m_input_size, m_input_pos};
+        ZSTD_outBuffer out = {m_output.data(), m_output.size(), 0};
+        const size_t code = ZSTD_decompressStream(m_dctx, &out, &in);
+        if (ZSTD_isError(code)) {
+            throw std::runtime_error(
+                fmt::format("[decompress] Decompression error: {}", ZSTD_getErrorName(code)));
+        }
+        m_input_pos = in.pos;
+        m_frame_remaining = code;
+        m_output_full = (out.pos == out.size);
+        if (out.pos > 0) {
+            setg(m_output.data(), m_output.data(), m_output.data() + out.pos);
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+    if (m_frame_remaining != 0) {
+        throw std::runtime_error("[decompress] Truncated zstd frame");
+    }
+    return traits_type::eof();
+}
+
+} // namespace io
+} // namespace benchy
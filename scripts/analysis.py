@@ -111,7 +111,17 @@ def load_dataframe(benchmark_csv):
         pl.Int64,
     ]
 
+    # Runs sweeping the number of backend threads are compared at the largest number of
+    # threads, the scaling of each benchmark being in the Speedup column of the csv
+    threads_col = "Backend Threads Mean"
+    sweep = threads_col in pl.read_csv(benchmark_csv, n_rows=0).columns
+    if sweep:
+        cols_to_load.append(threads_col)
+        dtypes_to_load.append(pl.Float32)
+
     df = pl.read_csv(benchmark_csv, columns=cols_to_load, dtypes=dtypes_to_load)
+    if sweep:
+        df = df.filter(pl.col(threads_col) == pl.col(threads_col).max()).drop(threads_col)
     logging.info(f"Loaded {benchmark_csv} with {df.select(pl.count()).item()} rows")
 
     return df
@@ -329,6 +339,22 @@ def clean_dataframe(df, name=None, output=None):
     # Removes extraneous baseline data
     df = df.filter(pl.col("Solver") != "Base")
 
+    # Refactorize times a whole sequence of systems, MultiSolve a block of rhs,
+    # ConcurrentSolve a fixed duration, MixedPrecision a factorization followed by a
+    # solve and Pipeline all three phases (which are also written as separate rows), so
+    # they are not summed with the other phases
+    df = df.filter(
+        ~pl.col("Phase").is_in(
+            [
+                "Refactorize",
+                "MultiSolve",
+                "ConcurrentSolve",
+                "MixedPrecision",
+                "Pipeline",
+            ]
+        )
+    )
+
     df = remove_failures(df)
 
     # The residual is only defined in the solve phase. This adds the residual
@@ -13,8 +13,18 @@
 #include <benchy/io/save_problem.h>
 #include <benchy/io/load_problem.h>
 
+#include <benchy/io/binary_io.h>
+#include <benchy/io/catalog.h>
+#include <benchy/io/hdf5_store.h>
+#include <benchy/io/index_codec.h>
 #include <benchy/io/json_eigen.h>
 #include <benchy/io/json_io.h>
+#include <benchy/io/load_system.h>
+#include <benchy/io/matrix_market.h>
+#include <benchy/io/pack_io.h>
+#include <benchy/io/sequence_io.h>
+#include <benchy/io/symmetric_storage.h>
+#include <benchy/io/system_cache.h>
 
 // Third-party include
 #include <catch2/catch_test_macros.hpp>
@@ -22,8 +32,19 @@
 #include <unsupported/Eigen/SparseExtra>
 
 // System include
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
 #include <random>
+#include <sstream>
+
+extern "C" {
+#include <zstd.h>
+}
 
 namespace fs = std::filesystem;
 
@@ -81,9 +102,173 @@ void test_problem_io()
     REQUIRE((A.coeffs() == problem.A.coeffs()).all());
     REQUIRE(b == problem.b);
 
+    auto system = benchy::io::load_problem_system<Scalar>("test.json");
+    REQUIRE(system.A.isCompressed());
+    REQUIRE((system.A.coeffs() == problem.A.coeffs()).all());
+    REQUIRE(system.b.col(0) == problem.b);
+    REQUIRE(system.metadata == data["metadata"]);
+    REQUIRE(system.metadata["version_number"] == 2);
+
     benchy::io::save_compressed("test.zst", data);
 }
 
+template <typename Scalar>
+benchy::io::LinearSystem<Scalar> random_system(int n, int nrhs)
+{
+    std::mt19937 gen;
+    std::uniform_int_distribution<int> dist_i(0, n - 1);
+    std::uniform_real_distribution<Scalar> dist_v(0, 1);
+    std::vector<Eigen::Triplet<Scalar>> triplets;
+    for (int i = 0; i < n * n / 10; ++i) {
+        triplets.emplace_back(dist_i(gen), dist_i(gen), dist_v(gen));
+    }
+    benchy::io::LinearSystem<Scalar> system;
+    system.A.resize(n, n);
+    system.A.setFromTriplets(triplets.begin(), triplets.end());
+    system.b = Eigen::MatrixX<Scalar>::NullaryExpr(n, nrhs, [&]() { return dist_v(gen); });
+    system.metadata["dataset_name"] = "random";
+    return system;
+}
+
+template <typename Scalar>
+void test_binary_io()
+{
+    auto system = random_system<Scalar>(100, 2);
+    benchy::io::save_binary("test.bcsc", system);
+
+    // Zero-copy view of the file
+    {
+        benchy::io::MappedSystem mapped("test.bcsc");
+        REQUIRE(mapped.metadata()["dataset_name"] == "random");
+        Eigen::SparseMatrix<Scalar> A = mapped.A<Scalar>();
+        REQUIRE(A.nonZeros() == system.A.nonZeros());
+        REQUIRE((A.coeffs() == system.A.coeffs()).all());
+        REQUIRE(mapped.b<Scalar>() == system.b);
+    }
+
+    // Owning copies
+    auto system2 = benchy::io::load_system<Scalar>("test.bcsc");
+    REQUIRE(system2.A.isApprox(system.A, 0));
+    REQUIRE(system2.b == system.b);
+
+    // Corrupted headers are rejected instead of reading outside of the file
+    auto corrupt = [](size_t offset, auto value) {
+        fs::copy_file("test.bcsc", "corrupt.bcsc", fs::copy_options::overwrite_existing);
+        std::fstream file("corrupt.bcsc", std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    corrupt(offsetof(benchy::io::BinaryHeader, metadata_offset), uint64_t(1) << 40);
+    REQUIRE_THROWS(benchy::io::MappedSystem("corrupt.bcsc"));
+    // The size of b wraps around to the size of the original one
+    corrupt(offsetof(benchy::io::BinaryHeader, b_rows), (int64_t(1) << 61) + system.b.rows());
+    REQUIRE_THROWS(benchy::io::MappedSystem("corrupt.bcsc"));
+    corrupt(offsetof(benchy::io::BinaryHeader, nnz), int64_t(-1));
+    REQUIRE_THROWS(benchy::io::MappedSystem("corrupt.bcsc"));
+}
+
+template <typename Scalar>
+benchy::io::Problem<Scalar> random_problem(int n)
+{
+    auto system = random_system<Scalar>(n, 1);
+    benchy::io::Problem<Scalar> problem;
+    problem.A = system.A;
+    problem.b = system.b.col(0);
+    // Negative and subnormal values
+    problem.A.coeffs().head(2) *= Scalar(-1);
+    problem.b(0) = -std::numeric_limits<Scalar>::denorm_min();
+    problem.is_symmetric_positive_definite = 0;
+    problem.is_sequence_of_problems = 1;
+    problem.dimension = 2;
+    problem.description = "\"quoted\" description";
+    problem.dataset_name = "random";
+    problem.project_url = ".";
+    problem.contact_email = ".";
+    return problem;
+}
+
+template <typename Scalar>
+void test_save_problem()
+{
+    auto problem = random_problem<Scalar>(100);
+    for (const std::string filename : {"saved.json", "saved.bcsc"}) {
+        REQUIRE(benchy::io::save_problem(filename, problem));
+        auto system = benchy::io::load_system<Scalar>(filename);
+        REQUIRE(system.A.nonZeros() == problem.A.nonZeros());
+        REQUIRE((system.A.coeffs() == problem.A.coeffs()).all());
+        REQUIRE(system.b.col(0) == problem.b);
+        REQUIRE(system.metadata["version_number"] == 2);
+        REQUIRE(system.metadata["description"] == problem.description);
+        REQUIRE(system.metadata["is_sequence_of_problems"] == 1);
+    }
+
+    // Multiple rhs, one per column
+    {
+        auto multi = problem;
+        multi.b = random_system<Scalar>(100, 3).b;
+        for (const std::string filename : {"multi_rhs.json", "multi_rhs.bcsc"}) {
+            REQUIRE(benchy::io::save_problem(filename, multi));
+            auto system = benchy::io::load_system<Scalar>(filename);
+            REQUIRE(system.b == multi.b);
+        }
+        benchy::io::save_compressed("multi_rhs.zst", benchy::io::load_problem("multi_rhs.json"));
+        REQUIRE(benchy::io::load_system<Scalar>("multi_rhs.zst").b == multi.b);
+
+        multi.b.resize(10, 3);
+        REQUIRE(!benchy::io::save_problem("multi_rhs.json", multi));
+    }
+
+    // Uncompressed matrix with free space at the end of the columns
+    problem.A.uncompress();
+    problem.A.reserve(Eigen::VectorXi::Constant(problem.A.cols(), 3));
+    REQUIRE(benchy::io::save_problem_binary("uncompressed.bcsc", problem));
+    auto system = benchy::io::load_system<Scalar>("uncompressed.bcsc");
+    REQUIRE(system.A.isApprox(problem.A, 0));
+
+    // Background writer
+    {
+        benchy::io::ProblemWriter<Scalar> writer(1);
+        for (int i = 0; i < 4; ++i) {
+            problem.b(1) = Scalar(i);
+            writer.save("queued_" + std::to_string(i) + ".bcsc", problem);
+        }
+        REQUIRE(writer.wait());
+        problem.dimension = 0;
+        writer.save("invalid.bcsc", problem);
+        REQUIRE(!writer.wait());
+    }
+    for (int i = 0; i < 4; ++i) {
+        auto queued = benchy::io::load_system<Scalar>("queued_" + std::to_string(i) + ".bcsc");
+        REQUIRE(queued.b(1, 0) == Scalar(i));
+    }
+}
+
+// Compress with the streaming API, which does not store the content size in the frame header
+void save_streamed(const std::filesystem::path& filename, const std::vector<uint8_t>& src)
+{
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    std::vector<char> out(ZSTD_CStreamOutSize());
+    std::ofstream fl(filename, std::ios::out | std::ios::binary);
+    const size_t chunk_size = 1000;
+    for (size_t pos = 0; pos < src.size(); pos += chunk_size) {
+        const size_t size = std::min(chunk_size, src.size() - pos);
+        const bool last = (pos + size == src.size());
+        ZSTD_inBuffer in = {src.data() + pos, size, 0};
+        size_t remaining;
+        do {
+            ZSTD_outBuffer output = {out.data(), out.size(), 0};
+            remaining = ZSTD_compressStream2(
+                cctx,
+                &output,
+                &in,
+                last ? ZSTD_e_end : ZSTD_e_continue);
+            REQUIRE(!ZSTD_isError(remaining));
+            fl.write(out.data(), output.pos);
+        } while (last ? remaining != 0 : in.pos != in.size);
+    }
+    ZSTD_freeCCtx(cctx);
+}
+
 } // namespace
 
 TEST_CASE("test io", "[io]")
@@ -140,3 +325,802 @@ TEST_CASE("problem io", "[io]")
     test_problem_io<double>();
     test_problem_io<float>();
 }
+
+TEST_CASE("streaming problem parser", "[io]")
+{
+    // Keys out of order, signed/decimal values, duplicate and unsorted triplets
+    {
+        std::ofstream out("handwritten.json");
+        out << R"({"b": ["-0x1p+0", "+0x1.8p+1", "2.5"],)"
+            << R"( "A": {"triplets": [[2, 1, "0x1p-2"], [0, 0, "-0x1.8p+1"], [2, 1, "1e0"]],)"
+            << R"( "rows": 3, "cols": 2, "nnz": 3},)"
+            << R"( "metadata": {"raw_dump_version": 2, "scalar_type": "double", "tags": [1]}})";
+    }
+    auto system = benchy::io::load_problem_system<double>("handwritten.json");
+    REQUIRE(system.A.rows() == 3);
+    REQUIRE(system.A.cols() == 2);
+    REQUIRE(system.A.nonZeros() == 2);
+    REQUIRE(system.A.coeff(0, 0) == -3.0);
+    REQUIRE(system.A.coeff(2, 1) == 1.25);
+    REQUIRE(system.b.col(0) == Eigen::Vector3d(-1.0, 3.0, 2.5));
+    REQUIRE(system.metadata["version_number"] == 2);
+    REQUIRE(system.metadata["tags"] == nlohmann::json::array({1}));
+
+    {
+        std::ofstream out("invalid.json");
+        out << R"({"metadata": {"raw_dump_version": 2}, "A": {"rows": 1, "cols": 1, "nnz": 1,)"
+            << R"( "triplets": [[0, 0, "0x1p+0"], [0, 0, "0x1p+0"]]}, "b": ["0x1p+0"]})";
+    }
+    REQUIRE_THROWS(benchy::io::load_problem_system<double>("invalid.json"));
+}
+
+TEST_CASE("binary io", "[io]")
+{
+    test_binary_io<double>();
+    test_binary_io<float>();
+}
+
+TEST_CASE("save problem", "[io]")
+{
+    test_save_problem<double>();
+    test_save_problem<float>();
+}
+
+TEST_CASE("symmetric storage", "[io]")
+{
+    using benchy::io::StoredTriangle;
+    auto system = random_system<double>(100, 1);
+    Eigen::SparseMatrix<double> full = system.A + Eigen::SparseMatrix<double>(system.A.transpose());
+    system.A = full;
+
+    // Only systems flagged as SPD are converted
+    REQUIRE(!benchy::io::make_half_storage(system));
+    system.metadata["is_symmetric_positive_definite"] = 1;
+    REQUIRE(benchy::io::make_half_storage(system));
+    REQUIRE(system.metadata["stored_triangle"] == "lower");
+    REQUIRE(benchy::io::stored_triangle(system.metadata) == StoredTriangle::Lower);
+    Eigen::SparseMatrix<double> strict_upper = system.A.triangularView<Eigen::StrictlyUpper>();
+    REQUIRE(strict_upper.nonZeros() == 0);
+    REQUIRE(benchy::io::full_nonzeros(system.A, StoredTriangle::Lower) == full.nonZeros());
+
+    Eigen::VectorXd x = Eigen::VectorXd::Random(100);
+    REQUIRE(benchy::io::multiply(system.A, StoredTriangle::Lower, x).isApprox(full * x));
+    auto upper =
+        benchy::io::convert_storage(system.A, StoredTriangle::Lower, StoredTriangle::Upper);
+    REQUIRE(benchy::io::multiply(upper, StoredTriangle::Upper, x).isApprox(full * x));
+
+    // The tag is preserved by all formats
+    benchy::io::save_binary("half.bcsc", system);
+    const auto flags = benchy::io::MappedSystem("half.bcsc").header().flags;
+    REQUIRE(flags == benchy::io::kBinaryFlagLowerTriangle);
+    benchy::io::save_compressed("half.zst", system);
+    for (const std::string filename : {"half.bcsc", "half.zst"}) {
+        auto loaded = benchy::io::load_system<double>(filename);
+        REQUIRE(benchy::io::stored_triangle(loaded.metadata) == StoredTriangle::Lower);
+        REQUIRE(loaded.A.nonZeros() == system.A.nonZeros());
+        benchy::io::make_full_storage(loaded);
+        REQUIRE(loaded.A.isApprox(full, 0));
+        REQUIRE(!loaded.metadata.contains("stored_triangle"));
+    }
+
+    // Matrices flagged as SPD that are not symmetric are kept as-is
+    system.A = full;
+    system.A.coeffRef(0, 1) += 1;
+    system.metadata.erase("stored_triangle");
+    REQUIRE(!benchy::io::make_half_storage(system));
+}
+
+TEST_CASE("catalog", "[io]")
+{
+    const fs::path root = "catalog_test";
+    fs::remove_all(root);
+    fs::create_directories(root / "dataset");
+
+    auto system = random_system<double>(50, 1);
+    system.A = Eigen::SparseMatrix<double>(system.A.transpose()) + system.A;
+    system.metadata["is_symmetric_positive_definite"] = 1;
+    system.metadata["dimension"] = 3;
+    const auto full_nnz = system.A.nonZeros();
+    benchy::io::save_compressed(root / "dataset/full.zst", system);
+    benchy::io::make_half_storage(system);
+    benchy::io::save_compressed(root / "dataset/half.zst", system);
+    benchy::io::save_binary(root / "dataset/half.bcsc", system);
+    nlohmann::json encoded = system;
+    encoded["A"] = benchy::io::encode_sparse_matrix(system.A);
+    benchy::io::save_compressed(root / "dataset/encoded.zst", encoded);
+    const auto problem_path = (root / "dataset/problem.json").string();
+    REQUIRE(benchy::io::save_problem(problem_path, random_problem<float>(50)));
+
+    for (const std::string name : {"full.zst", "half.zst", "half.bcsc", "encoded.zst"}) {
+        const auto info = benchy::io::read_system_info(root / "dataset" / name);
+        REQUIRE(info.rows == 50);
+        REQUIRE(info.cols == 50);
+        REQUIRE(info.nnz == full_nnz);
+        REQUIRE(info.dataset_name == "random");
+        REQUIRE(info.dimension == 3);
+        REQUIRE(info.is_symmetric_positive_definite == 1);
+        REQUIRE(info.file_size == fs::file_size(root / "dataset" / name));
+    }
+
+    const auto catalog_path = root / benchy::io::Catalog::default_filename();
+    {
+        benchy::io::Catalog catalog(catalog_path);
+        for (const auto& entry : fs::directory_iterator(root / "dataset")) {
+            catalog.get(entry.path());
+        }
+        REQUIRE(catalog.get(root / "dataset/problem.json").is_symmetric_positive_definite == 0);
+        REQUIRE(catalog.num_refreshed() == 5);
+        catalog.save();
+    }
+
+    // Unchanged files are not read again, modified ones are
+    benchy::io::save_compressed(root / "dataset/full.zst", random_system<double>(20, 1));
+    fs::remove(root / "dataset/half.zst");
+    {
+        benchy::io::Catalog catalog(catalog_path);
+        REQUIRE(catalog.size() == 5);
+        REQUIRE(catalog.get(root / "dataset/half.bcsc").nnz == full_nnz);
+        REQUIRE(catalog.num_refreshed() == 0);
+        REQUIRE(catalog.get(root / "dataset/full.zst").rows == 20);
+        REQUIRE(catalog.num_refreshed() == 1);
+        catalog.remove_missing();
+        REQUIRE(catalog.size() == 4);
+    }
+}
+
+TEST_CASE("sequence io", "[io]")
+{
+    // Steps of a sequence share the pattern of A
+    std::vector<benchy::io::LinearSystem<double>> steps(4, random_system<double>(100, 2));
+    for (size_t k = 1; k < steps.size(); ++k) {
+        steps[k].A *= double(k + 1);
+        steps[k].b.array() += double(k);
+    }
+    benchy::io::save_sequence("test.bseq", steps);
+
+    benchy::io::MappedSequence sequence("test.bseq");
+    REQUIRE(sequence.num_steps() == steps.size());
+    REQUIRE(sequence.metadata()["is_sequence_of_problems"] == 1);
+    REQUIRE(sequence.metadata()["num_steps"] == steps.size());
+    REQUIRE(sequence.metadata()["dataset_name"] == "random");
+    benchy::io::LinearSystem<double> system;
+    for (const size_t k : {0, 1, 3, 2}) {
+        REQUIRE(sequence.A<double>(k).isApprox(steps[k].A));
+        REQUIRE(sequence.b<double>(k) == steps[k].b);
+
+        // Only the values are copied once the system holds the pattern
+        const double* values = system.A.valuePtr();
+        sequence.read_step(k, system);
+        REQUIRE((k == 0 || system.A.valuePtr() == values));
+        REQUIRE(system.A.isApprox(steps[k].A));
+        REQUIRE(system.b == steps[k].b);
+    }
+    REQUIRE_THROWS(sequence.values<double>(steps.size()));
+    REQUIRE_THROWS(sequence.values<float>(0));
+
+    // A system filled from another sequence of the same size gets the pattern of this one
+    {
+        Eigen::VectorXi indices = Eigen::VectorXi::LinSpaced(100, 99, 0);
+        Eigen::PermutationMatrix<Eigen::Dynamic> perm(indices);
+        auto permuted = steps[0];
+        permuted.A = steps[0].A.twistedBy(perm);
+        benchy::io::save_sequence("test_permuted.bseq", std::vector{permuted});
+        benchy::io::MappedSequence other("test_permuted.bseq");
+        REQUIRE(other.header().nnz == sequence.header().nnz);
+        other.read_step(0, system);
+        REQUIRE(system.A.isApprox(permuted.A));
+        sequence.read_step(1, system);
+        REQUIRE(system.A.isApprox(steps[1].A));
+    }
+
+    // The pattern is only stored once
+    benchy::io::save_binary("test.bcsc", steps[0]);
+    const size_t pattern_size = steps[0].A.nonZeros() * sizeof(int32_t);
+    REQUIRE(
+        fs::file_size("test.bseq") + (steps.size() - 1) * pattern_size <=
+        steps.size() * fs::file_size("test.bcsc"));
+
+    REQUIRE(benchy::io::load_system<double>("test.bseq").A.isApprox(steps[0].A));
+    REQUIRE(benchy::io::load_sequence_step<float>("test.bseq", 2).b.isApprox(
+        steps[2].b.cast<float>()));
+    const auto info = benchy::io::read_system_info("test.bseq");
+    REQUIRE(info.num_steps == steps.size());
+    REQUIRE(info.nnz == steps[0].A.nonZeros());
+
+    // Steps must share the pattern and rhs size
+    benchy::io::SequenceWriter<double> writer("test_invalid.bseq");
+    writer.add(steps[0]);
+    REQUIRE_THROWS(writer.add(random_system<double>(50, 2)));
+    auto other_b = steps[0];
+    other_b.b.conservativeResize(Eigen::NoChange, 1);
+    REQUIRE_THROWS(writer.add(other_b));
+    writer.finish();
+    REQUIRE(benchy::io::MappedSequence("test_invalid.bseq").num_steps() == 1);
+}
+
+TEST_CASE("pack io", "[io]")
+{
+    const fs::path root = "pack_test";
+    fs::remove_all(root);
+    fs::create_directories(root / "dataset/sub");
+
+    const auto system = random_system<double>(60, 2);
+    const auto other = random_system<float>(40, 1);
+    std::vector<benchy::io::LinearSystem<double>> steps(3, system);
+    steps[2].A *= 2.0;
+    benchy::io::save_binary(root / "dataset/a.bcsc", system);
+    benchy::io::save_compressed(root / "dataset/sub/b.zst", other);
+    benchy::io::save_sequence(root / "dataset/sub/c.bseq", steps);
+
+    const auto pack_path = root / "dataset.bpack";
+    {
+        benchy::io::PackWriter writer(pack_path);
+        for (const std::string name : {"a.bcsc", "sub/b.zst", "sub/c.bseq"}) {
+            writer.add(name, root / "dataset" / name);
+        }
+        REQUIRE_THROWS(writer.add("a.bcsc", root / "dataset/a.bcsc"));
+        REQUIRE_THROWS(writer.add("d.txt", root / "dataset/d.txt"));
+        REQUIRE(writer.num_entries() == 3);
+        writer.finish();
+    }
+
+    benchy::io::MappedPack pack(pack_path);
+    REQUIRE(pack.size() == 3);
+    REQUIRE(pack.entry(0).name == "a.bcsc");
+    REQUIRE(pack.entry(1).format == benchy::io::PackFormat::Compressed);
+    REQUIRE(pack.index_of("sub/c.bseq") == 2);
+    REQUIRE_FALSE(pack.contains("c.bseq"));
+    REQUIRE_THROWS(pack.index_of("missing.zst"));
+    for (const auto& entry : pack.entries()) {
+        REQUIRE(entry.offset % benchy::io::kBinaryAlignment == 0);
+        REQUIRE(entry.size == fs::file_size(root / "dataset" / entry.name));
+        REQUIRE(entry.info.dataset_name == "random");
+    }
+    REQUIRE(pack.entry(0).info.nnz == system.A.nonZeros());
+    REQUIRE(pack.entry(2).info.num_steps == 3);
+
+    // Members are loaded by index, or used in place
+    REQUIRE(pack.load<double>(0).A.isApprox(system.A));
+    REQUIRE(pack.load<double>(0).b == system.b);
+    REQUIRE(pack.load<float>(1).A.isApprox(other.A));
+    REQUIRE(pack.load<float>(1).b == other.b);
+    REQUIRE(pack.load<double>(2).A.isApprox(steps[0].A));
+    REQUIRE(pack.system(0).A<double>().isApprox(system.A));
+    REQUIRE(pack.sequence(2).A<double>(2).isApprox(steps[2].A));
+    REQUIRE_THROWS(pack.system(1));
+    REQUIRE_THROWS(pack.sequence(0));
+
+    // Paths to members are accepted in place of the original files
+    fs::path pack_file;
+    std::string name;
+    REQUIRE(benchy::io::split_pack_path(pack.member_path(1), pack_file, name));
+    REQUIRE(pack_file == pack_path);
+    REQUIRE(name == "sub/b.zst");
+    REQUIRE_FALSE(benchy::io::split_pack_path(root / "dataset/sub/b.zst", pack_file, name));
+    REQUIRE_FALSE(benchy::io::split_pack_path(pack_path, pack_file, name));
+    REQUIRE(benchy::io::load_system<float>(pack_path / "sub/b.zst").b == other.b);
+    REQUIRE(benchy::io::read_system_info(pack_path / "sub/c.bseq").num_steps == 3);
+    const auto shared = benchy::io::open_pack(pack_path);
+    REQUIRE(benchy::io::open_pack(pack_path) == shared);
+
+    const auto catalog_path = root / benchy::io::Catalog::default_filename();
+    {
+        benchy::io::Catalog catalog(catalog_path);
+        REQUIRE(catalog.get(pack_path / "a.bcsc").rows == 60);
+        REQUIRE(catalog.get(pack_path / "sub/b.zst").rows == 40);
+        catalog.save();
+    }
+    {
+        benchy::io::Catalog catalog(catalog_path);
+        REQUIRE(catalog.get(pack_path / "a.bcsc").nnz == system.A.nonZeros());
+        REQUIRE(catalog.num_refreshed() == 0);
+        catalog.remove_missing();
+        REQUIRE(catalog.size() == 2);
+    }
+
+    // Truncated packs are rejected
+    fs::copy_file(pack_path, root / "truncated.bpack");
+    fs::resize_file(root / "truncated.bpack", fs::file_size(pack_path) - 16);
+    REQUIRE_THROWS(benchy::io::MappedPack(root / "truncated.bpack"));
+}
+
+TEST_CASE("system cache", "[io]")
+{
+    const fs::path root = "cache_test";
+    fs::create_directories(root);
+    std::vector<fs::path> paths;
+    std::vector<benchy::io::LinearSystem<double>> systems;
+    for (int i = 0; i < 3; ++i) {
+        paths.push_back(root / ("system_" + std::to_string(i) + ".zst"));
+        systems.push_back(random_system<double>(20 + i, 1));
+        benchy::io::save_compressed(paths.back(), systems.back());
+    }
+
+    SECTION("shared systems")
+    {
+        benchy::io::SystemCache<double> cache;
+        const auto system = cache.get(paths[0]);
+        REQUIRE(system->A.isApprox(systems[0].A));
+        REQUIRE(system->b.isApprox(systems[0].b));
+        REQUIRE(cache.get(root / "." / paths[0].filename()) == system);
+        REQUIRE(cache.num_misses() == 1);
+        REQUIRE(cache.num_hits() == 1);
+        REQUIRE(cache.num_bytes() > 0);
+    }
+
+    SECTION("prefetch")
+    {
+        // Same order as the benchmark: several samples per system, then wrap around
+        benchy::io::SystemCache<double> cache(0, 2);
+        for (const size_t index : {0, 0, 1, 1, 2, 0}) {
+            REQUIRE(cache.get(paths[index])->A.rows() == 20 + index);
+            cache.prefetch(paths[(index + 1) % paths.size()]);
+            REQUIRE(cache.size() <= 2);
+        }
+        REQUIRE(cache.num_misses() == 1);
+        REQUIRE(cache.num_hits() == 5);
+
+        // Waiting for the prefetched system accounts for its memory
+        benchy::io::SystemCache<double> pending;
+        pending.wait_pending();
+        pending.get(paths[0]);
+        const size_t num_bytes = pending.num_bytes();
+        pending.prefetch(paths[1]);
+        pending.wait_pending();
+        REQUIRE(pending.size() == 2);
+        REQUIRE(pending.num_bytes() > num_bytes);
+        REQUIRE(pending.num_misses() == 1);
+
+        // Without prefetching, only the last system is kept
+        benchy::io::SystemCache<double> single(0, 1);
+        for (const size_t index : {0, 0, 1, 2}) {
+            REQUIRE(single.get(paths[index])->A.rows() == 20 + index);
+            single.prefetch(paths[(index + 1) % paths.size()]);
+            REQUIRE(single.size() == 1);
+        }
+        REQUIRE(single.num_misses() == 3);
+        REQUIRE(single.num_evictions() == 2);
+    }
+
+    SECTION("memory budget")
+    {
+        benchy::io::SystemCache<double> cache(1);
+        const auto system = cache.get(paths[0]);
+        REQUIRE(cache.size() == 1);
+        cache.prefetch(paths[1]);
+        REQUIRE(cache.size() == 1);
+
+        // Evicted systems stay valid while they are referenced
+        REQUIRE(cache.get(paths[1])->A.rows() == 21);
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.num_evictions() == 1);
+        REQUIRE(system->A.isApprox(systems[0].A));
+    }
+
+    SECTION("errors")
+    {
+        // Loading errors are reported to the caller, also when they happen in the background
+        benchy::io::SystemCache<double> cache;
+        cache.prefetch(root / "missing.zst");
+        REQUIRE_THROWS(cache.get(root / "missing.zst"));
+        REQUIRE_THROWS(cache.get(root / "missing.zst"));
+        REQUIRE(cache.size() == 0);
+        REQUIRE(cache.get(paths[0])->A.rows() == 20);
+    }
+}
+
+TEST_CASE("streaming decompression", "[io]")
+{
+    nlohmann::json data = random_system<double>(1000, 1);
+
+    save_streamed("streamed.zst", nlohmann::json::to_msgpack(data));
+    REQUIRE(benchy::io::load_compressed("streamed.zst") == data);
+
+    benchy::io::save_compressed("test.zst", data);
+    REQUIRE(benchy::io::load_compressed("test.zst") == data);
+}
+
+TEST_CASE("compression options", "[io]")
+{
+    nlohmann::json data = random_system<double>(1000, 1);
+
+    benchy::io::CompressionOptions options;
+    options.level = 19;
+    options.num_workers = 2;
+    options.long_distance_matching = true;
+    options.window_log = 28;
+    benchy::io::save_compressed("tuned.zst", data, options);
+    REQUIRE(benchy::io::load_compressed("tuned.zst") == data);
+
+    options = {};
+    options.level = -5;
+    benchy::io::save_compressed("fast.zst", data, options);
+    REQUIRE(benchy::io::load_compressed("fast.zst") == data);
+
+    options.window_log = 100;
+    REQUIRE_THROWS(benchy::io::save_compressed("invalid.zst", data, options));
+}
+
+TEST_CASE("decode compressed system", "[io]")
+{
+    auto system = random_system<double>(200, 3);
+    nlohmann::json data = system;
+    data["metadata"]["nested"] = {{"values", {1, 2, 3}}};
+    benchy::io::save_compressed("test.zst", data);
+
+    // Decoded system matches the json DOM path
+    {
+        auto system2 = benchy::io::load_compressed_system<double>("test.zst");
+        auto system3 =
+            benchy::io::load_compressed("test.zst").get<benchy::io::LinearSystem<double>>();
+        REQUIRE(system2.A.isApprox(system.A, 0));
+        REQUIRE(system2.A.isApprox(system3.A, 0));
+        REQUIRE(system2.b == system.b);
+        REQUIRE(system2.metadata == data["metadata"]);
+    }
+
+    // Legacy keys and entries that are not sorted by column
+    {
+        auto entries = data["A"];
+        for (int i = 2; i < 5; ++i) {
+            std::reverse(entries[i].begin(), entries[i].end());
+        }
+        nlohmann::json legacy;
+        legacy["lhs"] = entries;
+        legacy["rhs"] = Eigen::VectorXd(system.b.col(0));
+        benchy::io::save_compressed("legacy.zst", legacy);
+
+        auto system2 = benchy::io::load_compressed_system<float>("legacy.zst");
+        REQUIRE(system2.A.isApprox(system.A.cast<float>(), 0));
+        REQUIRE(system2.b.cols() == 1);
+        REQUIRE(system2.b == system.b.col(0).cast<float>());
+    }
+}
+
+TEST_CASE("index encoding", "[io]")
+{
+    // Values of 1 to 4 bytes, with a partial last group
+    std::vector<uint32_t> values;
+    std::mt19937 gen;
+    for (int i = 0; i < 1001; ++i) {
+        const int bits = std::uniform_int_distribution<int>(1, 32)(gen);
+        values.push_back(static_cast<uint32_t>(gen()) >> (32 - bits));
+    }
+    const auto encoded = benchy::io::encode_varints(values.data(), values.size());
+    for (bool allow_simd : {true, false}) {
+        std::vector<uint32_t> decoded(values.size());
+        benchy::io::decode_varints(
+            encoded.data(),
+            encoded.size(),
+            decoded.size(),
+            decoded.data(),
+            allow_simd);
+        REQUIRE(decoded == values);
+    }
+    std::vector<uint32_t> decoded(values.size());
+    REQUIRE_THROWS(benchy::io::decode_varints(
+        encoded.data(),
+        encoded.size() - 1,
+        decoded.size(),
+        decoded.data()));
+
+    // Archives with compressed indices are detected by both loaders
+    auto system = random_system<double>(200, 2);
+    nlohmann::json data = system;
+    benchy::io::save_compressed("plain.zst", data);
+    data["A"] = benchy::io::encode_sparse_matrix(system.A);
+    benchy::io::save_compressed("encoded.zst", data);
+    REQUIRE(fs::file_size("encoded.zst") < fs::file_size("plain.zst"));
+    {
+        auto system2 = benchy::io::load_compressed_system<double>("encoded.zst");
+        auto system3 =
+            benchy::io::load_compressed("encoded.zst").get<benchy::io::LinearSystem<double>>();
+        REQUIRE(system2.A.isApprox(system.A, 0));
+        REQUIRE(system3.A.isApprox(system.A, 0));
+        REQUIRE(system2.b == system.b);
+        REQUIRE(system2.metadata == system.metadata);
+    }
+
+    // Values stored in single precision
+    {
+        Eigen::SparseMatrix<float> A = system.A.cast<float>();
+        data["A"] = benchy::io::encode_sparse_matrix(A);
+        benchy::io::save_compressed("encoded.zst", data);
+        auto system2 = benchy::io::load_compressed_system<double>("encoded.zst");
+        REQUIRE(system2.A.isApprox(A.cast<double>(), 0));
+    }
+
+    // Row index out of bounds
+    {
+        auto A = benchy::io::encode_sparse_matrix(system.A);
+        A.rows = 10;
+        Eigen::SparseMatrix<double> A2;
+        REQUIRE_THROWS(benchy::io::decode_sparse_matrix(A, A2));
+    }
+}
+
+TEST_CASE("matrix market", "[io]")
+{
+    auto write_mtx = [](const fs::path& filename,
+                        const std::string& banner,
+                        const std::string& size,
+                        const std::vector<std::string>& lines) {
+        std::ofstream fl(filename);
+        fl << "%%MatrixMarket matrix " << banner << "\n% comment line\n" << size << "\n";
+        for (const auto& line : lines) {
+            fl << line << "\n";
+        }
+    };
+    auto entry = [](Eigen::Index row, Eigen::Index col, double value) {
+        std::ostringstream line;
+        line << std::setprecision(17) << row + 1 << " " << col + 1 << " " << value;
+        return line.str();
+    };
+
+    const int n = 300;
+    const auto system = random_system<double>(n, 2);
+    const Eigen::SparseMatrix<double>& A = system.A;
+    const Eigen::VectorXd ones = Eigen::VectorXd::Ones(n);
+    std::vector<std::string> lines;
+    for (Eigen::Index j = 0; j < A.outerSize(); ++j) {
+        for (Eigen::SparseMatrix<double>::InnerIterator it(A, j); it; ++it) {
+            lines.push_back(entry(it.row(), it.col(), it.value()));
+        }
+    }
+    auto size = [&]() {
+        return std::to_string(n) + " " + std::to_string(n) + " " + std::to_string(lines.size());
+    };
+    write_mtx("sorted.mtx", "coordinate real general", size(), lines);
+    std::shuffle(lines.begin(), lines.end(), std::mt19937());
+    write_mtx("shuffled.mtx", "coordinate real general", size(), lines);
+
+    // Small blocks, so that both files are parsed by several threads
+    const benchy::io::MatrixMarketOptions options{4, 256};
+    for (const char* filename : {"sorted.mtx", "shuffled.mtx"}) {
+        const auto imported = benchy::io::load_matrix_market<double>(filename, {}, options);
+        REQUIRE(imported.A.isApprox(A, 0));
+        REQUIRE(imported.b.isApprox(A * ones));
+        REQUIRE(imported.metadata["generated_rhs"] == 1);
+        REQUIRE(imported.metadata["description"] == "comment line");
+        Eigen::SparseMatrix<double> expected;
+        REQUIRE(loadMarket(expected, filename));
+        REQUIRE(imported.A.isApprox(expected, 0));
+    }
+
+    // Duplicate entries are summed
+    lines.push_back(lines.front());
+    write_mtx("duplicates.mtx", "coordinate real general", size(), lines);
+    {
+        const auto imported = benchy::io::load_matrix_market<double>("duplicates.mtx", {}, options);
+        REQUIRE(imported.A.nonZeros() == A.nonZeros());
+        REQUIRE((imported.A - A).norm() > 0);
+    }
+
+    // Symmetric matrices keep their lower triangle, even if entries are given in the upper one
+    const Eigen::SparseMatrix<double> S = A + Eigen::SparseMatrix<double>(A.transpose());
+    const Eigen::SparseMatrix<double> L = S.triangularView<Eigen::Lower>();
+    lines.clear();
+    for (Eigen::Index j = 0; j < L.outerSize(); ++j) {
+        for (Eigen::SparseMatrix<double>::InnerIterator it(L, j); it; ++it) {
+            const bool upper = (lines.size() % 3 == 0);
+            lines.push_back(upper ? entry(it.col(), it.row(), it.value())
+                                  : entry(it.row(), it.col(), it.value()));
+        }
+    }
+    write_mtx("symmetric.mtx", "coordinate real symmetric", size(), lines);
+    {
+        const auto imported = benchy::io::load_matrix_market<float>("symmetric.mtx", {}, options);
+        const auto triangle = benchy::io::stored_triangle(imported.metadata);
+        REQUIRE(triangle == benchy::io::StoredTriangle::Lower);
+        REQUIRE(imported.A.isApprox(L.cast<float>(), 0));
+        REQUIRE(imported.b.isApprox((S * ones).cast<float>()));
+    }
+
+    // Pattern matrix, with a rhs in array format
+    lines.clear();
+    for (Eigen::Index j = 0; j < A.outerSize(); ++j) {
+        for (Eigen::SparseMatrix<double>::InnerIterator it(A, j); it; ++it) {
+            lines.push_back(std::to_string(it.row() + 1) + " " + std::to_string(it.col() + 1));
+        }
+    }
+    write_mtx("pattern.mtx", "coordinate pattern general", size(), lines);
+    lines.clear();
+    for (Eigen::Index k = 0; k < system.b.size(); ++k) {
+        std::ostringstream line;
+        line << std::setprecision(17) << system.b.data()[k];
+        lines.push_back(line.str());
+    }
+    write_mtx("pattern_b.mtx", "array real general", std::to_string(n) + " 2", lines);
+    {
+        const auto imported =
+            benchy::io::load_matrix_market<double>("pattern.mtx", "pattern_b.mtx");
+        REQUIRE(imported.A.nonZeros() == A.nonZeros());
+        REQUIRE(imported.A.coeffs().minCoeff() == 1);
+        REQUIRE(imported.A.coeffs().maxCoeff() == 1);
+        REQUIRE(imported.b == system.b);
+        REQUIRE(!imported.metadata.contains("generated_rhs"));
+    }
+
+    // Invalid files
+    write_mtx("invalid.mtx", "coordinate real general", "2 2 2", {"1 1 1.0"});
+    REQUIRE_THROWS(benchy::io::load_matrix_market<double>("invalid.mtx"));
+    write_mtx("invalid.mtx", "coordinate real general", "2 2 1", {"3 1 1.0"});
+    REQUIRE_THROWS(benchy::io::load_matrix_market<double>("invalid.mtx"));
+    write_mtx("invalid.mtx", "coordinate complex general", "2 2 1", {"1 1 1.0 0.0"});
+    REQUIRE_THROWS(benchy::io::load_matrix_market<double>("invalid.mtx"));
+    write_mtx("invalid_b.mtx", "array real general", "2 1", {"1.0", "2.0"});
+    REQUIRE_THROWS(benchy::io::load_matrix_market<double>("sorted.mtx", "invalid_b.mtx"));
+}
+
+#ifdef BENCHY_CONVERT_EXECUTABLE
+TEST_CASE("convert directory", "[io]")
+{
+    const fs::path root = "convert_directory";
+    fs::remove_all(root);
+    fs::create_directories(root / "in/sub");
+    const auto system = random_system<double>(50, 1);
+    benchy::io::save_compressed(root / "in/a.zst", system);
+    benchy::io::save_compressed(root / "in/sub/b.zst", system);
+    auto convert = [&](const std::string& args) {
+        const std::string command = std::string("\"") + BENCHY_CONVERT_EXECUTABLE + "\" " + args;
+        return std::system(command.c_str());
+    };
+    const std::string input = "--input-dir " + (root / "in").string();
+
+    REQUIRE(convert(input + " --output-dir " + (root / "out").string() + " --format bcsc") == 0);
+    REQUIRE(benchy::io::load_system<double>(root / "out/a.bcsc").A.isApprox(system.A, 0));
+    REQUIRE(benchy::io::load_system<double>(root / "out/sub/b.bcsc").A.isApprox(system.A, 0));
+
+    // Converting a directory into itself is rejected
+    REQUIRE(convert(input + " --output-dir " + (root / "in").string() + " --format zst") != 0);
+    REQUIRE(convert(input + " --output-dir " + (root / "in/sub/..").string() + " --force") != 0);
+
+    // An output directory inside the input directory is not converted again
+    const std::string nested = input + " --output-dir " + (root / "in/out").string();
+    REQUIRE(convert(nested + " --format bcsc") == 0);
+    REQUIRE(convert(nested + " --format bcsc --force") == 0);
+    REQUIRE(fs::exists(root / "in/out/sub/b.bcsc"));
+    REQUIRE(!fs::exists(root / "in/out/out"));
+    size_t num_outputs = 0;
+    for (const auto& entry : fs::recursive_directory_iterator(root / "in/out")) {
+        num_outputs += entry.is_regular_file();
+    }
+    REQUIRE(num_outputs == 2);
+
+    // Inputs which would be converted to the same output are skipped and reported as failures
+    fs::create_directories(root / "dup");
+    benchy::io::save_compressed(root / "dup/a.zst", system);
+    benchy::io::save_binary(root / "dup/a.bcsc", system);
+    benchy::io::save_compressed(root / "dup/b.zst", system);
+    const std::string dup = "--input-dir " + (root / "dup").string() + " --format bcsc";
+    REQUIRE(convert(dup + " --output-dir " + (root / "dup_out").string()) != 0);
+    REQUIRE(!fs::exists(root / "dup_out/a.bcsc"));
+    REQUIRE(!fs::exists(root / "dup_out/a.partial.bcsc"));
+    REQUIRE(benchy::io::load_system<double>(root / "dup_out/b.bcsc").A.isApprox(system.A, 0));
+}
+#endif
+
+#ifdef BENCHY_WITH_HDF5
+TEST_CASE("hdf5 store", "[io]")
+{
+    std::vector<benchy::io::LinearSystem<double>> steps(3, random_system<double>(100, 2));
+    for (size_t k = 1; k < steps.size(); ++k) {
+        steps[k].A *= double(k + 1);
+        steps[k].b.array() += double(k);
+    }
+    auto single = random_system<float>(50, 1);
+    auto half = random_system<double>(40, 1);
+    const Eigen::SparseMatrix<double> full =
+        half.A + Eigen::SparseMatrix<double>(half.A.transpose());
+    half.A = full;
+    half.metadata["is_symmetric_positive_definite"] = 1;
+    REQUIRE(benchy::io::make_half_storage(half));
+    Eigen::VectorXi indices = Eigen::VectorXi::LinSpaced(100, 99, 0);
+    Eigen::PermutationMatrix<Eigen::Dynamic> perm(indices);
+    auto permuted = steps[0];
+    permuted.A = steps[0].A.twistedBy(perm);
+    {
+        benchy::io::Hdf5Store store("test.h5", benchy::io::Hdf5Store::Mode::Truncate, {4, 64});
+        store.write("harmonic/sequence", steps);
+        store.write("single", single);
+        REQUIRE_THROWS(store.write("single/nested", single));
+        REQUIRE_THROWS(store.write("harmonic", single));
+        REQUIRE_THROWS(store.write("other", std::vector<benchy::io::LinearSystem<float>>()));
+    }
+
+    // HDF5 cannot open a file for writing while it is open for reading
+    {
+        benchy::io::Hdf5Store store("test.h5");
+        REQUIRE(store.problems() == std::vector<std::string>{"harmonic/sequence", "single"});
+        REQUIRE(store.contains("single"));
+        REQUIRE(!store.contains("harmonic"));
+        REQUIRE(!store.contains("missing/problem"));
+
+        // Metadata only
+        const auto info = store.info("harmonic/sequence");
+        REQUIRE(info.num_steps == 3);
+        REQUIRE(info.nnz == steps[0].A.nonZeros());
+        REQUIRE(info.b_cols == 2);
+        REQUIRE(info.scalar_size == sizeof(double));
+        REQUIRE(info.metadata["num_steps"] == 3);
+        REQUIRE(info.metadata["dataset_name"] == "random");
+        REQUIRE(store.info("single").scalar_size == sizeof(float));
+
+        // Pattern only, then single steps that only read the values
+        benchy::io::LinearSystem<double> system;
+        system.A = store.read_pattern<double>("harmonic/sequence");
+        REQUIRE(system.A.rows() == steps[0].A.rows());
+        REQUIRE(system.A.nonZeros() == steps[0].A.nonZeros());
+        for (const size_t k : {2, 0, 1}) {
+            const double* values = system.A.valuePtr();
+            store.read_step("harmonic/sequence", k, system);
+            REQUIRE(system.A.valuePtr() == values);
+            REQUIRE(system.A.isApprox(steps[k].A, 0));
+            REQUIRE(system.b == steps[k].b);
+        }
+        REQUIRE_THROWS(store.read<double>("harmonic/sequence", 3));
+        REQUIRE_THROWS(store.read<double>("missing"));
+
+        // Values are converted to the requested precision
+        auto single2 = store.read<double>("single");
+        REQUIRE(single2.A.isApprox(single.A.cast<double>(), 0));
+        REQUIRE(single2.b == single.b.cast<double>());
+    }
+
+    // Problems can be added and replaced
+    {
+        benchy::io::Hdf5Store append("test.h5", benchy::io::Hdf5Store::Mode::Append);
+        append.write("single", steps[1]);
+        append.write("other", steps[2]);
+        append.write("half", half);
+        append.write("permuted", permuted);
+    }
+    benchy::io::Hdf5Store store2("test.h5");
+    REQUIRE(store2.problems().size() == 5);
+    REQUIRE(store2.read<double>("single").A.isApprox(steps[1].A, 0));
+
+    // A system filled from another problem of the same size does not keep its pattern
+    {
+        benchy::io::LinearSystem<double> system;
+        store2.read_step("harmonic/sequence", 0, system);
+        REQUIRE(system.A.nonZeros() == permuted.A.nonZeros());
+        store2.read_step("permuted", 0, system);
+        REQUIRE(system.A.isApprox(permuted.A, 0));
+        store2.read_step("harmonic/sequence", 1, system);
+        REQUIRE(system.A.isApprox(steps[1].A, 0));
+    }
+    REQUIRE_THROWS(benchy::io::Hdf5Store("test.bcsc"));
+
+    // Paths to problems are accepted in place of system files
+    const fs::path store_path = "test.h5";
+    fs::path store_file;
+    std::string name;
+    REQUIRE(benchy::io::split_store_path(store_path / "harmonic/sequence", store_file, name));
+    REQUIRE(store_file == store_path);
+    REQUIRE(name == "harmonic/sequence");
+    REQUIRE_FALSE(benchy::io::split_store_path(store_path, store_file, name));
+    REQUIRE_FALSE(benchy::io::split_store_path("dataset/a.zst", store_file, name));
+    REQUIRE(benchy::io::load_system<double>(store_path / "other").A.isApprox(steps[2].A, 0));
+    REQUIRE(benchy::io::read_system_info(store_path / "harmonic/sequence").num_steps == 3);
+    REQUIRE(benchy::io::read_system_info(store_path / "half").nnz == full.nonZeros());
+    const auto shared = benchy::io::open_store(store_path);
+    REQUIRE(benchy::io::open_store(store_path) == shared);
+
+    const fs::path catalog_path = "hdf5_catalog.json";
+    fs::remove(catalog_path);
+    {
+        benchy::io::Catalog catalog(catalog_path);
+        REQUIRE(catalog.get(store_path / "single").rows == steps[1].A.rows());
+        REQUIRE(catalog.get(store_path / "half").nnz == full.nonZeros());
+        REQUIRE_THROWS(catalog.get(store_path / "missing"));
+        catalog.save();
+    }
+    {
+        benchy::io::Catalog catalog(catalog_path);
+        REQUIRE(catalog.get(store_path / "single").nnz == steps[1].A.nonZeros());
+        REQUIRE(catalog.num_refreshed() == 0);
+        catalog.remove_missing();
+        REQUIRE(catalog.size() == 2);
+    }
+}
+#endif
@@ -11,6 +11,9 @@
  */
 // Local include
 #include <benchy/benchmark/benchmark.h>
+#include <benchy/io/catalog.h>
+#include <benchy/io/hdf5_store.h>
+#include <benchy/io/pack_io.h>
 
 // Third-party include
 #include <celero/Celero.h>
@@ -20,12 +23,16 @@
 // System include
 #include <filesystem>
 #include <regex>
+#include <string>
 #include <vector>
 
 namespace fs = std::filesystem;
 namespace b = benchy::benchmark;
 
-int add_allowed_experiments(const fs::path data_dir, const std::string regex_str)
+int add_allowed_experiments(
+    const fs::path data_dir,
+    const std::string regex_str,
+    const fs::path catalog_path)
 {
     spdlog::info(
         "Generating benchmark dataset from {0} that match regex {1}",
@@ -33,22 +40,54 @@ int add_allowed_experiments(const fs::path data_dir, const std::string regex_str
         regex_str);
     std::regex regex = std::regex(regex_str);
 
-    // Recursively searches data directory for .zst files
+    // Lists the members of a pack from its table, the problems of a store, or recursively searches
+    // data directory for .zst, .bcsc and .bseq files
     std::vector<fs::path> all_zst_files;
-    for (const auto& problem_dir : fs::directory_iterator(data_dir)) {
-        if (problem_dir.path().filename() == "test") {
-            // Skip test folder :)
-            continue;
+    if (fs::is_regular_file(data_dir) && data_dir.extension() == ".h5") {
+#ifdef BENCHY_WITH_HDF5
+        auto& store = b::BenchmarkData::instance().m_store;
+        store = benchy::io::open_store(data_dir);
+        for (const auto& name : store->problems()) {
+            if (name.rfind("test/", 0) == 0) {
+                // Skip test folder :)
+                continue;
+            }
+            all_zst_files.push_back(data_dir / name);
+        }
+#else
+        spdlog::critical(
+            "Cannot read {}, benchy was built without HDF5 support. Exiting",
+            data_dir.string());
+        return 1;
+#endif
+    } else if (fs::is_regular_file(data_dir)) {
+        auto& pack = b::BenchmarkData::instance().m_pack;
+        pack = benchy::io::open_pack(data_dir);
+        for (size_t i = 0; i < pack->size(); ++i) {
+            if (pack->entry(i).name.rfind("test/", 0) == 0) {
+                // Skip test folder :)
+                continue;
+            }
+            all_zst_files.push_back(pack->member_path(i));
         }
-        for (const auto& system_path : fs::recursive_directory_iterator(problem_dir)) {
-            const auto ext = system_path.path().extension();
-            if (ext == ".zst") {
-                all_zst_files.push_back(system_path);
+    } else {
+        for (const auto& problem_dir : fs::directory_iterator(data_dir)) {
+            if (problem_dir.path().filename() == "test") {
+                // Skip test folder :)
+                continue;
+            }
+            for (const auto& system_path : fs::recursive_directory_iterator(problem_dir)) {
+                const auto ext = system_path.path().extension();
+                if (ext == ".zst" || ext == ".bcsc" || ext == ".bseq") {
+                    all_zst_files.push_back(system_path);
+                }
             }
         }
     }
     if (all_zst_files.empty()) {
-        spdlog::critical("No .zst files found in directory {}. Exiting", data_dir.string());
+        spdlog::critical(
+            "No .zst, .bcsc, .bseq files or problems found in {}. Exiting",
+            data_dir.string());
         return 1;
     }
 
@@ -59,12 +98,30 @@ int add_allowed_experiments(const fs::path data_dir, const std::string regex_str
     }
     if (b::BenchmarkData::instance().m_experiment_paths.empty()) {
         spdlog::critical(
-            "No .zst paths in {} match regex {}. Exiting",
+            "No .zst, .bcsc, .bseq or problem paths in {} match regex {}. Exiting",
             data_dir.string(),
             regex_str);
         return 1;
     }
 
+    // Brings the catalog up to date, only reading new or modified systems. The table of a pack
+    // already summarizes its systems, so it is only persisted if requested
+    b::BenchmarkData::instance().m_catalog_path = catalog_path;
+    if (catalog_path.empty()) {
+        return 0;
+    }
+    benchy::io::Catalog catalog(catalog_path);
+    for (const auto& path : b::BenchmarkData::instance().m_experiment_paths) {
+        catalog.get(path);
+    }
+    catalog.remove_missing();
+    catalog.save();
+    spdlog::info(
+        "Catalog {} has {} systems, {} were updated",
+        catalog_path.string(),
+        catalog.size(),
+        catalog.num_refreshed());
+
     return 0;
 }
 
@@ -73,18 +130,101 @@ int main(int argc, char** argv)
     struct
     {
         fs::path input_dir = fs::path(BENCHY_DATA_DIR);
-        std::string regex_str = std::string("(.*.zst)");
+        std::string regex_str = std::string("(.*\\.(zst|bcsc|bseq)|.*\\.h5/.*)");
         fs::path output_dir = fs::path(BENCHY_SOURCE_DIR) / "output";
+        fs::path catalog_path;
+        size_t cache_size = 4096;
+        size_t max_resident = 0;
+        std::vector<int> rhs_counts = {1, 10, 100};
+        std::vector<int> solve_threads = b::BenchmarkData::default_thread_counts();
+        double solve_duration = 1;
+        bool pipeline = false;
+        bool multi_rhs = false;
+        bool concurrent = false;
+        bool mixed_precision = false;
+        std::vector<int> backend_threads;
+        bool thread_sweep = false;
         int log_level = 2;
     } args;
 
     CLI::App app{argv[0]};
     app.option_defaults()->always_capture_default();
-    app.add_option("--input", args.input_dir, "Directory of dataset to run benchmark on")
-        ->check(CLI::ExistingDirectory);
+    app.add_option(
+           "--input",
+           args.input_dir,
+           "Directory of dataset to run benchmark on, or pack of systems (.bpack) or HDF5 store "
+           "(.h5) made from it with benchy_convert")
+        ->check(CLI::ExistingPath);
     app.add_option("--regex", args.regex_str, "Regex to restrict benchmark to");
     app.add_option("--output", args.output_dir, "Directory to write output csv to")
         ->check(CLI::ExistingDirectory);
+    app.add_option(
+        "--catalog",
+        args.catalog_path,
+        "Catalog summarizing the systems of the dataset. Defaults to <input>/" +
+            std::string(benchy::io::Catalog::default_filename()) +
+            ", or to none for a pack, whose table already summarizes its systems");
+    app.add_option(
+        "--cache-size",
+        args.cache_size,
+        "Memory budget in MB for decoded systems shared by all solvers and phases. 0 for no "
+        "limit");
+    app.add_option(
+        "--max-resident",
+        args.max_resident,
+        "Maximum number of decoded systems kept in memory, 0 for no limit. Values other than 1 "
+        "decode the next system in the background between the samples of the current one");
+    app.add_option(
+           "--rhs-counts",
+           args.rhs_counts,
+           "Numbers of right-hand sides solved with a single factorization by the MultiSolve "
+           "benchmarks (see --multi-rhs)")
+        ->check(CLI::PositiveNumber);
+    app.add_option(
+           "--solve-threads",
+           args.solve_threads,
+           "Numbers of threads solving concurrently against one factorization in the "
+           "ConcurrentSolve benchmarks (see --concurrent). Defaults to powers of two up to the "
+           "number of cores")
+        ->check(CLI::PositiveNumber);
+    app.add_option(
+           "--solve-duration",
+           args.solve_duration,
+           "Duration in seconds of each run of the ConcurrentSolve benchmarks")
+        ->check(CLI::PositiveNumber);
+    app.add_flag(
+        "--pipeline",
+        args.pipeline,
+        "Time the analyze, factorize and solve phases in a single pass per sample (Pipeline "
+        "benchmarks) instead of the separate Analyze, Factorize and Solve benchmarks");
+    app.add_flag(
+        "--multi-rhs",
+        args.multi_rhs,
+        "Run the MultiSolve benchmarks, which solve blocks of right-hand sides with a single "
+        "factorization");
+    app.add_flag(
+        "--concurrent",
+        args.concurrent,
+        "Run the ConcurrentSolve benchmarks, which solve from several threads against one "
+        "factorization for --solve-duration seconds per run and thread count");
+    app.add_flag(
+        "--mixed-precision",
+        args.mixed_precision,
+        "Run the MixedPrecision benchmarks, which compare double-precision factorizations with "
+        "single-precision ones followed by iterative refinement");
+    auto* threads_option =
+        app.add_option(
+               "--threads",
+               args.backend_threads,
+               "Numbers of threads of the solver backends (OpenMP, MKL, BLAS) to run every "
+               "benchmark with, e.g. 1 2 4 8. The final CSV then reports the speedup and the "
+               "parallel efficiency over the fewest threads")
+            ->check(CLI::PositiveNumber);
+    app.add_flag(
+           "--thread-sweep",
+           args.thread_sweep,
+           "Same as --threads with powers of two up to the number of cores")
+        ->excludes(threads_option);
     app.add_option(
         "--level",
         args.log_level,
@@ -93,7 +233,34 @@ int main(int argc, char** argv)
     CLI11_PARSE(app, argc, argv);
     spdlog::set_level(static_cast<spdlog::level::level_enum>(args.log_level));
 
-    int status = add_allowed_experiments(args.input_dir, args.regex_str);
+    if (args.catalog_path.empty() && fs::is_directory(args.input_dir)) {
+        args.catalog_path = args.input_dir / benchy::io::Catalog::default_filename();
+    }
+    b::BenchmarkData::instance().m_cache_bytes = args.cache_size << 20;
+    b::BenchmarkData::instance().m_cache_entries = args.max_resident;
+    b::BenchmarkData::instance().m_rhs_counts = args.rhs_counts;
+    b::BenchmarkData::instance().m_solve_threads = args.solve_threads;
+    b::BenchmarkData::instance().m_solve_duration = args.solve_duration;
+    b::BenchmarkData::instance().m_pipeline = args.pipeline;
+    b::BenchmarkData::instance().m_multi_rhs = args.multi_rhs;
+    b::BenchmarkData::instance().m_concurrent = args.concurrent;
+    b::BenchmarkData::instance().m_mixed_precision = args.mixed_precision;
+    if (args.thread_sweep) {
+        args.backend_threads = b::BenchmarkData::default_thread_counts();
+    }
+    if (!args.backend_threads.empty()) {
+        std::string backends;
+        for (const auto& backend : b::thread_backends()) {
+            backends += (backends.empty() ? "" : ", ") + backend;
+        }
+        if (backends.empty()) {
+            spdlog::warn("No threading backend found, the number of threads has no effect");
+        } else {
+            spdlog::info("Sweeping the number of threads of {}", backends);
+        }
+    }
+    b::BenchmarkData::instance().m_backend_threads = args.backend_threads;
+    int status = add_allowed_experiments(args.input_dir, args.regex_str, args.catalog_path);
     if (!status) {
         b::run_benchmarks(argv[0], args.output_dir);
     }
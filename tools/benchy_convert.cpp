@@ -10,51 +10,127 @@
  * governing permissions and limitations under the License.
  */
 // Local include
+#include <benchy/io/binary_io.h>
+#include <benchy/io/hdf5_store.h>
+#include <benchy/io/index_codec.h>
 #include <benchy/io/json_eigen.h>
 #include <benchy/io/json_io.h>
 #include <benchy/io/load_problem.h>
+#include <benchy/io/matrix_market.h>
+#include <benchy/io/pack_io.h>
+#include <benchy/io/sequence_io.h>
+#include <benchy/io/symmetric_storage.h>
 
 // Third-party include
+#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 #include <CLI/CLI.hpp>
 #include <nlohmann/json.hpp>
 #include <unsupported/Eigen/SparseExtra>
 
 // System include
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <map>
+#include <mutex>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 namespace fs = std::filesystem;
 
-int main(int argc, char const* argv[])
+namespace {
+
+///
+/// Settings shared by all conversions
+///
+struct ConvertOptions
 {
-    struct
-    {
-        fs::path left;
-        fs::path right;
-        fs::path input;
-        fs::path output;
-    } args;
+    benchy::io::CompressionOptions compression;
+    benchy::io::MatrixMarketOptions matrix_market;
+    bool full_storage = false;
+    bool encode_indices = false;
 
-    CLI::App app{argv[0]};
-    app.option_defaults()->always_capture_default();
-    auto opt = app.add_option("--input", args.input, "Input linear system")
-                   ->required()
-                   ->check(CLI::ExistingFile);
-    app.add_option(
-           "--output",
-           args.output,
-           "Output archive of the compressed linear system. "
-           "Filename should end with .zst.")
-        ->required();
-    CLI11_PARSE(app, argc, argv);
+    /// Rhs of a single .mtx input
+    fs::path rhs;
+
+    /// Flags .mtx inputs as SPD
+    bool spd = false;
+};
+
+// Stores SPD matrices as requested. Returns whether the storage changed
+bool update_storage(benchy::io::LinearSystem<double>& system, const ConvertOptions& options)
+{
+    const auto stored = benchy::io::stored_triangle(system.metadata);
+    if (options.full_storage && stored != benchy::io::StoredTriangle::Full) {
+        spdlog::info("Expanding the SPD matrix to full storage");
+        benchy::io::make_full_storage(system);
+        return true;
+    } else if (
+        !options.full_storage && stored == benchy::io::StoredTriangle::Full &&
+        benchy::io::make_half_storage(system)) {
+        spdlog::info("Storing the lower triangle of the SPD matrix");
+        return true;
+    }
+    return false;
+}
 
+// The rhs of a .mtx input is given by --rhs, or is "<name>_b.mtx" next to it as in the
+// SuiteSparse collection
+fs::path matrix_market_rhs(const fs::path& input, const ConvertOptions& options)
+{
+    if (!options.rhs.empty()) {
+        return options.rhs;
+    }
+    fs::path rhs = input;
+    rhs.replace_filename(input.stem().string() + "_b.mtx");
+    return fs::exists(rhs) ? rhs : fs::path();
+}
+
+bool is_matrix_market_rhs(const fs::path& path)
+{
+    const std::string stem = path.stem().string();
+    if (path.extension() != ".mtx" || stem.size() < 2 || stem.substr(stem.size() - 2) != "_b") {
+        return false;
+    }
+    fs::path matrix = path;
+    matrix.replace_filename(stem.substr(0, stem.size() - 2) + ".mtx");
+    return fs::exists(matrix);
+}
+
+benchy::io::LinearSystem<double> import_matrix_market(
+    const fs::path& input,
+    const ConvertOptions& options)
+{
+    spdlog::info("Importing linear system from Matrix Market file: {}", input.string());
+    auto system = benchy::io::load_matrix_market<double>(
+        input,
+        matrix_market_rhs(input, options),
+        options.matrix_market);
+    if (options.spd) {
+        system.metadata["is_symmetric_positive_definite"] = 1;
+    }
+    update_storage(system, options);
+    return system;
+}
+
+// Reads a linear system, updating old keys and the storage of SPD matrices
+nlohmann::json read_input(const fs::path& input, const ConvertOptions& options)
+{
     auto data = [&]() -> nlohmann::json {
-        if (args.input.extension() == ".zst") {
-            spdlog::info("Reading linear system from compressed archive: {}", args.input.string());
-            return benchy::io::load_compressed(args.input);
+        if (input.extension() == ".mtx") {
+            return import_matrix_market(input, options);
+        } else if (input.extension() == ".zst") {
+            spdlog::info("Reading linear system from compressed archive: {}", input.string());
+            return benchy::io::load_compressed(input);
+        } else if (input.extension() == ".bcsc") {
+            spdlog::info("Reading linear system from binary container: {}", input.string());
+            return benchy::io::load_binary<double>(input);
         } else {
-            return benchy::io::load_problem(args.input);
+            return benchy::io::load_problem(input);
         }
     }();
 
@@ -75,12 +151,600 @@ int main(int argc, char const* argv[])
         data = data_updated_keys;
     }
 
-    if (args.output.extension() == ".zst") {
+    {
+        auto system = data.get<benchy::io::LinearSystem<double>>();
+        if (data.at("A").is_object()) {
+            // Compressed indices are only kept with --encode-indices
+            data["A"] = system.A;
+        }
+        if (update_storage(system, options)) {
+            data["A"] = system.A;
+            data["metadata"] = system.metadata;
+        }
+    }
+    return data;
+}
+
+bool is_float(const nlohmann::json& data)
+{
+    const auto metadata = data.value("metadata", nlohmann::json::object());
+    return metadata.value("scalar_type", "double") == "float";
+}
+
+// Writes a single linear system to a .zst or .bcsc file
+void write_output(const nlohmann::json& data, const fs::path& output, const ConvertOptions& options)
+{
+    const bool single = is_float(data);
+    if (output.extension() == ".zst" && options.encode_indices) {
+        // Save as zstd-compressed binary json, with compressed indices
+        auto encode = [&](auto zero) {
+            using Scalar = decltype(zero);
+            auto A = benchy::io::encode_sparse_matrix(
+                data.at("A").get<Eigen::SparseMatrix<Scalar>>());
+            spdlog::info(
+                "Encoded indices take {:.2f} bytes per entry",
+                static_cast<double>(A.outer.size() + A.inner.size()) /
+                    std::max<Eigen::Index>(A.nnz, 1));
+            return A;
+        };
+        auto encoded = data;
+        encoded["A"] = (single ? encode(0.f) : encode(0.0));
+        benchy::io::save_compressed(output, encoded, options.compression);
+    } else if (output.extension() == ".zst") {
         // Save as zstd-compressed binary json
-        benchy::io::save_compressed(args.output, data);
+        benchy::io::save_compressed(output, data, options.compression);
+    } else if (output.extension() == ".bcsc") {
+        // Save as memory-mappable binary CSC arrays
+        if (single) {
+            benchy::io::save_binary(output, data.get<benchy::io::LinearSystem<float>>());
+        } else {
+            benchy::io::save_binary(output, data.get<benchy::io::LinearSystem<double>>());
+        }
+    } else {
+        throw std::runtime_error(
+            "[write_output] Invalid output file extension: " + output.extension().string());
+    }
+}
+
+// Writes a system that was not read as json. Its matrix is only converted to json for plain .zst
+// outputs
+void write_system(
+    const benchy::io::LinearSystem<double>& system,
+    const fs::path& output,
+    const ConvertOptions& options)
+{
+    if (output.extension() == ".bcsc") {
+        benchy::io::save_binary(output, system);
+    } else if (output.extension() == ".zst" && options.encode_indices) {
+        nlohmann::json data;
+        data["A"] = benchy::io::encode_sparse_matrix(system.A);
+        data["b"] = system.b;
+        data["metadata"] = system.metadata;
+        benchy::io::save_compressed(output, data, options.compression);
+    } else {
+        write_output(system, output, options);
+    }
+}
+
+// Converts a single linear system to a .zst or .bcsc file
+void convert_file(const fs::path& input, const fs::path& output, const ConvertOptions& options)
+{
+    if (input.extension() == ".mtx") {
+        // Large matrices from external collections skip the json DOM
+        write_system(import_matrix_market(input, options), output, options);
+    } else {
+        write_output(read_input(input, options), output, options);
+    }
+}
+
+///
+/// Caps the estimated memory of the conversions running at the same time. A conversion larger
+/// than the whole budget still runs, alone
+///
+class MemoryBudget
+{
+public:
+    explicit MemoryBudget(size_t bytes)
+        : m_budget(bytes)
+    {}
+
+    void acquire(size_t bytes)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_used == 0 || m_used + bytes <= m_budget; });
+        m_used += bytes;
+    }
+
+    void release(size_t bytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_used -= bytes;
+        }
+        m_cv.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    size_t m_budget;
+    size_t m_used = 0;
+};
+
+///
+/// Conversion of one file of a directory
+///
+struct ConvertJob
+{
+    fs::path input;
+    fs::path output;
+
+    /// Rough estimate of the peak memory of the conversion in bytes: the json DOM of a system
+    /// is several times larger than its file, and .zst archives are also compressed
+    size_t memory = 0;
+};
+
+///
+/// Runs jobs on a fixed set of threads, each owning a deque of jobs. Jobs are dealt largest
+/// first, and a thread whose deque is empty steals the smallest job of another thread, so that
+/// a few large systems do not leave the other threads idle at the end
+///
+class ConvertPool
+{
+public:
+    ConvertPool(std::vector<ConvertJob> jobs, size_t num_threads)
+        : m_queues(std::max<size_t>(num_threads, 1))
+    {
+        std::sort(jobs.begin(), jobs.end(), [](const ConvertJob& a, const ConvertJob& b) {
+            return a.memory > b.memory;
+        });
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            m_queues[i % m_queues.size()].jobs.push_back(std::move(jobs[i]));
+        }
+    }
+
+    ///
+    /// Runs all jobs and returns once they are done
+    ///
+    /// @param[in] run Function called on each job, from any thread
+    ///
+    template <typename Func>
+    void run(Func run)
+    {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < m_queues.size(); ++t) {
+            threads.emplace_back([&, t] {
+                ConvertJob job;
+                while (pop(t, job)) {
+                    run(job);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<ConvertJob> jobs;
+    };
+
+    // Takes the largest job of thread t, or steals the smallest job of another thread
+    bool pop(size_t t, ConvertJob& job)
+    {
+        for (size_t k = 0; k < m_queues.size(); ++k) {
+            auto& queue = m_queues[(t + k) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.jobs.empty()) {
+                continue;
+            }
+            if (k == 0) {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            } else {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<Queue> m_queues;
+};
+
+// Logger of the progress of directory conversions, which stays enabled when the default logger
+// is silenced
+std::shared_ptr<spdlog::logger> progress_logger()
+{
+    static auto logger = spdlog::stdout_color_mt("benchy_convert");
+    return logger;
+}
+
+bool is_input_file(const fs::path& path)
+{
+    const auto ext = path.extension();
+    return ext == ".json" || ext == ".zst" || ext == ".bcsc" || ext == ".mtx";
+}
+
+// Converts every system of a directory tree, keeping its layout. Returns the number of failures
+int convert_directory(
+    const fs::path& input_dir,
+    const fs::path& output_dir,
+    const std::string& format,
+    const ConvertOptions& options,
+    size_t num_jobs,
+    size_t memory_budget,
+    bool force)
+{
+    // Inputs differing only by their extension, e.g. foo.json and foo.zst, have the same output
+    std::map<fs::path, std::vector<fs::path>> inputs_of_output;
+    for (auto it = fs::recursive_directory_iterator(input_dir);
+         it != fs::recursive_directory_iterator();
+         ++it) {
+        const auto& entry = *it;
+        // An output directory inside the input directory holds the outputs of earlier runs, which
+        // are not converted again
+        std::error_code ec;
+        if (entry.is_directory() && fs::equivalent(entry.path(), output_dir, ec)) {
+            it.disable_recursion_pending();
+            continue;
+        }
+        if (!entry.is_regular_file() || !is_input_file(entry.path()) ||
+            is_matrix_market_rhs(entry.path())) {
+            continue;
+        }
+        fs::path output = output_dir / fs::relative(entry.path(), input_dir);
+        output.replace_extension(format);
+        inputs_of_output[output].push_back(entry.path());
+    }
+
+    std::vector<ConvertJob> jobs;
+    size_t num_up_to_date = 0;
+    int num_conflicts = 0;
+    for (auto& [output, inputs] : inputs_of_output) {
+        // Converting them concurrently would race for the output, which would then be taken as up
+        // to date, so none of them is converted
+        if (inputs.size() > 1) {
+            std::sort(inputs.begin(), inputs.end());
+            std::string names = inputs[0].string();
+            for (size_t i = 1; i < inputs.size(); ++i) {
+                names += (i + 1 < inputs.size() ? ", " : " and ") + inputs[i].string();
+            }
+            spdlog::error(
+                "Skipping {}, which would be converted to the same output {}",
+                names,
+                output.string());
+            num_conflicts += static_cast<int>(inputs.size());
+            continue;
+        }
+        ConvertJob job;
+        job.input = inputs[0];
+        job.output = output;
+        std::error_code ec;
+        if (!force && fs::exists(job.output, ec) &&
+            fs::last_write_time(job.output) >= fs::last_write_time(job.input)) {
+            ++num_up_to_date;
+            continue;
+        }
+        const size_t factor = (job.input.extension() == ".zst" ? 16 : 4);
+        job.memory = factor * static_cast<size_t>(fs::file_size(job.input));
+        jobs.push_back(std::move(job));
+    }
+    const auto logger = progress_logger();
+    logger->info(
+        "Converting {} systems from {} to {} with {} threads, {} are up to date",
+        jobs.size(),
+        input_dir.string(),
+        output_dir.string(),
+        num_jobs,
+        num_up_to_date);
+
+    MemoryBudget budget(memory_budget);
+    std::atomic<int> num_failures(num_conflicts);
+    std::atomic<size_t> num_done(0);
+    const size_t num_jobs_total = jobs.size();
+    ConvertPool pool(std::move(jobs), num_jobs);
+    pool.run([&](const ConvertJob& job) {
+        budget.acquire(job.memory);
+        // Written next to the output and renamed once complete, so that an interrupted
+        // conversion is never mistaken for an up-to-date output
+        fs::path partial = job.output;
+        partial.replace_extension(".partial" + format);
+        try {
+            fs::create_directories(job.output.parent_path());
+            convert_file(job.input, partial, options);
+            fs::rename(partial, job.output);
+            logger->info(
+                "[{}/{}] {}",
+                ++num_done,
+                num_jobs_total,
+                fs::relative(job.output, output_dir).string());
+        } catch (const std::exception& e) {
+            spdlog::error("Could not convert {}: {}", job.input.string(), e.what());
+            std::error_code ec;
+            fs::remove(partial, ec);
+            ++num_failures;
+        }
+        budget.release(job.memory);
+    });
+    return num_failures;
+}
+
+// Packs the .zst, .bcsc and .bseq files of a directory tree into a single file, named after their
+// path relative to the directory. Returns the number of failures
+int pack_directory(const fs::path& input_dir, const fs::path& output)
+{
+    std::vector<fs::path> files;
+    size_t num_skipped = 0;
+    for (const auto& entry : fs::recursive_directory_iterator(input_dir)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        const auto ext = entry.path().extension();
+        if (ext == ".zst" || ext == ".bcsc" || ext == ".bseq") {
+            files.push_back(entry.path());
+        } else if (is_input_file(entry.path())) {
+            ++num_skipped;
+        }
+    }
+    // Sorted so that packing the same directory twice gives the same pack
+    std::sort(files.begin(), files.end());
+    if (num_skipped > 0) {
+        spdlog::warn(
+            "Skipping {} files in other formats, convert them to --output-dir first",
+            num_skipped);
+    }
+    const auto logger = progress_logger();
+    logger->info("Packing {} systems from {}", files.size(), input_dir.string());
+
+    // Written next to the output and renamed once complete, so that a running benchmark never
+    // maps an incomplete pack
+    fs::path partial = output;
+    partial.replace_extension(".partial.bpack");
+    int num_failures = 0;
+    {
+        benchy::io::PackWriter writer(partial);
+        for (size_t i = 0; i < files.size(); ++i) {
+            const auto name = fs::relative(files[i], input_dir).generic_string();
+            try {
+                writer.add(name, files[i]);
+                logger->info("[{}/{}] {}", i + 1, files.size(), name);
+            } catch (const std::exception& e) {
+                spdlog::error("Could not pack {}: {}", files[i].string(), e.what());
+                ++num_failures;
+            }
+        }
+        writer.finish();
+    }
+    fs::rename(partial, output);
+    return num_failures;
+}
+
+} // namespace
+
+int main(int argc, char const* argv[])
+{
+    struct
+    {
+        fs::path left;
+        fs::path right;
+        std::vector<fs::path> inputs;
+        fs::path output;
+        fs::path input_dir;
+        fs::path output_dir;
+        std::string format = "zst";
+        size_t num_jobs = std::max(1u, std::thread::hardware_concurrency());
+        size_t memory_budget = 8192;
+        bool force = false;
+        std::string name;
+        ConvertOptions convert;
+    } args;
+    args.convert.compression.num_workers = static_cast<int>(std::thread::hardware_concurrency());
+
+    CLI::App app{argv[0]};
+    app.option_defaults()->always_capture_default();
+    auto input_opt = app.add_option(
+                            "--input",
+                            args.inputs,
+                            "Input linear system. Several systems sharing the same sparsity "
+                            "pattern can be given for a .bseq output, in the order of the "
+                            "sequence.")
+                         ->check(CLI::ExistingFile);
+    auto output_opt = app.add_option(
+        "--output",
+        args.output,
+        "Output archive of the linear system. Filename should end with .zst (compressed "
+        "messagepack), .bcsc (binary CSC container), .bseq (sequence container) or .h5 (HDF5 "
+        "store, which receives the system as a new problem). With --input-dir, a .bpack file "
+        "receiving all its .zst, .bcsc and .bseq files as they are.");
+    auto input_dir_opt =
+        app.add_option(
+               "--input-dir",
+               args.input_dir,
+               "Directory of linear systems (.json, .zst, .bcsc or .mtx) to convert recursively, "
+               "or to pack into a .bpack --output, instead of a single --input.")
+            ->check(CLI::ExistingDirectory)
+            ->excludes(input_opt);
+    auto output_dir_opt =
+        app.add_option(
+               "--output-dir",
+               args.output_dir,
+               "Output directory of --input-dir, which receives the same layout of "
+               "subdirectories.")
+            ->excludes(output_opt);
+    app.add_option(
+           "--rhs",
+           args.convert.rhs,
+           "Rhs of a Matrix Market (.mtx) input, in array or coordinate format. Defaults to "
+           "<name>_b.mtx next to the input if it exists, otherwise b = A * 1 is generated.")
+        ->check(CLI::ExistingFile)
+        ->excludes(input_dir_opt);
+    app.add_flag(
+        "--spd",
+        args.convert.spd,
+        "Flag Matrix Market inputs as symmetric positive definite, which the format does not "
+        "tell.");
+    input_opt->needs(output_opt);
+    output_dir_opt->needs(input_dir_opt);
+    app.add_option(
+        "--name",
+        args.name,
+        "Name of the problem in a .h5 output. Defaults to the filename of the first input, "
+        "without its extension.");
+    app.add_option("--format", args.format, "Output format of --input-dir.")
+        ->check(CLI::IsMember({"zst", "bcsc"}));
+    app.add_option("--jobs", args.num_jobs, "Number of files of --input-dir converted at once.")
+        ->check(CLI::PositiveNumber);
+    app.add_option(
+        "--memory-budget",
+        args.memory_budget,
+        "Estimated memory in MB of the files of --input-dir converted at once. Large files wait "
+        "for others to complete, or run alone if they exceed the budget.");
+    app.add_flag(
+        "--force",
+        args.force,
+        "Convert all files of --input-dir, including those whose output is newer than the input.");
+    app.add_option(
+        "--level",
+        args.convert.compression.level,
+        "zstd compression level for .zst outputs. Negative levels are faster, higher levels "
+        "(up to 22) produce smaller archives. 0 selects the zstd default.");
+    app.add_option(
+           "--threads",
+           args.convert.compression.num_workers,
+           "Number of threads compressing each .zst output. 0 compresses on the main thread. "
+           "Defaults to 0 with --input-dir, which converts several files in parallel instead.")
+        ->check(CLI::NonNegativeNumber);
+    app.add_flag(
+        "--long",
+        args.convert.compression.long_distance_matching,
+        "Enable zstd long-distance matching for .zst outputs.");
+    app.add_option(
+           "--window-log",
+           args.convert.compression.window_log,
+           "Base-2 logarithm of the zstd window size for .zst outputs. 0 lets zstd choose.")
+        ->check(CLI::Range(0, 31));
+    app.add_flag(
+        "--full-storage",
+        args.convert.full_storage,
+        "Store both triangles of SPD matrices. By default, only their lower triangle is stored.");
+    app.add_flag(
+        "--encode-indices",
+        args.convert.encode_indices,
+        "Store the indices of A in .zst outputs as per-column deltas with a byte-aligned varint "
+        "code, and its values as raw floats. Archives are smaller and faster to decode, but "
+        "cannot be read by older versions.");
+    CLI11_PARSE(app, argc, argv);
+
+    if (!args.input_dir.empty() && args.output.extension() == ".bpack") {
+        spdlog::default_logger()->set_level(spdlog::level::warn);
+        const int num_failures = pack_directory(args.input_dir, args.output);
+        if (num_failures > 0) {
+            spdlog::error("{} systems could not be packed", num_failures);
+            return 1;
+        }
+        return 0;
+    }
+    if (!args.input_dir.empty()) {
+        if (args.output_dir.empty()) {
+            spdlog::error("--input-dir requires --output-dir, or a .bpack --output");
+            return 1;
+        }
+        // Outputs would replace their input, or be mixed with the inputs of the next runs
+        if (fs::weakly_canonical(args.output_dir) == fs::weakly_canonical(args.input_dir)) {
+            spdlog::error("--output-dir must differ from --input-dir");
+            return 1;
+        }
+        if (app.count("--threads") == 0) {
+            args.convert.compression.num_workers = 0;
+        }
+        if (args.num_jobs > 1) {
+            args.convert.matrix_market.num_threads = 1;
+        }
+        // Messages of the individual conversions would interleave, only their progress is logged
+        spdlog::default_logger()->set_level(spdlog::level::warn);
+        const int num_failures = convert_directory(
+            args.input_dir,
+            args.output_dir,
+            "." + args.format,
+            args.convert,
+            args.num_jobs,
+            args.memory_budget << 20,
+            args.force);
+        if (num_failures > 0) {
+            spdlog::error("{} conversions failed", num_failures);
+            return 1;
+        }
+        return 0;
+    }
+    if (args.inputs.empty()) {
+        spdlog::error(
+            "Either --input and --output, or --input-dir and --output-dir (or a .bpack --output) "
+            "are required");
+        return 1;
+    }
+
+    const auto ext = args.output.extension();
+    if (ext == ".zst" || ext == ".bcsc") {
+        if (args.inputs.size() > 1) {
+            spdlog::error(
+                "Several inputs can only be converted to a .bseq sequence container or a .h5 "
+                "store");
+            return 1;
+        }
+        convert_file(args.inputs.front(), args.output, args.convert);
+        return 0;
+    } else if (ext != ".bseq" && ext != ".h5") {
+        spdlog::error("Invalid output file extension. Should be .zst, .bcsc, .bseq or .h5");
+        return 1;
+    }
+
+    const auto data = read_input(args.inputs.front(), args.convert);
+    if (ext == ".bseq") {
+        // Save as a sequence of systems sharing the same sparsity pattern
+        auto save = [&](auto zero) {
+            using Scalar = decltype(zero);
+            benchy::io::SequenceWriter<Scalar> writer(args.output);
+            writer.add(data.get<benchy::io::LinearSystem<Scalar>>());
+            for (size_t k = 1; k < args.inputs.size(); ++k) {
+                writer.add(read_input(args.inputs[k], args.convert)
+                               .template get<benchy::io::LinearSystem<Scalar>>());
+            }
+            writer.finish();
+        };
+        if (is_float(data)) {
+            save(0.f);
+        } else {
+            save(0.0);
+        }
     } else {
-        spdlog::error("Invalid output file extension. Should be .zst");
+#ifdef BENCHY_WITH_HDF5
+        // Add the system, or the sequence of systems, as a problem of the store
+        const auto name = args.name.empty() ? args.inputs.front().stem().string() : args.name;
+        benchy::io::Hdf5Store store(args.output, benchy::io::Hdf5Store::Mode::Append);
+        auto save = [&](auto zero) {
+            using Scalar = decltype(zero);
+            std::vector<benchy::io::LinearSystem<Scalar>> steps;
+            steps.push_back(data.get<benchy::io::LinearSystem<Scalar>>());
+            for (size_t k = 1; k < args.inputs.size(); ++k) {
+                steps.push_back(read_input(args.inputs[k], args.convert)
+                                    .template get<benchy::io::LinearSystem<Scalar>>());
+            }
+            store.write(name, steps);
+        };
+        if (is_float(data)) {
+            save(0.f);
+        } else {
+            save(0.0);
+        }
+#else
+        spdlog::error("HDF5 outputs require building with -DBENCHY_WITH_HDF5=ON");
         return 1;
+#endif
     }
 
     return 0;